@@ -16,6 +16,22 @@
 /*     AHS API code                                               */
 /******************************************************************/
 
+/* the state->update functions */
+static int Update_256(hashState * state, const u08b_t * msg, size_t msgByteCnt)
+{
+	return Skein_256_Update(&state->u.ctx_256, msg, msgByteCnt);
+}
+
+static int Update_512(hashState * state, const u08b_t * msg, size_t msgByteCnt)
+{
+	return Skein_512_Update(&state->u.ctx_512, msg, msgByteCnt);
+}
+
+static int Update_1024(hashState * state, const u08b_t * msg, size_t msgByteCnt)
+{
+	return Skein1024_Update(&state->u.ctx1024, msg, msgByteCnt);
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* select the context size and init the context */
 HashReturn Init(hashState * state, int hashbitlen)
@@ -23,69 +39,82 @@ HashReturn Init(hashState * state, int hashbitlen)
 	if (hashbitlen <= SKEIN_256_NIST_MAX_HASHBITS) {
 		Skein_Assert(hashbitlen > 0, BAD_HASHLEN);
 		state->statebits = 64 * SKEIN_256_STATE_WORDS;
+		state->update = Update_256;
 		return Skein_256_Init(&state->u.ctx_256, (size_t) hashbitlen);
 	}
 	if (hashbitlen <= SKEIN_512_NIST_MAX_HASHBITS) {
 		state->statebits = 64 * SKEIN_512_STATE_WORDS;
+		state->update = Update_512;
 		return Skein_512_Init(&state->u.ctx_512, (size_t) hashbitlen);
 	} else {
 		state->statebits = 64 * SKEIN1024_STATE_WORDS;
+		state->update = Update_1024;
 		return Skein1024_Init(&state->u.ctx1024, (size_t) hashbitlen);
 	}
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* init the context of the given size with InitExt() */
+HashReturn InitExt(hashState * state, uint_t statebits, int hashbitlen,
+		   u64b_t treeInfo, const u08b_t * key, size_t keyBytes)
+{
+	if (hashbitlen <= 0)
+		return BAD_HASHLEN;
+	state->statebits = statebits;
+	switch (statebits) {
+	case 256:
+		state->update = Update_256;
+		return (HashReturn) Skein_256_InitExt(&state->u.ctx_256, (size_t) hashbitlen,
+						      treeInfo, key, keyBytes);
+	case 512:
+		state->update = Update_512;
+		return (HashReturn) Skein_512_InitExt(&state->u.ctx_512, (size_t) hashbitlen,
+						      treeInfo, key, keyBytes);
+	case 1024:
+		state->update = Update_1024;
+		return (HashReturn) Skein1024_InitExt(&state->u.ctx1024, (size_t) hashbitlen,
+						      treeInfo, key, keyBytes);
+	default:
+		return FAIL;
+	}
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* process data to be hashed */
 HashReturn Update(hashState * state, const BitSequence * data,
 		  DataLength databitlen)
 {
+	size_t bCnt = databitlen >> 3;	/* number of whole bytes */
+	u08b_t b, mask;
+
 	/* only the final Update() call is allowed do partial bytes, else assert an error */
 	Skein_Assert((state->u.h.T[1] & SKEIN_T1_FLAG_BIT_PAD) == 0
 		     || databitlen == 0, FAIL);
 
-	Skein_Assert(state->statebits % 256 == 0
-		     && (state->statebits - 256) < 1024, FAIL);
-	if ((databitlen & 7) == 0) {	/* partial bytes? */
-		switch ((state->statebits >> 8) & 3) {
-		case 2:
-			return Skein_512_Update(&state->u.ctx_512, data,
-						databitlen >> 3);
-		case 1:
-			return Skein_256_Update(&state->u.ctx_256, data,
-						databitlen >> 3);
-		case 0:
-			return Skein1024_Update(&state->u.ctx1024, data,
-						databitlen >> 3);
-		default:
-			return FAIL;
-		}
-	} else {		/* handle partial final byte */
-		size_t bCnt = (databitlen >> 3) + 1;	/* number of bytes to handle (nonzero here!) */
-		u08b_t b, mask;
-
-		mask = (u08b_t) (1u << (7 - (databitlen & 7)));	/* partial byte bit mask */
-		b = (u08b_t) ((data[bCnt - 1] & (0 - mask)) | mask);	/* apply bit padding on final byte */
-
-		switch ((state->statebits >> 8) & 3) {
-		case 2:
-			Skein_512_Update(&state->u.ctx_512, data, bCnt - 1);	/* process all but the final byte    */
-			Skein_512_Update(&state->u.ctx_512, &b, 1);	/* process the (masked) partial byte */
-			break;
-		case 1:
-			Skein_256_Update(&state->u.ctx_256, data, bCnt - 1);	/* process all but the final byte    */
-			Skein_256_Update(&state->u.ctx_256, &b, 1);	/* process the (masked) partial byte */
-			break;
-		case 0:
-			Skein1024_Update(&state->u.ctx1024, data, bCnt - 1);	/* process all but the final byte    */
-			Skein1024_Update(&state->u.ctx1024, &b, 1);	/* process the (masked) partial byte */
-			break;
-		default:
-			return FAIL;
-		}
-		Skein_Set_Bit_Pad_Flag(state->u.h);	/* set tweak flag for the final call */
+	if ((databitlen & 7) == 0)	/* no partial bytes */
+		return (HashReturn) state->update(state, data, bCnt);
 
-		return SUCCESS;
-	}
+	/* handle partial final byte */
+	mask = (u08b_t) (1u << (7 - (databitlen & 7)));	/* partial byte bit mask */
+	b = (u08b_t) ((data[bCnt] & (0 - mask)) | mask);	/* apply bit padding on final byte */
+
+	state->update(state, data, bCnt);	/* process all but the final byte    */
+	state->update(state, &b, 1);	/* process the (masked) partial byte */
+	Skein_Set_Bit_Pad_Flag(state->u.h);	/* set tweak flag for the final call */
+
+	return SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* process whole bytes, e.g. one field of a record at a time */
+HashReturn UpdateBytes(hashState * state, const BitSequence * data,
+		       size_t databytelen)
+{
+	/* no more data after a partial byte */
+	Skein_Assert((state->u.h.T[1] & SKEIN_T1_FLAG_BIT_PAD) == 0
+		     || databytelen == 0, FAIL);
+
+	return (HashReturn) state->update(state, data, databytelen);
 }
 
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -112,7 +141,27 @@ HashReturn Hash(int hashbitlen, const BitSequence * data,	/* all-in-one call */
 		DataLength databitlen, BitSequence * hashval)
 {
 	hashState state;
-	HashReturn r = Init(&state, hashbitlen);
+	HashReturn r;
+
+	/* whole bytes that fit into one block: no context to buffer in */
+	if ((databitlen & 7) == 0 && hashbitlen > 0) {
+		size_t n = databitlen >> 3;
+
+		if (hashbitlen <= SKEIN_256_NIST_MAX_HASHBITS) {
+			if (n <= SKEIN_256_BLOCK_BYTES)
+				return (HashReturn) Skein_256_Hash_Short((size_t) hashbitlen,
+									 data, n, hashval);
+		} else if (hashbitlen <= SKEIN_512_NIST_MAX_HASHBITS) {
+			if (n <= SKEIN_512_BLOCK_BYTES)
+				return (HashReturn) Skein_512_Hash_Short((size_t) hashbitlen,
+									 data, n, hashval);
+		} else if (n <= SKEIN1024_BLOCK_BYTES) {
+			return (HashReturn) Skein1024_Hash_Short((size_t) hashbitlen,
+								 data, n, hashval);
+		}
+	}
+
+	r = Init(&state, hashbitlen);
 	if (r == SUCCESS) {	/* these calls do not fail when called properly */
 		r = Update(&state, data, databitlen);
 		Final(&state, hashval);
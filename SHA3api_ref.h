@@ -22,8 +22,11 @@ typedef enum {
 typedef size_t DataLength;	/* bit count  type */
 typedef u08b_t BitSequence;	/* bit stream type */
 
-typedef struct {
+typedef struct hashState {
 	uint_t statebits;	/* 256, 512, or 1024 */
+	/* Skein_*_Update() for this state size, set by Init() */
+	int (*update) (struct hashState * state, const u08b_t * msg,
+		       size_t msgByteCnt);
 	union {
 		Skein_Ctxt_Hdr_t h;	/* common header "overlay" */
 		Skein_256_Ctxt_t ctx_256;
@@ -34,10 +37,18 @@ typedef struct {
 
 /* "incremental" hashing API */
 HashReturn Init(hashState * state, int hashbitlen);
+/* Init() for an explicit state size (256, 512 or 1024), with the
+   arguments of Skein_*_InitExt() */
+HashReturn InitExt(hashState * state, uint_t statebits, int hashbitlen,
+		   u64b_t treeInfo, const u08b_t * key, size_t keyBytes);
 HashReturn Update(hashState * state, const BitSequence * data,
 		  DataLength databitlen);
 HashReturn Final(hashState * state, BitSequence * hashval);
 
+/* Update() for whole bytes, without the bit length handling */
+HashReturn UpdateBytes(hashState * state, const BitSequence * data,
+		       size_t databytelen);
+
 /* "all-in-one" call */
 HashReturn Hash(int hashbitlen, const BitSequence * data,
 		DataLength databitlen, BitSequence * hashval);
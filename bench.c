@@ -0,0 +1,320 @@
+/***********************************************************************
+**
+** Skein benchmark: cycles/byte and MB/s for all message lengths from
+** one byte to 1 GiB, all state sizes, aligned and unaligned input and
+** every kernel that the CPU can run. With -l: nanoseconds per Hash()
+** call for short messages instead.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** On PowerPC the time is read from the timebase register; its frequency
+** and the CPU clock are taken from /proc/cpuinfo (use -c if the clock is
+** missing there). Elsewhere clock_gettime() is used.
+**
+** Usage: bench [-f csv|json] [-k kernel] [-s 256|512|1024] [-m max bytes]
+**              [-t seconds per case] [-c CPU MHz] [-l]
+**
+***********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "skein.h"
+#include "skein_kernel.h"
+#include "SHA3api_ref.h"
+
+#define BENCH_BUF_BYTES	(16 * 1024 * 1024)	/* longer messages repeat the buffer */
+
+/* numeric value of the first /proc/cpuinfo line starting with key */
+static double cpuinfo_value(const char *key)
+{
+	char line[256];
+	double v = 0;
+	char *p;
+	FILE *f = fopen("/proc/cpuinfo", "r");
+
+	if (f == NULL)
+		return 0;
+	while (fgets(line, sizeof(line), f)) {
+		if (strncmp(line, key, strlen(key)) == 0 &&
+		    (p = strchr(line, ':')) != NULL) {
+			v = strtod(p + 1, NULL);
+			break;
+		}
+	}
+	fclose(f);
+	return v;
+}
+
+#if defined(__powerpc__) || defined(__ppc__)
+/* the timebase register (all 64 bits, on 32-bit CPUs too) */
+static u64b_t bench_ticks(void)
+{
+#ifdef __powerpc64__
+	u64b_t tb;
+
+	__asm__ __volatile__("mftb %0" : "=r"(tb));
+	return tb;
+#else
+	unsigned int hi, lo, tmp;
+
+	__asm__ __volatile__("1:	mftbu %0\n"
+			     "	mftb %1\n"
+			     "	mftbu %2\n"
+			     "	cmpw %2, %0\n"
+			     "	bne 1b" : "=r"(hi), "=r"(lo), "=r"(tmp) : : "cr0");
+	return ((u64b_t) hi << 32) | lo;
+#endif
+}
+
+static double bench_tick_hz(void)
+{
+	return cpuinfo_value("timebase");
+}
+
+static double bench_cpu_hz(void)
+{
+	return cpuinfo_value("clock") * 1e6;	/* "1250.000000MHz" */
+}
+#else
+/* nanoseconds */
+static u64b_t bench_ticks(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64b_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static double bench_tick_hz(void)
+{
+	return 1e9;
+}
+
+static double bench_cpu_hz(void)
+{
+	return cpuinfo_value("cpu MHz") * 1e6;
+}
+#endif
+
+/* hash msgLen bytes, repeating the buffer for long messages */
+static void bench_hash(uint_t stateBits, const u08b_t *buf, size_t msgLen,
+		       u08b_t *hashVal)
+{
+	union {
+		Skein_256_Ctxt_t ctx_256;
+		Skein_512_Ctxt_t ctx_512;
+		Skein1024_Ctxt_t ctx1024;
+	} u;
+	size_t n;
+
+	switch (stateBits) {
+	case 256:
+		Skein_256_Init(&u.ctx_256, 256);
+		for (; msgLen; msgLen -= n) {
+			n = msgLen < BENCH_BUF_BYTES ? msgLen : BENCH_BUF_BYTES;
+			Skein_256_Update(&u.ctx_256, buf, n);
+		}
+		Skein_256_Final(&u.ctx_256, hashVal);
+		break;
+	case 512:
+		Skein_512_Init(&u.ctx_512, 512);
+		for (; msgLen; msgLen -= n) {
+			n = msgLen < BENCH_BUF_BYTES ? msgLen : BENCH_BUF_BYTES;
+			Skein_512_Update(&u.ctx_512, buf, n);
+		}
+		Skein_512_Final(&u.ctx_512, hashVal);
+		break;
+	default:
+		Skein1024_Init(&u.ctx1024, 1024);
+		for (; msgLen; msgLen -= n) {
+			n = msgLen < BENCH_BUF_BYTES ? msgLen : BENCH_BUF_BYTES;
+			Skein1024_Update(&u.ctx1024, buf, n);
+		}
+		Skein1024_Final(&u.ctx1024, hashVal);
+		break;
+	}
+}
+
+/* the same, with the incremental API (no one-shot path) */
+static void bench_hash_incremental(int hashBits, const u08b_t *msg, size_t len,
+				   u08b_t *hashVal)
+{
+	hashState state;
+
+	Init(&state, hashBits);
+	Update(&state, msg, len * 8);
+	Final(&state, hashVal);
+}
+
+/* nanoseconds per hash of a short message, Hash() vs. Init/Update/Final */
+static void bench_latency(const char *name, uint_t onlyState, const u08b_t *msg,
+			  double minTime, double tickHz, int json, int *first)
+{
+	static const size_t lens[] = { 0, 16, 32, 64, 128, 256 };
+	static const int hashBits[] = { 256, 512, 1024 };
+	u08b_t hashVal[SKEIN1024_BLOCK_BYTES];
+	u64b_t start, ticks;
+	size_t l, iters, i;
+	uint_t h;
+	int incr;
+
+	for (h = 0; h < sizeof(hashBits) / sizeof(hashBits[0]); h++) {
+		if (onlyState && onlyState != (uint_t) hashBits[h])
+			continue;
+		for (incr = 0; incr < 2; incr++) {
+			for (l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+				for (iters = 1;; iters <<= 1) {
+					start = bench_ticks();
+					if (incr)
+						for (i = 0; i < iters; i++)
+							bench_hash_incremental(hashBits[h], msg, lens[l], hashVal);
+					else
+						for (i = 0; i < iters; i++)
+							Hash(hashBits[h], msg, lens[l] * 8, hashVal);
+					ticks = bench_ticks() - start;
+					if (ticks >= minTime * tickHz)
+						break;
+				}
+
+				if (json)
+					printf("%s  {\"kernel\": \"%s\", \"hash_bits\": %d, \"bytes\": %lu, "
+					       "\"api\": \"%s\", \"iterations\": %lu, \"ns_per_hash\": %.1f}",
+					       *first ? "" : ",\n", name, hashBits[h], (unsigned long) lens[l],
+					       incr ? "incremental" : "hash", (unsigned long) iters,
+					       ticks / tickHz * 1e9 / iters);
+				else
+					printf("%s,%d,%lu,%s,%lu,%.1f\n", name, hashBits[h],
+					       (unsigned long) lens[l], incr ? "incremental" : "hash",
+					       (unsigned long) iters, ticks / tickHz * 1e9 / iters);
+				*first = 0;
+			}
+		}
+	}
+}
+
+static void usage(void)
+{
+	printf("Usage: bench [-f csv|json] [-k kernel] [-s 256|512|1024] [-m max bytes]\n"
+	       "             [-t seconds per case] [-c CPU MHz] [-l]\n");
+}
+
+int main(int argc, char **argv)
+{
+	static const uint_t stateSizes[] = { 256, 512, 1024 };
+	u08b_t hashVal[SKEIN1024_BLOCK_BYTES];
+	u08b_t *buf;
+	const char *kernel = NULL;
+	double tickHz, cpuHz, minTime = 0.1, secs;
+	u64b_t start, ticks;
+	size_t maxLen = (size_t) 1 << 30, len, iters, i;
+	uint_t onlyState = 0, s, k, aligned;
+	int json = 0, first = 1, latency = 0;
+
+	cpuHz = bench_cpu_hz();
+	for (i = 1; i < (size_t) argc; i++) {
+		if (strcmp(argv[i], "-f") == 0 && i + 1 < (size_t) argc) {
+			json = (strcmp(argv[++i], "json") == 0);
+		} else if (strcmp(argv[i], "-k") == 0 && i + 1 < (size_t) argc) {
+			kernel = argv[++i];
+		} else if (strcmp(argv[i], "-s") == 0 && i + 1 < (size_t) argc) {
+			onlyState = (uint_t) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "-m") == 0 && i + 1 < (size_t) argc) {
+			maxLen = (size_t) strtoull(argv[++i], NULL, 0);
+		} else if (strcmp(argv[i], "-t") == 0 && i + 1 < (size_t) argc) {
+			minTime = atof(argv[++i]);
+		} else if (strcmp(argv[i], "-c") == 0 && i + 1 < (size_t) argc) {
+			cpuHz = atof(argv[++i]) * 1e6;
+		} else if (strcmp(argv[i], "-l") == 0) {
+			latency = 1;
+		} else {
+			usage();
+			return 1;
+		}
+	}
+
+	tickHz = bench_tick_hz();
+	if (tickHz <= 0) {
+		printf("Unknown timebase frequency!\n");
+		return 1;
+	}
+
+	/* one spare vector, for the unaligned case */
+	if (posix_memalign((void **) &buf, SKEIN_ALIGNMENT, BENCH_BUF_BYTES + SKEIN_ALIGNMENT)) {
+		printf("Out of memory!\n");
+		return 1;
+	}
+	for (i = 0; i < BENCH_BUF_BYTES + SKEIN_ALIGNMENT; i++)
+		buf[i] = (u08b_t) (i * 0x9D);
+
+	if (json)
+		printf("[\n");
+	else if (latency)
+		printf("kernel,hash_bits,bytes,api,iterations,ns_per_hash\n");
+	else
+		printf("kernel,state_bits,bytes,aligned,iterations,seconds,mb_per_s,cycles_per_byte\n");
+
+	for (k = 0; Skein_Kernel_List[k] != NULL; k++) {
+		const char *name = Skein_Kernel_List[k]->name;
+
+		if (kernel != NULL && strcmp(kernel, name) != 0)
+			continue;
+		if (Skein_Set_Kernel(name) != SKEIN_SUCCESS)
+			continue;	/* not supported by this CPU */
+
+		if (latency) {
+			bench_latency(name, onlyState, buf, minTime, tickHz, json, &first);
+			continue;
+		}
+
+		for (s = 0; s < sizeof(stateSizes) / sizeof(stateSizes[0]); s++) {
+			if (onlyState && onlyState != stateSizes[s])
+				continue;
+			for (aligned = 0; aligned < 2; aligned++) {
+				const u08b_t *msg = aligned ? buf : buf + 1;
+
+				for (len = 1; len && len <= maxLen; len <<= 1) {
+					bench_hash(stateSizes[s], msg, len, hashVal);	/* warm up */
+
+					/* double the count until it takes long enough */
+					for (iters = 1;; iters <<= 1) {
+						start = bench_ticks();
+						for (i = 0; i < iters; i++)
+							bench_hash(stateSizes[s], msg, len, hashVal);
+						ticks = bench_ticks() - start;
+						if (ticks >= minTime * tickHz)
+							break;
+					}
+
+					secs = ticks / tickHz;
+					if (json)
+						printf("%s  {\"kernel\": \"%s\", \"state_bits\": %u, \"bytes\": %lu, "
+						       "\"aligned\": %s, \"iterations\": %lu, \"seconds\": %.6f, "
+						       "\"mb_per_s\": %.3f, \"cycles_per_byte\": ",
+						       first ? "" : ",\n", name, stateSizes[s],
+						       (unsigned long) len, aligned ? "true" : "false",
+						       (unsigned long) iters, secs,
+						       len * (double) iters / secs / 1e6);
+					else
+						printf("%s,%u,%lu,%u,%lu,%.6f,%.3f,", name, stateSizes[s],
+						       (unsigned long) len, aligned, (unsigned long) iters,
+						       secs, len * (double) iters / secs / 1e6);
+					if (cpuHz > 0)
+						printf("%.2f", secs * cpuHz / ((double) len * iters));
+					else if (json)
+						printf("null");
+					printf(json ? "}" : "\n");
+					first = 0;
+				}
+			}
+		}
+	}
+
+	if (json)
+		printf("\n]\n");
+	free(buf);
+	return 0;
+}
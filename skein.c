@@ -10,57 +10,8 @@
 
 #include <string.h>		/* get the memcpy/memset functions */
 #include "skein.h"		/* get the Skein API definitions   */
-
-/*****************************************************************/
-/* External function to process blkCnt (nonzero) full block(s) of data. */
-void Skein_256_Process_Block(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
-			     size_t blkCnt, size_t byteCntAdd);
-void Skein_512_Process_Block(Skein_512_Ctxt_t * ctx, const u08b_t * blkPtr,
-			     size_t blkCnt, size_t byteCntAdd);
-void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
-			     size_t blkCnt, size_t byteCntAdd);
-
-/*****************************************************************/
-/*     Portable (i.e., slow) endianness conversion functions     */
-u64b_t Skein_Swap64(u64b_t w64)
-{				/* instantiate the function body here */
-	static const u64b_t ONE = 1;	/* use this to check endianness */
-
-	/* figure out endianness "on-the-fly" */
-	if (1 == ((u08b_t *) & ONE)[0])
-		return w64;	/* little-endian is fast */
-	else
-		return ((w64 & 0xFF) << 56) |	/*    big-endian is slow */
-		    (((w64 >> 8) & 0xFF) << 48) |
-		    (((w64 >> 16) & 0xFF) << 40) |
-		    (((w64 >> 24) & 0xFF) << 32) |
-		    (((w64 >> 32) & 0xFF) << 24) |
-		    (((w64 >> 40) & 0xFF) << 16) |
-		    (((w64 >> 48) & 0xFF) << 8) | (((w64 >> 56) & 0xFF));
-}
-
-void Skein_Put64_LSB_First(u08b_t * dst, const u64b_t * src, size_t bCnt)
-{				/* this version is fully portable (big-endian or little-endian), but slow */
-	size_t n;
-
-	for (n = 0; n < bCnt; n++)
-		dst[n] = (u08b_t) (src[n >> 3] >> (8 * (n & 7)));
-}
-
-void Skein_Get64_LSB_First(u64b_t * dst, const u08b_t * src, size_t wCnt)
-{				/* this version is fully portable (big-endian or little-endian), but slow */
-	size_t n;
-
-	for (n = 0; n < 8 * wCnt; n += 8)
-		dst[n / 8] = (((u64b_t) src[n])) +
-		    (((u64b_t) src[n + 1]) << 8) +
-		    (((u64b_t) src[n + 2]) << 16) +
-		    (((u64b_t) src[n + 3]) << 24) +
-		    (((u64b_t) src[n + 4]) << 32) +
-		    (((u64b_t) src[n + 5]) << 40) +
-		    (((u64b_t) src[n + 6]) << 48) +
-		    (((u64b_t) src[n + 7]) << 56);
-}
+#include "skein_kernel.h"	/* get the block functions         */
+#include "skein_iv.h"		/* get precomputed IVs             */
 
 /*****************************************************************/
 /*     256-bit Skein                                             */
@@ -77,18 +28,37 @@ int Skein_256_Init(Skein_256_Ctxt_t * ctx, size_t hashBitLen)
 
 	Skein_Assert(hashBitLen > 0, SKEIN_BAD_HASHLEN);
 
-	/* build/process config block for hashing */
 	ctx->h.hashBitLen = hashBitLen;	/* output hash byte count */
-	Skein_Start_New_Type(ctx, CFG_FINAL);	/* set tweaks: T0=0; T1=CFG | FINAL */
 
-	memset(&cfg.w, 0, sizeof(cfg.w));	/* pre-pad cfg.w[] with zeroes */
-	cfg.w[0] = Skein_Swap64(SKEIN_SCHEMA_VER);	/* set the schema, version */
-	cfg.w[1] = Skein_Swap64(hashBitLen);	/* hash result length in bits */
-	cfg.w[2] = Skein_Swap64(SKEIN_CFG_TREE_INFO_SEQUENTIAL);
-
-	/* compute the initial chaining values from config block */
-	memset(ctx->X, 0, sizeof(ctx->X));	/* zero the chaining variables */
-	Skein_256_Process_Block(ctx, cfg.b, 1, SKEIN_CFG_STR_LEN);
+	switch (hashBitLen) {	/* use pre-computed values, where available */
+#if SKEIN_USE_PRECOMP
+	case  128:
+		memcpy(ctx->X, SKEIN_256_IV_128, sizeof(ctx->X));
+		break;
+	case  160:
+		memcpy(ctx->X, SKEIN_256_IV_160, sizeof(ctx->X));
+		break;
+	case  224:
+		memcpy(ctx->X, SKEIN_256_IV_224, sizeof(ctx->X));
+		break;
+	case  256:
+		memcpy(ctx->X, SKEIN_256_IV_256, sizeof(ctx->X));
+		break;
+#endif
+	default:
+		/* build/process config block for hashing */
+		Skein_Start_New_Type(ctx, CFG_FINAL);	/* set tweaks: T0=0; T1=CFG | FINAL */
+
+		memset(&cfg.w, 0, sizeof(cfg.w));	/* pre-pad cfg.w[] with zeroes */
+		cfg.w[0] = Skein_Swap64(SKEIN_SCHEMA_VER);	/* set the schema, version */
+		cfg.w[1] = Skein_Swap64(hashBitLen);	/* hash result length in bits */
+		cfg.w[2] = Skein_Swap64(SKEIN_CFG_TREE_INFO_SEQUENTIAL);
+
+		/* compute the initial chaining values from config block */
+		memset(ctx->X, 0, sizeof(ctx->X));	/* zero the chaining variables */
+		Skein_256_Process_Block(ctx, cfg.b, 1, SKEIN_CFG_STR_LEN);
+		break;
+	}
 
 	/* The chaining vars ctx->X are now initialized for the given hashBitLen. */
 	/* Set up to process the data message portion of the hash (default) */
@@ -150,6 +120,53 @@ int Skein_256_InitExt(Skein_256_Ctxt_t * ctx, size_t hashBitLen,
 	return SKEIN_SUCCESS;
 }
 
+/* one UBI call over an argument block, the result is the new chaining value */
+static void Skein_256_Arg_Block(Skein_256_Ctxt_t * ctx, u64b_t blkType,
+				 const u08b_t * arg, size_t argBytes)
+{
+	u08b_t X[SKEIN_256_STATE_BYTES];	/* not needed, ctx->X is the result */
+
+	Skein_Set_T0_T1(ctx, 0, SKEIN_T1_FLAG_FIRST | blkType);
+	ctx->h.bCnt = 0;
+	Skein_256_Update(ctx, arg, argBytes);
+	Skein_256_Final_Pad(ctx, X);
+	Skein_Start_New_Type(ctx, MSG);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* init the context with all optional arguments (in the spec's order) */
+int Skein_256_InitArgs(Skein_256_Ctxt_t * ctx, size_t hashBitLen,
+		       const Skein_Args_t * args)
+{
+	Skein_Assert(args->persBytes == 0 || args->pers != NULL, SKEIN_FAIL);
+	Skein_Assert(args->pkBytes == 0 || args->pk != NULL, SKEIN_FAIL);
+
+	if (Skein_256_InitExt(ctx, hashBitLen, args->treeInfo, args->key,
+			       args->keyBytes) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	if (args->persBytes)
+		Skein_256_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_PERS, args->pers,
+				     args->persBytes);
+	if (args->pkBytes)
+		Skein_256_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_PK, args->pk,
+				     args->pkBytes);
+	return Skein_256_Nonce(ctx, args->nonce, args->nonceBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* add a nonce to a context that has no message data yet */
+int Skein_256_Nonce(Skein_256_Ctxt_t * ctx, const u08b_t * nonce,
+		    size_t nonceBytes)
+{
+	Skein_Assert(ctx->h.bCnt == 0 && ctx->h.T[0] == 0, SKEIN_FAIL);	/* no message yet */
+	Skein_Assert(nonceBytes == 0 || nonce != NULL, SKEIN_FAIL);
+
+	if (nonceBytes)
+		Skein_256_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_NONCE, nonce,
+				     nonceBytes);
+	return SKEIN_SUCCESS;
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* process the input bytes */
 int Skein_256_Update(Skein_256_Ctxt_t * ctx, const u08b_t * msg,
@@ -158,6 +175,7 @@ int Skein_256_Update(Skein_256_Ctxt_t * ctx, const u08b_t * msg,
 	size_t n;
 
 	Skein_Assert(ctx->h.bCnt <= SKEIN_256_BLOCK_BYTES, SKEIN_FAIL);	/* catch uninitialized context */
+	Skein_Stats_Add(updates, 1);
 
 	/* process full blocks, if any */
 	if (msgByteCnt + ctx->h.bCnt > SKEIN_256_BLOCK_BYTES) {
@@ -171,15 +189,19 @@ int Skein_256_Update(Skein_256_Ctxt_t * ctx, const u08b_t * msg,
 				ctx->h.bCnt += n;
 			}
 			Skein_assert(ctx->h.bCnt == SKEIN_256_BLOCK_BYTES);
-			Skein_256_Process_Block(ctx, ctx->b, 1,
-						SKEIN_256_BLOCK_BYTES);
+			Skein_256_Process_Block_Aligned(ctx, ctx->b, 1,
+							SKEIN_256_BLOCK_BYTES);
 			ctx->h.bCnt = 0;
 		}
 		/* now process any remaining full blocks, directly from input message data */
 		if (msgByteCnt > SKEIN_256_BLOCK_BYTES) {
 			n = (msgByteCnt - 1) / SKEIN_256_BLOCK_BYTES;	/* number of full blocks to process */
-			Skein_256_Process_Block(ctx, msg, n,
-						SKEIN_256_BLOCK_BYTES);
+			if (Skein_Is_Aligned(msg))	/* the faster vector loads */
+				Skein_256_Process_Block_Aligned(ctx, msg, n,
+								SKEIN_256_BLOCK_BYTES);
+			else
+				Skein_256_Process_Block(ctx, msg, n,
+							SKEIN_256_BLOCK_BYTES);
 			msgByteCnt -= n * SKEIN_256_BLOCK_BYTES;
 			msg += n * SKEIN_256_BLOCK_BYTES;
 		}
@@ -189,6 +211,7 @@ int Skein_256_Update(Skein_256_Ctxt_t * ctx, const u08b_t * msg,
 	/* copy any remaining source message data bytes into b[] */
 	if (msgByteCnt) {
 		Skein_assert(msgByteCnt + ctx->h.bCnt <= SKEIN_256_BLOCK_BYTES);
+		Skein_Stats_Add(bufferedUpdates, 1);
 		memcpy(&ctx->b[ctx->h.bCnt], msg, msgByteCnt);
 		ctx->h.bCnt += msgByteCnt;
 	}
@@ -208,18 +231,18 @@ int Skein_256_Final(Skein_256_Ctxt_t * ctx, u08b_t * hashVal)
 	if (ctx->h.bCnt < SKEIN_256_BLOCK_BYTES)	/* zero pad b[] if necessary */
 		memset(&ctx->b[ctx->h.bCnt], 0,
 		       SKEIN_256_BLOCK_BYTES - ctx->h.bCnt);
-	Skein_256_Process_Block(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
+	Skein_256_Process_Block_Aligned(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
 
 	/* now output the result */
 	byteCnt = (ctx->h.hashBitLen + 7) >> 3;	/* total number of output bytes */
 
-	/* run Threefish in "counter mode" to generate output */
+	/* run Threefish in "counter mode" to generate output, one block at a time */
 	memset(ctx->b, 0, sizeof(ctx->b));	/* zero out b[], so it can hold the counter */
 	memcpy(X, ctx->X, sizeof(X));	/* keep a local copy of counter mode "key" */
 	for (i = 0; i * SKEIN_256_BLOCK_BYTES < byteCnt; i++) {
 		((u64b_t *) ctx->b)[0] = Skein_Swap64((u64b_t) i);	/* build the counter block */
 		Skein_Start_New_Type(ctx, OUT_FINAL);
-		Skein_256_Process_Block(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
+		Skein_256_Process_Block_Aligned(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
 		n = byteCnt - i * SKEIN_256_BLOCK_BYTES;	/* number of output bytes left to go */
 		if (n >= SKEIN_256_BLOCK_BYTES)
 			n = SKEIN_256_BLOCK_BYTES;
@@ -231,6 +254,31 @@ int Skein_256_Final(Skein_256_Ctxt_t * ctx, u08b_t * hashVal)
 	return SKEIN_SUCCESS;
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* all-in-one hash helper, without Update() for a message of one block */
+int Skein_256_Hash_Short(size_t hashBitLen, const u08b_t * msg,
+			 size_t msgByteCnt, u08b_t * hashVal)
+{
+	Skein_256_Ctxt_t ctx;
+	int r;
+
+	r = Skein_256_Init(&ctx, hashBitLen);	/* usually just the precomputed IV */
+	if (r != SKEIN_SUCCESS)
+		return r;
+
+	if (msgByteCnt > SKEIN_256_BLOCK_BYTES) {	/* more than one block: buffer it */
+		Skein_256_Update(&ctx, msg, msgByteCnt);
+		return Skein_256_Final(&ctx, hashVal);
+	}
+
+	/* no Update(): the message is the final block, Final() pads it */
+	if (msgByteCnt)		/* msg may be NULL for the empty message */
+		memcpy(ctx.b, msg, msgByteCnt);
+	ctx.h.bCnt = msgByteCnt;
+
+	return Skein_256_Final(&ctx, hashVal);
+}
+
 #if defined(SKEIN_CODE_SIZE) || defined(SKEIN_PERF)
 size_t Skein_256_API_CodeSize(void)
 {
@@ -254,18 +302,43 @@ int Skein_512_Init(Skein_512_Ctxt_t * ctx, size_t hashBitLen)
 
 	Skein_Assert(hashBitLen > 0, SKEIN_BAD_HASHLEN);
 
-	/* build/process config block for hashing */
 	ctx->h.hashBitLen = hashBitLen;	/* output hash byte count */
-	Skein_Start_New_Type(ctx, CFG_FINAL);	/* set tweaks: T0=0; T1=CFG | FINAL */
-
-	memset(&cfg.w, 0, sizeof(cfg.w));	/* pre-pad cfg.w[] with zeroes */
-	cfg.w[0] = Skein_Swap64(SKEIN_SCHEMA_VER);	/* set the schema, version */
-	cfg.w[1] = Skein_Swap64(hashBitLen);	/* hash result length in bits */
-	cfg.w[2] = Skein_Swap64(SKEIN_CFG_TREE_INFO_SEQUENTIAL);
 
-	/* compute the initial chaining values from config block */
-	memset(ctx->X, 0, sizeof(ctx->X));	/* zero the chaining variables */
-	Skein_512_Process_Block(ctx, cfg.b, 1, SKEIN_CFG_STR_LEN);
+	switch (hashBitLen) {	/* use pre-computed values, where available */
+#if SKEIN_USE_PRECOMP
+	case  128:
+		memcpy(ctx->X, SKEIN_512_IV_128, sizeof(ctx->X));
+		break;
+	case  160:
+		memcpy(ctx->X, SKEIN_512_IV_160, sizeof(ctx->X));
+		break;
+	case  224:
+		memcpy(ctx->X, SKEIN_512_IV_224, sizeof(ctx->X));
+		break;
+	case  256:
+		memcpy(ctx->X, SKEIN_512_IV_256, sizeof(ctx->X));
+		break;
+	case  384:
+		memcpy(ctx->X, SKEIN_512_IV_384, sizeof(ctx->X));
+		break;
+	case  512:
+		memcpy(ctx->X, SKEIN_512_IV_512, sizeof(ctx->X));
+		break;
+#endif
+	default:
+		/* build/process config block for hashing */
+		Skein_Start_New_Type(ctx, CFG_FINAL);	/* set tweaks: T0=0; T1=CFG | FINAL */
+
+		memset(&cfg.w, 0, sizeof(cfg.w));	/* pre-pad cfg.w[] with zeroes */
+		cfg.w[0] = Skein_Swap64(SKEIN_SCHEMA_VER);	/* set the schema, version */
+		cfg.w[1] = Skein_Swap64(hashBitLen);	/* hash result length in bits */
+		cfg.w[2] = Skein_Swap64(SKEIN_CFG_TREE_INFO_SEQUENTIAL);
+
+		/* compute the initial chaining values from config block */
+		memset(ctx->X, 0, sizeof(ctx->X));	/* zero the chaining variables */
+		Skein_512_Process_Block(ctx, cfg.b, 1, SKEIN_CFG_STR_LEN);
+		break;
+	}
 
 	/* The chaining vars ctx->X are now initialized for the given hashBitLen. */
 	/* Set up to process the data message portion of the hash (default) */
@@ -327,6 +400,53 @@ int Skein_512_InitExt(Skein_512_Ctxt_t * ctx, size_t hashBitLen,
 	return SKEIN_SUCCESS;
 }
 
+/* one UBI call over an argument block, the result is the new chaining value */
+static void Skein_512_Arg_Block(Skein_512_Ctxt_t * ctx, u64b_t blkType,
+				 const u08b_t * arg, size_t argBytes)
+{
+	u08b_t X[SKEIN_512_STATE_BYTES];	/* not needed, ctx->X is the result */
+
+	Skein_Set_T0_T1(ctx, 0, SKEIN_T1_FLAG_FIRST | blkType);
+	ctx->h.bCnt = 0;
+	Skein_512_Update(ctx, arg, argBytes);
+	Skein_512_Final_Pad(ctx, X);
+	Skein_Start_New_Type(ctx, MSG);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* init the context with all optional arguments (in the spec's order) */
+int Skein_512_InitArgs(Skein_512_Ctxt_t * ctx, size_t hashBitLen,
+		       const Skein_Args_t * args)
+{
+	Skein_Assert(args->persBytes == 0 || args->pers != NULL, SKEIN_FAIL);
+	Skein_Assert(args->pkBytes == 0 || args->pk != NULL, SKEIN_FAIL);
+
+	if (Skein_512_InitExt(ctx, hashBitLen, args->treeInfo, args->key,
+			       args->keyBytes) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	if (args->persBytes)
+		Skein_512_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_PERS, args->pers,
+				     args->persBytes);
+	if (args->pkBytes)
+		Skein_512_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_PK, args->pk,
+				     args->pkBytes);
+	return Skein_512_Nonce(ctx, args->nonce, args->nonceBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* add a nonce to a context that has no message data yet */
+int Skein_512_Nonce(Skein_512_Ctxt_t * ctx, const u08b_t * nonce,
+		    size_t nonceBytes)
+{
+	Skein_Assert(ctx->h.bCnt == 0 && ctx->h.T[0] == 0, SKEIN_FAIL);	/* no message yet */
+	Skein_Assert(nonceBytes == 0 || nonce != NULL, SKEIN_FAIL);
+
+	if (nonceBytes)
+		Skein_512_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_NONCE, nonce,
+				     nonceBytes);
+	return SKEIN_SUCCESS;
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* process the input bytes */
 int Skein_512_Update(Skein_512_Ctxt_t * ctx, const u08b_t * msg,
@@ -335,6 +455,7 @@ int Skein_512_Update(Skein_512_Ctxt_t * ctx, const u08b_t * msg,
 	size_t n;
 
 	Skein_Assert(ctx->h.bCnt <= SKEIN_512_BLOCK_BYTES, SKEIN_FAIL);	/* catch uninitialized context */
+	Skein_Stats_Add(updates, 1);
 
 	/* process full blocks, if any */
 	if (msgByteCnt + ctx->h.bCnt > SKEIN_512_BLOCK_BYTES) {
@@ -348,15 +469,19 @@ int Skein_512_Update(Skein_512_Ctxt_t * ctx, const u08b_t * msg,
 				ctx->h.bCnt += n;
 			}
 			Skein_assert(ctx->h.bCnt == SKEIN_512_BLOCK_BYTES);
-			Skein_512_Process_Block(ctx, ctx->b, 1,
-						SKEIN_512_BLOCK_BYTES);
+			Skein_512_Process_Block_Aligned(ctx, ctx->b, 1,
+							SKEIN_512_BLOCK_BYTES);
 			ctx->h.bCnt = 0;
 		}
 		/* now process any remaining full blocks, directly from input message data */
 		if (msgByteCnt > SKEIN_512_BLOCK_BYTES) {
 			n = (msgByteCnt - 1) / SKEIN_512_BLOCK_BYTES;	/* number of full blocks to process */
-			Skein_512_Process_Block(ctx, msg, n,
-						SKEIN_512_BLOCK_BYTES);
+			if (Skein_Is_Aligned(msg))	/* the faster vector loads */
+				Skein_512_Process_Block_Aligned(ctx, msg, n,
+								SKEIN_512_BLOCK_BYTES);
+			else
+				Skein_512_Process_Block(ctx, msg, n,
+							SKEIN_512_BLOCK_BYTES);
 			msgByteCnt -= n * SKEIN_512_BLOCK_BYTES;
 			msg += n * SKEIN_512_BLOCK_BYTES;
 		}
@@ -366,6 +491,7 @@ int Skein_512_Update(Skein_512_Ctxt_t * ctx, const u08b_t * msg,
 	/* copy any remaining source message data bytes into b[] */
 	if (msgByteCnt) {
 		Skein_assert(msgByteCnt + ctx->h.bCnt <= SKEIN_512_BLOCK_BYTES);
+		Skein_Stats_Add(bufferedUpdates, 1);
 		memcpy(&ctx->b[ctx->h.bCnt], msg, msgByteCnt);
 		ctx->h.bCnt += msgByteCnt;
 	}
@@ -373,12 +499,76 @@ int Skein_512_Update(Skein_512_Ctxt_t * ctx, const u08b_t * msg,
 	return SKEIN_SUCCESS;
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* run blkCnt blocks of up to four contexts through the multi-buffer kernels */
+static void Skein_512_Process_Lanes(Skein_512_Ctxt_t * ctx[],
+				    const u08b_t * blkPtr[], size_t blkCnt,
+				    const size_t byteCntAdd[], size_t lanes)
+{
+	Skein_assert(lanes <= 4);
+
+	if (lanes == 4) {
+		Skein_512_Process_Block_x4(ctx, blkPtr, blkCnt, byteCntAdd);
+		return;
+	}
+	if (lanes >= 2) {
+		Skein_512_Process_Block_x2(ctx, blkPtr, blkCnt, byteCntAdd);
+		ctx += 2;
+		blkPtr += 2;
+		byteCntAdd += 2;
+		lanes -= 2;
+	}
+	if (lanes)
+		Skein_512_Process_Block(ctx[0], blkPtr[0], blkCnt,
+					byteCntAdd[0]);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* run Threefish in "counter mode", up to four counter blocks at once */
+void Skein_512_Output_Blocks(const Skein_512_Ctxt_t * ctx, u64b_t ctr,
+			     u08b_t * out, size_t byteCnt)
+{
+	Skein_512_Ctxt_t lane[4];
+	Skein_512_Ctxt_t *lctx[4];
+	const u08b_t *lblk[4];
+	static const size_t add[4] = { sizeof(u64b_t), sizeof(u64b_t),
+		sizeof(u64b_t), sizeof(u64b_t)
+	};
+	size_t i, n, lanes;
+
+	while (byteCnt) {
+		lanes = (byteCnt - 1) / SKEIN_512_BLOCK_BYTES + 1;	/* output blocks left to go */
+		if (lanes > 4)
+			lanes = 4;
+		for (i = 0; i < lanes; i++) {
+			lane[i].h.hashBitLen = ctx->h.hashBitLen;
+			memcpy(lane[i].X, ctx->X, sizeof(lane[i].X));	/* the counter mode "key" */
+			memset(lane[i].b, 0, sizeof(lane[i].b));
+			((u64b_t *) lane[i].b)[0] = Skein_Swap64(ctr + i);	/* build the counter block */
+			Skein_Start_New_Type(&lane[i], OUT_FINAL);
+			lctx[i] = &lane[i];
+			lblk[i] = lane[i].b;
+		}
+		Skein_512_Process_Lanes(lctx, lblk, 1, add, lanes);	/* run "counter mode" */
+		for (i = 0; i < lanes; i++) {
+			n = byteCnt;	/* number of output bytes left to go */
+			if (n >= SKEIN_512_BLOCK_BYTES)
+				n = SKEIN_512_BLOCK_BYTES;
+			Skein_Put64_LSB_First(out, lane[i].X, n);	/* "output" the ctr mode bytes */
+			Skein_Show_Final(512, &lane[i].h, n, out);
+			out += n;
+			byteCnt -= n;
+		}
+		ctr += lanes;
+	}
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* finalize the hash computation and output the result */
 int Skein_512_Final(Skein_512_Ctxt_t * ctx, u08b_t * hashVal)
 {
-	size_t i, n, byteCnt;
-	u64b_t X[SKEIN_512_STATE_WORDS];
+	size_t byteCnt;
+
 	Skein_Assert(ctx->h.bCnt <= SKEIN_512_BLOCK_BYTES, SKEIN_FAIL);	/* catch uninitialized context */
 
 	ctx->h.T[1] |= SKEIN_T1_FLAG_FINAL;	/* tag as the final block */
@@ -386,27 +576,201 @@ int Skein_512_Final(Skein_512_Ctxt_t * ctx, u08b_t * hashVal)
 		memset(&ctx->b[ctx->h.bCnt], 0,
 		       SKEIN_512_BLOCK_BYTES - ctx->h.bCnt);
 
-	Skein_512_Process_Block(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
+	Skein_512_Process_Block_Aligned(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
 
 	/* now output the result */
 	byteCnt = (ctx->h.hashBitLen + 7) >> 3;	/* total number of output bytes */
 
 	/* run Threefish in "counter mode" to generate more output */
-	memset(ctx->b, 0, sizeof(ctx->b));	/* zero out b[], so it can hold the counter */
-	memcpy(X, ctx->X, sizeof(X));	/* keep a local copy of counter mode "key" */
-	for (i = 0; i * SKEIN_512_BLOCK_BYTES < byteCnt; i++) {
-		((u64b_t *) ctx->b)[0] = Skein_Swap64((u64b_t) i);	/* build the counter block */
-		Skein_Start_New_Type(ctx, OUT_FINAL);
-		Skein_512_Process_Block(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
-		n = byteCnt - i * SKEIN_512_BLOCK_BYTES;	/* number of output bytes left to go */
-		if (n >= SKEIN_512_BLOCK_BYTES)
-			n = SKEIN_512_BLOCK_BYTES;
-		Skein_Put64_LSB_First(hashVal + i * SKEIN_512_BLOCK_BYTES, ctx->X, n);	/* "output" the ctr mode bytes */
-		Skein_Show_Final(512, &ctx->h, n,
-				 hashVal + i * SKEIN_512_BLOCK_BYTES);
-		memcpy(ctx->X, X, sizeof(X));	/* restore the counter mode key for next time */
+	Skein_512_Output_Blocks(ctx, 0, hashVal, byteCnt);
+
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* all-in-one hash helper, without Update() for a message of one block */
+int Skein_512_Hash_Short(size_t hashBitLen, const u08b_t * msg,
+			 size_t msgByteCnt, u08b_t * hashVal)
+{
+	Skein_512_Ctxt_t ctx;
+	int r;
+
+	r = Skein_512_Init(&ctx, hashBitLen);	/* usually just the precomputed IV */
+	if (r != SKEIN_SUCCESS)
+		return r;
+
+	if (msgByteCnt > SKEIN_512_BLOCK_BYTES) {	/* more than one block: buffer it */
+		Skein_512_Update(&ctx, msg, msgByteCnt);
+		return Skein_512_Final(&ctx, hashVal);
+	}
+
+	/* no Update(): the message is the final block, Final() pads it */
+	if (msgByteCnt)		/* msg may be NULL for the empty message */
+		memcpy(ctx.b, msg, msgByteCnt);
+	ctx.h.bCnt = msgByteCnt;
+
+	return Skein_512_Final(&ctx, hashVal);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash (up to) four messages, with all lanes in lockstep where possible */
+static void Skein_512_Hash_Lanes(Skein_512_Ctxt_t * ctx[],
+				 const u08b_t * msg[],
+				 const size_t msgByteCnt[],
+				 u08b_t * hashVal[], size_t cnt)
+{
+	Skein_512_Ctxt_t *lctx[4];
+	const u08b_t *lblk[4];
+	const u08b_t *p[4];
+	size_t left[4], add[4], idx[4];
+	u64b_t X[4][SKEIN_512_STATE_WORDS];
+	size_t i, n, m, lanes;
+
+	for (i = 0; i < cnt; i++) {
+		p[i] = msg[i];
+		left[i] = msgByteCnt[i];
 	}
 
+	/* process full blocks directly from the messages, as long as there
+	 * are at least two lanes left that have some. (The last block always
+	 * stays for Final(), exactly as in Skein_512_Update().) */
+	for (;;) {
+		lanes = m = 0;
+		for (i = 0; i < cnt; i++) {
+			if (ctx[i]->h.bCnt || left[i] <= SKEIN_512_BLOCK_BYTES)
+				continue;	/* this one goes through Update() */
+			n = (left[i] - 1) / SKEIN_512_BLOCK_BYTES;	/* number of full blocks to process */
+			if (lanes == 0 || n < m)
+				m = n;
+			lctx[lanes] = ctx[i];
+			lblk[lanes] = p[i];
+			add[lanes] = SKEIN_512_BLOCK_BYTES;
+			idx[lanes++] = i;
+		}
+		if (lanes < 2)
+			break;
+		Skein_512_Process_Lanes(lctx, lblk, m, add, lanes);
+		for (i = 0; i < lanes; i++) {
+			p[idx[i]] += m * SKEIN_512_BLOCK_BYTES;
+			left[idx[i]] -= m * SKEIN_512_BLOCK_BYTES;
+		}
+	}
+
+	/* anything left over goes through the normal buffering */
+	for (i = 0; i < cnt; i++)
+		Skein_512_Update(ctx[i], p[i], left[i]);
+
+	/* final block and output stage of all lanes with single block outputs */
+	lanes = 0;
+	for (i = 0; i < cnt; i++) {
+		if (ctx[i]->h.hashBitLen > 8 * SKEIN_512_BLOCK_BYTES) {
+			Skein_512_Final(ctx[i], hashVal[i]);	/* long output: do it the normal way */
+			continue;
+		}
+		Skein_assert(ctx[i]->h.bCnt <= SKEIN_512_BLOCK_BYTES);	/* catch uninitialized context */
+
+		ctx[i]->h.T[1] |= SKEIN_T1_FLAG_FINAL;	/* tag as the final block */
+		if (ctx[i]->h.bCnt < SKEIN_512_BLOCK_BYTES)	/* zero pad b[] if necessary */
+			memset(&ctx[i]->b[ctx[i]->h.bCnt], 0,
+			       SKEIN_512_BLOCK_BYTES - ctx[i]->h.bCnt);
+		lctx[lanes] = ctx[i];
+		lblk[lanes] = ctx[i]->b;
+		add[lanes] = ctx[i]->h.bCnt;
+		idx[lanes++] = i;
+	}
+	if (lanes == 0)
+		return;
+	Skein_512_Process_Lanes(lctx, lblk, 1, add, lanes);	/* process the final blocks */
+
+	/* run Threefish in "counter mode" (just counter 0 here) */
+	for (i = 0; i < lanes; i++) {
+		memset(lctx[i]->b, 0, sizeof(lctx[i]->b));	/* counter block 0 */
+		memcpy(X[i], lctx[i]->X, sizeof(X[i]));	/* keep a local copy of counter mode "key" */
+		Skein_Start_New_Type(lctx[i], OUT_FINAL);
+		add[i] = sizeof(u64b_t);
+	}
+	Skein_512_Process_Lanes(lctx, lblk, 1, add, lanes);
+	for (i = 0; i < lanes; i++) {
+		n = (lctx[i]->h.hashBitLen + 7) >> 3;	/* number of output bytes */
+		Skein_Put64_LSB_First(hashVal[idx[i]], lctx[i]->X, n);	/* "output" the ctr mode bytes */
+		Skein_Show_Final(512, &lctx[i]->h, n, hashVal[idx[i]]);
+		memcpy(lctx[i]->X, X[i], sizeof(X[i]));	/* restore the counter mode key */
+	}
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash cnt independent messages, using the multi-buffer block functions */
+int Skein_512_Hash_Many(Skein_512_Ctxt_t * ctx[], const u08b_t * msg[],
+			const size_t msgByteCnt[], u08b_t * hashVal[],
+			size_t cnt)
+{
+	size_t i;
+
+	for (i = 0; i < cnt; i += 4)
+		Skein_512_Hash_Lanes(ctx + i, msg + i, msgByteCnt + i,
+				     hashVal + i, (cnt - i < 4) ? cnt - i : 4);
+
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* finish the message, the output is then read with XOF_Read() */
+int Skein_512_XOF_Start(Skein_512_XOF_t * xof, const Skein_512_Ctxt_t * ctx)
+{
+	Skein_Assert(ctx->h.bCnt <= SKEIN_512_BLOCK_BYTES, SKEIN_FAIL);	/* catch uninitialized context */
+
+	memcpy(&xof->ctx, ctx, sizeof(xof->ctx));
+	Skein_512_Final_Pad(&xof->ctx, xof->buf);	/* X is now the counter mode "key" */
+
+	xof->outBytes = ((u64b_t) xof->ctx.h.hashBitLen + 7) >> 3;	/* total number of output bytes */
+	xof->offset = 0;
+	xof->bufBlk = ~(u64b_t) 0;	/* buf[] holds no output block */
+
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the next n output bytes (fewer at the end of the output) */
+size_t Skein_512_XOF_Read(Skein_512_XOF_t * xof, u08b_t * out, size_t n)
+{
+	size_t done, k, offs;
+	u64b_t blk;
+
+	if (n > xof->outBytes - xof->offset)
+		n = (size_t) (xof->outBytes - xof->offset);
+
+	for (done = 0; done < n; done += k) {
+		blk = xof->offset / SKEIN_512_BLOCK_BYTES;
+		offs = (size_t) (xof->offset % SKEIN_512_BLOCK_BYTES);
+		if (offs == 0 && n - done >= SKEIN_512_BLOCK_BYTES) {
+			/* whole blocks go straight to the caller */
+			k = (n - done) & ~(size_t) (SKEIN_512_BLOCK_BYTES - 1);
+			Skein_512_Output_Blocks(&xof->ctx, blk, out + done, k);
+		} else {
+			if (xof->bufBlk != blk) {
+				Skein_512_Output_Blocks(&xof->ctx, blk, xof->buf,
+							SKEIN_512_BLOCK_BYTES);
+				xof->bufBlk = blk;
+			}
+			k = SKEIN_512_BLOCK_BYTES - offs;
+			if (k > n - done)
+				k = n - done;
+			memcpy(out + done, xof->buf + offs, k);
+		}
+		xof->offset += k;
+	}
+
+	return n;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* continue reading at byte offset "offset" of the output */
+int Skein_512_XOF_Seek(Skein_512_XOF_t * xof, u64b_t offset)
+{
+	if (offset > xof->outBytes)
+		return SKEIN_FAIL;
+
+	xof->offset = offset;
 	return SKEIN_SUCCESS;
 }
 
@@ -433,18 +797,34 @@ int Skein1024_Init(Skein1024_Ctxt_t * ctx, size_t hashBitLen)
 
 	Skein_Assert(hashBitLen > 0, SKEIN_BAD_HASHLEN);
 
-	/* build/process config block for hashing */
 	ctx->h.hashBitLen = hashBitLen;	/* output hash byte count */
-	Skein_Start_New_Type(ctx, CFG_FINAL);	/* set tweaks: T0=0; T1=CFG | FINAL */
-
-	memset(&cfg.w, 0, sizeof(cfg.w));	/* pre-pad cfg.w[] with zeroes */
-	cfg.w[0] = Skein_Swap64(SKEIN_SCHEMA_VER);	/* set the schema, version */
-	cfg.w[1] = Skein_Swap64(hashBitLen);	/* hash result length in bits */
-	cfg.w[2] = Skein_Swap64(SKEIN_CFG_TREE_INFO_SEQUENTIAL);
 
-	/* compute the initial chaining values from config block */
-	memset(ctx->X, 0, sizeof(ctx->X));	/* zero the chaining variables */
-	Skein1024_Process_Block(ctx, cfg.b, 1, SKEIN_CFG_STR_LEN);
+	switch (hashBitLen) {	/* use pre-computed values, where available */
+#if SKEIN_USE_PRECOMP
+	case  384:
+		memcpy(ctx->X, SKEIN1024_IV_384, sizeof(ctx->X));
+		break;
+	case  512:
+		memcpy(ctx->X, SKEIN1024_IV_512, sizeof(ctx->X));
+		break;
+	case 1024:
+		memcpy(ctx->X, SKEIN1024_IV_1024, sizeof(ctx->X));
+		break;
+#endif
+	default:
+		/* build/process config block for hashing */
+		Skein_Start_New_Type(ctx, CFG_FINAL);	/* set tweaks: T0=0; T1=CFG | FINAL */
+
+		memset(&cfg.w, 0, sizeof(cfg.w));	/* pre-pad cfg.w[] with zeroes */
+		cfg.w[0] = Skein_Swap64(SKEIN_SCHEMA_VER);	/* set the schema, version */
+		cfg.w[1] = Skein_Swap64(hashBitLen);	/* hash result length in bits */
+		cfg.w[2] = Skein_Swap64(SKEIN_CFG_TREE_INFO_SEQUENTIAL);
+
+		/* compute the initial chaining values from config block */
+		memset(ctx->X, 0, sizeof(ctx->X));	/* zero the chaining variables */
+		Skein1024_Process_Block(ctx, cfg.b, 1, SKEIN_CFG_STR_LEN);
+		break;
+	}
 
 	/* The chaining vars ctx->X are now initialized for the given hashBitLen. */
 	/* Set up to process the data message portion of the hash (default) */
@@ -506,6 +886,53 @@ int Skein1024_InitExt(Skein1024_Ctxt_t * ctx, size_t hashBitLen,
 	return SKEIN_SUCCESS;
 }
 
+/* one UBI call over an argument block, the result is the new chaining value */
+static void Skein1024_Arg_Block(Skein1024_Ctxt_t * ctx, u64b_t blkType,
+				 const u08b_t * arg, size_t argBytes)
+{
+	u08b_t X[SKEIN1024_STATE_BYTES];	/* not needed, ctx->X is the result */
+
+	Skein_Set_T0_T1(ctx, 0, SKEIN_T1_FLAG_FIRST | blkType);
+	ctx->h.bCnt = 0;
+	Skein1024_Update(ctx, arg, argBytes);
+	Skein1024_Final_Pad(ctx, X);
+	Skein_Start_New_Type(ctx, MSG);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* init the context with all optional arguments (in the spec's order) */
+int Skein1024_InitArgs(Skein1024_Ctxt_t * ctx, size_t hashBitLen,
+		       const Skein_Args_t * args)
+{
+	Skein_Assert(args->persBytes == 0 || args->pers != NULL, SKEIN_FAIL);
+	Skein_Assert(args->pkBytes == 0 || args->pk != NULL, SKEIN_FAIL);
+
+	if (Skein1024_InitExt(ctx, hashBitLen, args->treeInfo, args->key,
+			       args->keyBytes) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	if (args->persBytes)
+		Skein1024_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_PERS, args->pers,
+				     args->persBytes);
+	if (args->pkBytes)
+		Skein1024_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_PK, args->pk,
+				     args->pkBytes);
+	return Skein1024_Nonce(ctx, args->nonce, args->nonceBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* add a nonce to a context that has no message data yet */
+int Skein1024_Nonce(Skein1024_Ctxt_t * ctx, const u08b_t * nonce,
+		    size_t nonceBytes)
+{
+	Skein_Assert(ctx->h.bCnt == 0 && ctx->h.T[0] == 0, SKEIN_FAIL);	/* no message yet */
+	Skein_Assert(nonceBytes == 0 || nonce != NULL, SKEIN_FAIL);
+
+	if (nonceBytes)
+		Skein1024_Arg_Block(ctx, SKEIN_T1_BLK_TYPE_NONCE, nonce,
+				     nonceBytes);
+	return SKEIN_SUCCESS;
+}
+
 /*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 /* process the input bytes */
 int Skein1024_Update(Skein1024_Ctxt_t * ctx, const u08b_t * msg,
@@ -514,6 +941,7 @@ int Skein1024_Update(Skein1024_Ctxt_t * ctx, const u08b_t * msg,
 	size_t n;
 
 	Skein_Assert(ctx->h.bCnt <= SKEIN1024_BLOCK_BYTES, SKEIN_FAIL);	/* catch uninitialized context */
+	Skein_Stats_Add(updates, 1);
 
 	/* process full blocks, if any */
 	if (msgByteCnt + ctx->h.bCnt > SKEIN1024_BLOCK_BYTES) {
@@ -527,15 +955,19 @@ int Skein1024_Update(Skein1024_Ctxt_t * ctx, const u08b_t * msg,
 				ctx->h.bCnt += n;
 			}
 			Skein_assert(ctx->h.bCnt == SKEIN1024_BLOCK_BYTES);
-			Skein1024_Process_Block(ctx, ctx->b, 1,
-						SKEIN1024_BLOCK_BYTES);
+			Skein1024_Process_Block_Aligned(ctx, ctx->b, 1,
+							SKEIN1024_BLOCK_BYTES);
 			ctx->h.bCnt = 0;
 		}
 		/* now process any remaining full blocks, directly from input message data */
 		if (msgByteCnt > SKEIN1024_BLOCK_BYTES) {
 			n = (msgByteCnt - 1) / SKEIN1024_BLOCK_BYTES;	/* number of full blocks to process */
-			Skein1024_Process_Block(ctx, msg, n,
-						SKEIN1024_BLOCK_BYTES);
+			if (Skein_Is_Aligned(msg))	/* the faster vector loads */
+				Skein1024_Process_Block_Aligned(ctx, msg, n,
+								SKEIN1024_BLOCK_BYTES);
+			else
+				Skein1024_Process_Block(ctx, msg, n,
+							SKEIN1024_BLOCK_BYTES);
 			msgByteCnt -= n * SKEIN1024_BLOCK_BYTES;
 			msg += n * SKEIN1024_BLOCK_BYTES;
 		}
@@ -545,6 +977,7 @@ int Skein1024_Update(Skein1024_Ctxt_t * ctx, const u08b_t * msg,
 	/* copy any remaining source message data bytes into b[] */
 	if (msgByteCnt) {
 		Skein_assert(msgByteCnt + ctx->h.bCnt <= SKEIN1024_BLOCK_BYTES);
+		Skein_Stats_Add(bufferedUpdates, 1);
 		memcpy(&ctx->b[ctx->h.bCnt], msg, msgByteCnt);
 		ctx->h.bCnt += msgByteCnt;
 	}
@@ -565,18 +998,18 @@ int Skein1024_Final(Skein1024_Ctxt_t * ctx, u08b_t * hashVal)
 		memset(&ctx->b[ctx->h.bCnt], 0,
 		       SKEIN1024_BLOCK_BYTES - ctx->h.bCnt);
 
-	Skein1024_Process_Block(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
+	Skein1024_Process_Block_Aligned(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
 
 	/* now output the result */
 	byteCnt = (ctx->h.hashBitLen + 7) >> 3;	/* total number of output bytes */
 
-	/* run Threefish in "counter mode" to generate output */
+	/* run Threefish in "counter mode" to generate output, one block at a time */
 	memset(ctx->b, 0, sizeof(ctx->b));	/* zero out b[], so it can hold the counter */
 	memcpy(X, ctx->X, sizeof(X));	/* keep a local copy of counter mode "key" */
 	for (i = 0; i * SKEIN1024_BLOCK_BYTES < byteCnt; i++) {
 		((u64b_t *) ctx->b)[0] = Skein_Swap64((u64b_t) i);	/* build the counter block */
 		Skein_Start_New_Type(ctx, OUT_FINAL);
-		Skein1024_Process_Block(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
+		Skein1024_Process_Block_Aligned(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
 		n = byteCnt - i * SKEIN1024_BLOCK_BYTES;	/* number of output bytes left to go */
 		if (n >= SKEIN1024_BLOCK_BYTES)
 			n = SKEIN1024_BLOCK_BYTES;
@@ -588,6 +1021,31 @@ int Skein1024_Final(Skein1024_Ctxt_t * ctx, u08b_t * hashVal)
 	return SKEIN_SUCCESS;
 }
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* all-in-one hash helper, without Update() for a message of one block */
+int Skein1024_Hash_Short(size_t hashBitLen, const u08b_t * msg,
+			 size_t msgByteCnt, u08b_t * hashVal)
+{
+	Skein1024_Ctxt_t ctx;
+	int r;
+
+	r = Skein1024_Init(&ctx, hashBitLen);	/* usually just the precomputed IV */
+	if (r != SKEIN_SUCCESS)
+		return r;
+
+	if (msgByteCnt > SKEIN1024_BLOCK_BYTES) {	/* more than one block: buffer it */
+		Skein1024_Update(&ctx, msg, msgByteCnt);
+		return Skein1024_Final(&ctx, hashVal);
+	}
+
+	/* no Update(): the message is the final block, Final() pads it */
+	if (msgByteCnt)		/* msg may be NULL for the empty message */
+		memcpy(ctx.b, msg, msgByteCnt);
+	ctx.h.bCnt = msgByteCnt;
+
+	return Skein1024_Final(&ctx, hashVal);
+}
+
 #if defined(SKEIN_CODE_SIZE) || defined(SKEIN_PERF)
 size_t Skein1024_API_CodeSize(void)
 {
@@ -610,7 +1068,7 @@ int Skein_256_Final_Pad(Skein_256_Ctxt_t * ctx, u08b_t * hashVal)
 	if (ctx->h.bCnt < SKEIN_256_BLOCK_BYTES)	/* zero pad b[] if necessary */
 		memset(&ctx->b[ctx->h.bCnt], 0,
 		       SKEIN_256_BLOCK_BYTES - ctx->h.bCnt);
-	Skein_256_Process_Block(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
+	Skein_256_Process_Block_Aligned(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
 
 	Skein_Put64_LSB_First(hashVal, ctx->X, SKEIN_256_BLOCK_BYTES);	/* "output" the state bytes */
 
@@ -627,7 +1085,7 @@ int Skein_512_Final_Pad(Skein_512_Ctxt_t * ctx, u08b_t * hashVal)
 	if (ctx->h.bCnt < SKEIN_512_BLOCK_BYTES)	/* zero pad b[] if necessary */
 		memset(&ctx->b[ctx->h.bCnt], 0,
 		       SKEIN_512_BLOCK_BYTES - ctx->h.bCnt);
-	Skein_512_Process_Block(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
+	Skein_512_Process_Block_Aligned(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
 
 	Skein_Put64_LSB_First(hashVal, ctx->X, SKEIN_512_BLOCK_BYTES);	/* "output" the state bytes */
 
@@ -644,7 +1102,7 @@ int Skein1024_Final_Pad(Skein1024_Ctxt_t * ctx, u08b_t * hashVal)
 	if (ctx->h.bCnt < SKEIN1024_BLOCK_BYTES)	/* zero pad b[] if necessary */
 		memset(&ctx->b[ctx->h.bCnt], 0,
 		       SKEIN1024_BLOCK_BYTES - ctx->h.bCnt);
-	Skein1024_Process_Block(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
+	Skein1024_Process_Block_Aligned(ctx, ctx->b, 1, ctx->h.bCnt);	/* process the final block */
 
 	Skein_Put64_LSB_First(hashVal, ctx->X, SKEIN1024_BLOCK_BYTES);	/* "output" the state bytes */
 
@@ -662,13 +1120,13 @@ int Skein_256_Output(Skein_256_Ctxt_t * ctx, u08b_t * hashVal)
 	/* now output the result */
 	byteCnt = (ctx->h.hashBitLen + 7) >> 3;	/* total number of output bytes */
 
-	/* run Threefish in "counter mode" to generate output */
+	/* run Threefish in "counter mode" to generate output, one block at a time */
 	memset(ctx->b, 0, sizeof(ctx->b));	/* zero out b[], so it can hold the counter */
 	memcpy(X, ctx->X, sizeof(X));	/* keep a local copy of counter mode "key" */
 	for (i = 0; i * SKEIN_256_BLOCK_BYTES < byteCnt; i++) {
 		((u64b_t *) ctx->b)[0] = Skein_Swap64((u64b_t) i);	/* build the counter block */
 		Skein_Start_New_Type(ctx, OUT_FINAL);
-		Skein_256_Process_Block(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
+		Skein_256_Process_Block_Aligned(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
 		n = byteCnt - i * SKEIN_256_BLOCK_BYTES;	/* number of output bytes left to go */
 		if (n >= SKEIN_256_BLOCK_BYTES)
 			n = SKEIN_256_BLOCK_BYTES;
@@ -684,28 +1142,15 @@ int Skein_256_Output(Skein_256_Ctxt_t * ctx, u08b_t * hashVal)
 /* just do the OUTPUT stage                                       */
 int Skein_512_Output(Skein_512_Ctxt_t * ctx, u08b_t * hashVal)
 {
-	size_t i, n, byteCnt;
-	u64b_t X[SKEIN_512_STATE_WORDS];
+	size_t byteCnt;
+
 	Skein_Assert(ctx->h.bCnt <= SKEIN_512_BLOCK_BYTES, SKEIN_FAIL);	/* catch uninitialized context */
 
 	/* now output the result */
 	byteCnt = (ctx->h.hashBitLen + 7) >> 3;	/* total number of output bytes */
 
 	/* run Threefish in "counter mode" to generate output */
-	memset(ctx->b, 0, sizeof(ctx->b));	/* zero out b[], so it can hold the counter */
-	memcpy(X, ctx->X, sizeof(X));	/* keep a local copy of counter mode "key" */
-	for (i = 0; i * SKEIN_512_BLOCK_BYTES < byteCnt; i++) {
-		((u64b_t *) ctx->b)[0] = Skein_Swap64((u64b_t) i);	/* build the counter block */
-		Skein_Start_New_Type(ctx, OUT_FINAL);
-		Skein_512_Process_Block(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
-		n = byteCnt - i * SKEIN_512_BLOCK_BYTES;	/* number of output bytes left to go */
-		if (n >= SKEIN_512_BLOCK_BYTES)
-			n = SKEIN_512_BLOCK_BYTES;
-		Skein_Put64_LSB_First(hashVal + i * SKEIN_512_BLOCK_BYTES, ctx->X, n);	/* "output" the ctr mode bytes */
-		Skein_Show_Final(256, &ctx->h, n,
-				 hashVal + i * SKEIN_512_BLOCK_BYTES);
-		memcpy(ctx->X, X, sizeof(X));	/* restore the counter mode key for next time */
-	}
+	Skein_512_Output_Blocks(ctx, 0, hashVal, byteCnt);
 	return SKEIN_SUCCESS;
 }
 
@@ -720,13 +1165,13 @@ int Skein1024_Output(Skein1024_Ctxt_t * ctx, u08b_t * hashVal)
 	/* now output the result */
 	byteCnt = (ctx->h.hashBitLen + 7) >> 3;	/* total number of output bytes */
 
-	/* run Threefish in "counter mode" to generate output */
+	/* run Threefish in "counter mode" to generate output, one block at a time */
 	memset(ctx->b, 0, sizeof(ctx->b));	/* zero out b[], so it can hold the counter */
 	memcpy(X, ctx->X, sizeof(X));	/* keep a local copy of counter mode "key" */
 	for (i = 0; i * SKEIN1024_BLOCK_BYTES < byteCnt; i++) {
 		((u64b_t *) ctx->b)[0] = Skein_Swap64((u64b_t) i);	/* build the counter block */
 		Skein_Start_New_Type(ctx, OUT_FINAL);
-		Skein1024_Process_Block(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
+		Skein1024_Process_Block_Aligned(ctx, ctx->b, 1, sizeof(u64b_t));	/* run "counter mode" */
 		n = byteCnt - i * SKEIN1024_BLOCK_BYTES;	/* number of output bytes left to go */
 		if (n >= SKEIN1024_BLOCK_BYTES)
 			n = SKEIN1024_BLOCK_BYTES;
@@ -64,20 +64,20 @@ typedef struct {
 
 typedef struct {		/*  256-bit Skein hash context structure */
 	Skein_Ctxt_Hdr_t h;	/* common header context variables */
-	u64b_t X[SKEIN_256_STATE_WORDS];	/* chaining variables */
-	u08b_t b[SKEIN_256_BLOCK_BYTES];	/* partial block buffer (8-byte aligned) */
+	u64b_t X[SKEIN_256_STATE_WORDS] SKEIN_ALIGNED;	/* chaining variables */
+	u08b_t b[SKEIN_256_BLOCK_BYTES] SKEIN_ALIGNED;	/* partial block buffer */
 } Skein_256_Ctxt_t;
 
 typedef struct {		/*  512-bit Skein hash context structure */
 	Skein_Ctxt_Hdr_t h;	/* common header context variables */
-	u64b_t X[SKEIN_512_STATE_WORDS];	/* chaining variables */
-	u08b_t b[SKEIN_512_BLOCK_BYTES];	/* partial block buffer (8-byte aligned) */
+	u64b_t X[SKEIN_512_STATE_WORDS] SKEIN_ALIGNED;	/* chaining variables */
+	u08b_t b[SKEIN_512_BLOCK_BYTES] SKEIN_ALIGNED;	/* partial block buffer */
 } Skein_512_Ctxt_t;
 
 typedef struct {		/* 1024-bit Skein hash context structure */
 	Skein_Ctxt_Hdr_t h;	/* common header context variables */
-	u64b_t X[SKEIN1024_STATE_WORDS];	/* chaining variables */
-	u08b_t b[SKEIN1024_BLOCK_BYTES];	/* partial block buffer (8-byte aligned) */
+	u64b_t X[SKEIN1024_STATE_WORDS] SKEIN_ALIGNED;	/* chaining variables */
+	u08b_t b[SKEIN1024_BLOCK_BYTES] SKEIN_ALIGNED;	/* partial block buffer */
 } Skein1024_Ctxt_t;
 
 /*   Skein APIs for (incremental) "straight hashing" */
@@ -85,6 +85,14 @@ int Skein_256_Init(Skein_256_Ctxt_t * ctx, size_t hashBitLen);
 int Skein_512_Init(Skein_512_Ctxt_t * ctx, size_t hashBitLen);
 int Skein1024_Init(Skein1024_Ctxt_t * ctx, size_t hashBitLen);
 
+/*
+**   Update() hashes full blocks straight from msg, and uses the faster
+**   aligned vector loads only if they start at a multiple of
+**   SKEIN_ALIGNMENT. After an Update() that leaves a partial block in the
+**   buffer, the next one first fills that block from msg, and its other
+**   blocks usually start misaligned. Only aligned data passed in
+**   multiples of the block size gets the aligned loads every time.
+**/
 int Skein_256_Update(Skein_256_Ctxt_t * ctx, const u08b_t * msg,
 		     size_t msgByteCnt);
 int Skein_512_Update(Skein_512_Ctxt_t * ctx, const u08b_t * msg,
@@ -96,6 +104,64 @@ int Skein_256_Final(Skein_256_Ctxt_t * ctx, u08b_t * hashVal);
 int Skein_512_Final(Skein_512_Ctxt_t * ctx, u08b_t * hashVal);
 int Skein1024_Final(Skein1024_Ctxt_t * ctx, u08b_t * hashVal);
 
+/*
+**   Skein APIs for hashing a message in one call.
+**
+**   Same result as Init() + Update() + Final(). A message of at most one
+**   block goes straight into the final (padded) block, without Update(),
+**   and a longer one goes through Update(). This is an API helper: the
+**   block function calls are the same as Init() + Update() + Final(), and
+**   no measurable speedup over them is claimed.
+**/
+int Skein_256_Hash_Short(size_t hashBitLen, const u08b_t * msg,
+			 size_t msgByteCnt, u08b_t * hashVal);
+int Skein_512_Hash_Short(size_t hashBitLen, const u08b_t * msg,
+			 size_t msgByteCnt, u08b_t * hashVal);
+int Skein1024_Hash_Short(size_t hashBitLen, const u08b_t * msg,
+			 size_t msgByteCnt, u08b_t * hashVal);
+
+/*
+**   Skein API for hashing many independent messages at once.
+**
+**   Each ctx[i] must have been set up with Init()/InitExt() (and may
+**   already contain data from Update() calls); msg[i] is then appended
+**   and the result is written to hashVal[i], just like Update() + Final().
+**   The block function runs two or four of the messages interleaved,
+**   which is a lot faster than hashing them one after the other.
+**/
+int Skein_512_Hash_Many(Skein_512_Ctxt_t * ctx[], const u08b_t * msg[],
+			const size_t msgByteCnt[], u08b_t * hashVal[],
+			size_t cnt);
+
+/*
+**   Skein API for reading the output incrementally.
+**
+**   XOF_Start() takes a context after Init()/InitExt() and Update() (the
+**   context itself is not changed), and XOF_Read() then returns the output
+**   in pieces of any size. Its bytes are the same as the ones Final()
+**   would produce, so the total output is (hashBitLen+7)/8 bytes; choose
+**   a large hashBitLen for keystream use. XOF_Seek() moves to any byte
+**   offset of the output, only the blocks that are read are computed.
+**/
+typedef struct {
+	Skein_512_Ctxt_t ctx;	/* X: the counter mode "key" */
+	u64b_t outBytes;	/* total number of output bytes */
+	u64b_t offset;		/* next output byte to read */
+	u64b_t bufBlk;		/* output block number in buf[] */
+	u08b_t buf[SKEIN_512_BLOCK_BYTES];
+} Skein_512_XOF_t;
+
+int Skein_512_XOF_Start(Skein_512_XOF_t * xof, const Skein_512_Ctxt_t * ctx);
+size_t Skein_512_XOF_Read(Skein_512_XOF_t * xof, u08b_t * out, size_t n);
+int Skein_512_XOF_Seek(Skein_512_XOF_t * xof, u64b_t offset);
+
+/* byteCnt bytes of the output stage with ctx->X as the key, starting at
+   output block ctr (the building block of Final() and XOF_Read()), up to
+   four blocks per multi-lane kernel call. There are only Skein-512
+   multi-lane kernels, the 256 and 1024 bit output runs one block at a time */
+void Skein_512_Output_Blocks(const Skein_512_Ctxt_t * ctx, u64b_t ctr,
+			     u08b_t * out, size_t byteCnt);
+
 /*
 **   Skein APIs for "extended" initialization: MAC keys, tree hashing.
 **   After an InitExt() call, just use Update/Final calls as with Init().
@@ -117,6 +183,44 @@ int Skein_512_InitExt(Skein_512_Ctxt_t * ctx, size_t hashBitLen,
 int Skein1024_InitExt(Skein1024_Ctxt_t * ctx, size_t hashBitLen,
 		      u64b_t treeInfo, const u08b_t * key, size_t keyBytes);
 
+/*
+**   Skein APIs for initialization with all the optional arguments of the
+**   spec: key, personalization string, public key and nonce, each one a
+**   UBI call after the config block (in that order). A NULL/0 argument is
+**   left out, so with only a key and treeInfo InitArgs() is InitExt().
+**
+**   Notes: The argument blocks cost at least one block function call each,
+**          for fixed arguments call InitArgs() once and keep a copy of the
+**          context (the context is a plain struct, assignment copies it).
+**          Nonce() adds a per-message nonce to such a copy, giving the same
+**          result as InitArgs() with all arguments.
+**/
+typedef struct {
+	u64b_t treeInfo;	/* SKEIN_CFG_TREE_INFO_SEQUENTIAL, or a tree */
+	const u08b_t *key;	/* MAC key */
+	size_t keyBytes;
+	const u08b_t *pers;	/* personalization string */
+	size_t persBytes;
+	const u08b_t *pk;	/* public key, for signature hashing */
+	size_t pkBytes;
+	const u08b_t *nonce;
+	size_t nonceBytes;
+} Skein_Args_t;
+
+int Skein_256_InitArgs(Skein_256_Ctxt_t * ctx, size_t hashBitLen,
+		       const Skein_Args_t * args);
+int Skein_512_InitArgs(Skein_512_Ctxt_t * ctx, size_t hashBitLen,
+		       const Skein_Args_t * args);
+int Skein1024_InitArgs(Skein1024_Ctxt_t * ctx, size_t hashBitLen,
+		       const Skein_Args_t * args);
+
+int Skein_256_Nonce(Skein_256_Ctxt_t * ctx, const u08b_t * nonce,
+		    size_t nonceBytes);
+int Skein_512_Nonce(Skein_512_Ctxt_t * ctx, const u08b_t * nonce,
+		    size_t nonceBytes);
+int Skein1024_Nonce(Skein1024_Ctxt_t * ctx, const u08b_t * nonce,
+		    size_t nonceBytes);
+
 /*
 **   Skein APIs for MAC and tree hash:
 **      Final_Pad:  pad, do final block, but no OUTPUT type
@@ -203,9 +307,9 @@ int Skein1024_Output(Skein1024_Ctxt_t * ctx, u08b_t * hashVal);
 #define SKEIN_CFG_TREE_NODE_SIZE_POS  ( 8)
 #define SKEIN_CFG_TREE_MAX_LEVEL_POS  (16)
 
-#define SKEIN_CFG_TREE_LEAF_SIZE_MSK  ((u64b_t) 0xFF) << SKEIN_CFG_TREE_LEAF_SIZE_POS)
-#define SKEIN_CFG_TREE_NODE_SIZE_MSK  ((u64b_t) 0xFF) << SKEIN_CFG_TREE_NODE_SIZE_POS)
-#define SKEIN_CFG_TREE_MAX_LEVEL_MSK  ((u64b_t) 0xFF) << SKEIN_CFG_TREE_MAX_LEVEL_POS)
+#define SKEIN_CFG_TREE_LEAF_SIZE_MSK  (((u64b_t) 0xFF) << SKEIN_CFG_TREE_LEAF_SIZE_POS)
+#define SKEIN_CFG_TREE_NODE_SIZE_MSK  (((u64b_t) 0xFF) << SKEIN_CFG_TREE_NODE_SIZE_POS)
+#define SKEIN_CFG_TREE_MAX_LEVEL_MSK  (((u64b_t) 0xFF) << SKEIN_CFG_TREE_MAX_LEVEL_POS)
 
 #define SKEIN_CFG_TREE_INFO_SEQUENTIAL (0)	/* use as treeInfo in InitExt() call for sequential processing */
 #define SKEIN_CFG_TREE_INFO(leaf,node,maxLevel) ((u64b_t) ((leaf) | ((node) << 8) | ((maxLevel) << 16)))
@@ -0,0 +1,158 @@
+/***********************************************************************
+**
+** Implementation of the Skein context arena.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <stdlib.h>		/* get the posix_memalign/free functions */
+#include <string.h>		/* get the memcpy/memset functions */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_arena.h"
+
+/* SKEIN_ARENA_CHUNK context slots, in a list of all chunks */
+typedef struct Skein_Arena_Chunk {
+	struct Skein_Arena_Chunk *next;
+	u08b_t *slots;
+} Skein_Arena_Chunk_t;
+
+/* a returned context, until it is handed out again */
+typedef struct Skein_Arena_Slot {
+	struct Skein_Arena_Slot *next;
+} Skein_Arena_Slot_t;
+
+struct Skein_Arena {
+	size_t ctxBytes;	/* sizeof the context type */
+	size_t slotBytes;	/* ... rounded to SKEIN_ARENA_LINE */
+	Skein_Arena_Chunk_t *chunks;	/* the oldest one first */
+	Skein_Arena_Chunk_t *cur;	/* chunk that slots are taken from (NULL: none yet) */
+	size_t used;		/* slots taken from cur */
+	Skein_Arena_Slot_t *free;	/* slots given back with Free() */
+	union {
+		Skein_256_Ctxt_t ctx_256;
+		Skein_512_Ctxt_t ctx_512;
+		Skein1024_Ctxt_t ctx1024;
+	} tmpl;
+};
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* an empty arena, the first chunk is allocated by the first Alloc() */
+Skein_Arena_t *Skein_Arena_Create(uint_t stateBits, const void *tmpl)
+{
+	Skein_Arena_t *arena;
+	size_t ctxBytes;
+
+	switch (stateBits) {
+	case 256:
+		ctxBytes = sizeof(Skein_256_Ctxt_t);
+		break;
+	case 512:
+		ctxBytes = sizeof(Skein_512_Ctxt_t);
+		break;
+	case 1024:
+		ctxBytes = sizeof(Skein1024_Ctxt_t);
+		break;
+	default:
+		return NULL;
+	}
+
+	arena = calloc(1, sizeof(*arena));
+	if (arena == NULL)
+		return NULL;
+	arena->ctxBytes = ctxBytes;
+	arena->slotBytes = (ctxBytes + SKEIN_ARENA_LINE - 1) & ~(size_t) (SKEIN_ARENA_LINE - 1);
+	memcpy(&arena->tmpl, tmpl, ctxBytes);
+	return arena;
+}
+
+/* a new chunk at the end of the list */
+static Skein_Arena_Chunk_t *Skein_Arena_Chunk(Skein_Arena_t * arena,
+					      Skein_Arena_Chunk_t * last)
+{
+	Skein_Arena_Chunk_t *c = malloc(sizeof(*c));
+
+	if (c == NULL)
+		return NULL;
+	if (posix_memalign((void **) &c->slots, SKEIN_ARENA_LINE,
+			   SKEIN_ARENA_CHUNK * arena->slotBytes)) {
+		free(c);
+		return NULL;
+	}
+	c->next = NULL;
+	if (last != NULL)
+		last->next = c;
+	else
+		arena->chunks = c;
+	return c;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* a returned slot, the next one of the current chunk, or a new chunk */
+void *Skein_Arena_Alloc(Skein_Arena_t * arena)
+{
+	Skein_Arena_Chunk_t *c;
+	void *ctx;
+
+	if (arena->free != NULL) {
+		ctx = arena->free;
+		arena->free = arena->free->next;
+	} else {
+		if (arena->cur == NULL || arena->used == SKEIN_ARENA_CHUNK) {
+			/* the chunks after cur are left over from before Free_All() */
+			c = (arena->cur != NULL) ? arena->cur->next : arena->chunks;
+			if (c == NULL)
+				c = Skein_Arena_Chunk(arena, arena->cur);
+			if (c == NULL)
+				return NULL;
+			arena->cur = c;
+			arena->used = 0;
+		}
+		ctx = arena->cur->slots + arena->used++ * arena->slotBytes;
+	}
+
+	memcpy(ctx, &arena->tmpl, arena->ctxBytes);
+	return ctx;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* copy the template into a context */
+void Skein_Arena_Reset(const Skein_Arena_t * arena, void *ctx)
+{
+	memcpy(ctx, &arena->tmpl, arena->ctxBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* put a context on the free list */
+void Skein_Arena_Free(Skein_Arena_t * arena, void *ctx)
+{
+	Skein_Arena_Slot_t *slot = ctx;
+
+	slot->next = arena->free;
+	arena->free = slot;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* start over at the first chunk */
+void Skein_Arena_Free_All(Skein_Arena_t * arena)
+{
+	arena->cur = NULL;
+	arena->used = 0;
+	arena->free = NULL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* free all chunks */
+void Skein_Arena_Destroy(Skein_Arena_t * arena)
+{
+	Skein_Arena_Chunk_t *c, *next;
+
+	if (arena == NULL)
+		return;
+	for (c = arena->chunks; c != NULL; c = next) {
+		next = c->next;
+		free(c->slots);
+		free(c);
+	}
+	free(arena);
+}
@@ -0,0 +1,56 @@
+#ifndef _SKEIN_ARENA_H_
+#define _SKEIN_ARENA_H_
+/***********************************************************************
+**
+** Interface declarations for the Skein context arena.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** An arena hands out contexts of one state size, SKEIN_ARENA_LINE
+** aligned and SKEIN_ARENA_LINE rounded (a Skein-256 context takes 128
+** bytes, not the size of a hashState). They are carved out of large
+** chunks, so there is no malloc() per context.
+**
+** Every context starts as a copy of the template given to Create(): the
+** context after Init(), InitExt(), InitArgs() or MAC_Prepare(), so the
+** IV, key and config blocks are computed once for all of them. Reset()
+** copies the template again, Free_All() returns all contexts at once.
+**
+** The pointers are Skein_256_Ctxt_t, Skein_512_Ctxt_t or Skein1024_Ctxt_t
+** pointers (for the stateBits of the arena) and work with all the
+** functions in skein.h. An arena does no locking, use one per thread.
+**
+***********************************************************************/
+
+#include "skein.h"
+
+#ifndef SKEIN_ARENA_LINE
+#if defined(__powerpc64__)
+#define SKEIN_ARENA_LINE (128)	/* the POWER cache line */
+#else
+#define SKEIN_ARENA_LINE (64)
+#endif
+#endif
+
+#ifndef SKEIN_ARENA_CHUNK
+#define SKEIN_ARENA_CHUNK (1024)	/* contexts per allocation */
+#endif
+
+typedef struct Skein_Arena Skein_Arena_t;
+
+/* an arena of stateBits contexts, copies of tmpl; NULL on failure */
+Skein_Arena_t *Skein_Arena_Create(uint_t stateBits, const void *tmpl);
+/* a new context, set to the template; NULL if out of memory */
+void *Skein_Arena_Alloc(Skein_Arena_t * arena);
+/* set a context back to the template */
+void Skein_Arena_Reset(const Skein_Arena_t * arena, void *ctx);
+/* return one context */
+void Skein_Arena_Free(Skein_Arena_t * arena, void *ctx);
+/* return all contexts, the memory is kept for the next Alloc() calls */
+void Skein_Arena_Free_All(Skein_Arena_t * arena);
+/* free the arena and all its contexts */
+void Skein_Arena_Destroy(Skein_Arena_t * arena);
+
+#endif				/* ifndef _SKEIN_ARENA_H_ */
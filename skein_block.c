@@ -74,10 +74,48 @@
 
 #include <string.h>
 #include "skein.h"
+#include "skein_kernel.h"
 
 
 #include <altivec.h>
 
+#if defined(SKEIN_CODE_SIZE) || defined(SKEIN_PERF)
+/* the unaligned variant in a section of its own, the linker defines
+ * __start_ and __stop_ symbols at its bounds (the order of the functions
+ * in .text does not matter then) */
+#define Skein_Code_Section(n)	__attribute__((section("skein_code_" #n)))
+#define Skein_Code_Size(n)	((size_t) (__stop_skein_code_##n - __start_skein_code_##n))
+extern const u08b_t __start_skein_code_256[], __stop_skein_code_256[];
+extern const u08b_t __start_skein_code_512[], __stop_skein_code_512[];
+extern const u08b_t __start_skein_code_1024[], __stop_skein_code_1024[];
+#else
+#define Skein_Code_Section(n)
+#endif
+
+/* prefetch strategy, read once per call (see Skein_Prefetch) */
+#define Skein_Prefetch_vars(blkBytes)					\
+	const int pf_mode = Skein_Prefetch.mode;			\
+	const size_t pf_ahead = Skein_Prefetch.distance * (blkBytes);	\
+	/* a block (one more vector if unaligned), count, stride */	\
+	const unsigned int dst_control_word =				\
+	    (((blkBytes) / 16 + 1) << 24) | ((Skein_Prefetch.count & 0xff) << 16) | \
+	    ((Skein_Prefetch.stride ? Skein_Prefetch.stride : (blkBytes)) & 0xffff);
+
+/* prefetch from the block at ptr on, dst uses the given stream */
+#define Skein_Prefetch_Block(ptr, blkBytes, stream)			\
+	do {								\
+		if (pf_mode == SKEIN_PREFETCH_DST)			\
+			vec_dst(ptr, dst_control_word, stream);		\
+		else if (pf_mode == SKEIN_PREFETCH_DCBT)		\
+			Skein_Prefetch_Touch((ptr) + pf_ahead, blkBytes);	\
+	} while (0)
+
+#define Skein_Prefetch_Stop(stream)					\
+	do {								\
+		if (pf_mode == SKEIN_PREFETCH_DST)			\
+			vec_dss(stream);				\
+	} while (0)
+
 /* 64bit Altivec calculation macros */
 #define add64_vectors	vector unsigned char carry_mov = {0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 15, 0, 0, 0, 0};
 /* 64bit add in 4 instructions, should need 3 cycles by itself, but could be
@@ -181,12 +219,19 @@
 	X1 = vec_add64(X1, tmp_vec1);
 
 #define Skein_Get64_256_altivec(addr)				\
-	tmp_vec0 = vec_ld(0, (unsigned int*) (addr));		\
-	w0 = vec_ld(0x10, (unsigned int*) (addr));		\
-	w1 = vec_ld(0x1f, (unsigned int*) (addr));		\
+	if (aligned) {	/* one load and one permute per vector */ \
+		w0 = vec_ld(0x00, (unsigned int*) (addr));	\
+		w1 = vec_ld(0x10, (unsigned int*) (addr));	\
+		w0 = vec_perm(w0, w0, load_vec);		\
+		w1 = vec_perm(w1, w1, load_vec);		\
+	} else {						\
+		tmp_vec0 = vec_ld(0, (unsigned int*) (addr));	\
+		w0 = vec_ld(0x10, (unsigned int*) (addr));	\
+		w1 = vec_ld(0x1f, (unsigned int*) (addr));	\
 								\
-	w1 = vec_perm(w0, w1, load_vec);			\
-	w0 = vec_perm(tmp_vec0, w0, load_vec);		\
+		w1 = vec_perm(w0, w1, load_vec);		\
+		w0 = vec_perm(tmp_vec0, w0, load_vec);		\
+	}							\
 								\
 	/* ALTIVEC ORDER */					\
 	tmp_vec0 = w0;						\
@@ -196,17 +241,17 @@
 #define rotl64_vectors rotl64b_vectors
 #define vec_rotl64 vec_rotl64b
 
-void Skein_256_Process_Block(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
-			     size_t blkCnt, size_t byteCntAdd)
+/* aligned is a constant, so this is specialized for both callers below */
+static inline __attribute__((always_inline))
+void Skein_256_Process_Block_body(Skein_256_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd, const int aligned)
 {	/* do it in C with altivec! */
 	size_t r;
 	u64b_t ks[6] __attribute__((aligned(16)));
 	u64b_t ts[3] __attribute__((aligned(16)));
 	u64b_t KeyInject_add[4] __attribute__((aligned(16)));
 
-	/* The Xi is only used for storing the data. */
-	u64b_t Xi[4] __attribute__((aligned(16)));
-
 	vector unsigned int X0, X1;
 	vector unsigned int w0, w1;
 
@@ -218,37 +263,32 @@ void Skein_256_Process_Block(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
 	vector unsigned char perm_swap_u64 = {8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7};
 	/* The byte offset of the input data will be added to this (using vec_lvsl).
 	 * It is then possible to load the input data, and swap its endianness at
-	 * the same time. */
+	 * the same time. For aligned input it is just the byte swap. */
 	vector char load_vec = {7, 5, 3, 1, -1, -3, -5, -7, 7, 5, 3, 1, -1, -3, -5, -7,};
 
 	vector unsigned int tmp_vec0, tmp_vec1;
-	unsigned int dst_control_word = 0x03020020; /* Preload two blocks of 32 bytes each. */
+	Skein_Prefetch_vars(SKEIN_256_BLOCK_BYTES)
 
 	tmp_vec0 = (vector unsigned int) vec_lvsl(0, blkPtr);
 	load_vec = vec_add((vector char) tmp_vec0, load_vec);
 
 	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
 
-	Xi[0] = ctx->X[0];
-	Xi[1] = ctx->X[1];
-	Xi[2] = ctx->X[2];
-	Xi[3] = ctx->X[3];
-
-	X0 = vec_ld(0x00, (unsigned int*) Xi);
-	X1 = vec_ld(0x10, (unsigned int*) Xi);
-
-	/* ALTIVEC ORDER */
-	tmp_vec0 = X0;
-	X0 = vec_perm(X0, X1, perm_load_upper);
-	X1 = vec_perm(tmp_vec0, X1, perm_load_lower);
-
+	/* ctx->X is in the spec's order: ALTIVEC ORDER for the rounds */
+	tmp_vec0 = vec_ld(0x00, (unsigned int*) ctx->X);
+	tmp_vec1 = vec_ld(0x10, (unsigned int*) ctx->X);
+	X0 = vec_perm(tmp_vec0, tmp_vec1, perm_load_upper);
+	X1 = vec_perm(tmp_vec0, tmp_vec1, perm_load_lower);
 
 	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
 	do {
-		vec_dst(blkPtr, dst_control_word, 0);
+		Skein_Prefetch_Block(blkPtr, SKEIN_256_BLOCK_BYTES, 0);
 
 		/* this implementation only supports 2**64 input bytes (no carry out here) */
-		ctx->h.T[0] += byteCntAdd;	/* update processed length */
+		ts[0] += byteCntAdd;	/* update processed length */
 
 		/* Store ks in normal order. */
 		tmp_vec0 = vec_perm(X0, X1, perm_load_upper);
@@ -263,8 +303,6 @@ void Skein_256_Process_Block(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
 		ks[4] ^= ks[5];
 		ks[4] ^= SKEIN_KS_PARITY;
 
-		ts[0] = ctx->h.T[0];
-		ts[1] = ctx->h.T[1];
 		ts[2] = ts[0] ^ ts[1];
 		Skein_Get64_256_altivec(blkPtr); /* load input block into w registers */
 
@@ -336,24 +374,36 @@ void Skein_256_Process_Block(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
 		X0 = vec_xor(X0, w0);
 		X1 = vec_xor(X1, w1);
 
-		Skein_Clear_First_Flag(ctx->h);	/* clear the start bit */
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
 		blkPtr += SKEIN_256_BLOCK_BYTES;
 	} while (--blkCnt);
 
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
 	/* UNDO ALTIVEC ORDER */
-	tmp_vec0 = X0;
-	X0 = vec_perm(X0, X1, perm_load_upper);
-	X1 = vec_perm(tmp_vec0, X1, perm_load_lower);
+	tmp_vec0 = vec_perm(X0, X1, perm_load_upper);
+	tmp_vec1 = vec_perm(X0, X1, perm_load_lower);
+	vec_st(tmp_vec0, 0x00, (unsigned int*) ctx->X);
+	vec_st(tmp_vec1, 0x10, (unsigned int*) ctx->X);
 
-	vec_st(X0, 0x00, (unsigned int*) Xi);
-	vec_st(X1, 0x10, (unsigned int*) Xi);
+	Skein_Prefetch_Stop(0);
+}
 
-	vec_dss(0);
+Skein_Code_Section(256)
+void Skein_256_Process_Block_altivec(Skein_256_Ctxt_t * ctx,
+				     const u08b_t * blkPtr, size_t blkCnt,
+				     size_t byteCntAdd)
+{
+	Skein_256_Process_Block_body(ctx, blkPtr, blkCnt, byteCntAdd, 0);
+}
 
-	ctx->X[0] = Xi[0];
-	ctx->X[1] = Xi[1];
-	ctx->X[2] = Xi[2];
-	ctx->X[3] = Xi[3];
+/* blkPtr must be 16-byte aligned */
+void Skein_256_Process_Block_aligned_altivec(Skein_256_Ctxt_t * ctx,
+					     const u08b_t * blkPtr, size_t blkCnt,
+					     size_t byteCntAdd)
+{
+	Skein_256_Process_Block_body(ctx, blkPtr, blkCnt, byteCntAdd, 1);
 }
 
 #undef rotl64_vectors
@@ -365,8 +415,7 @@ void Skein_256_Process_Block(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
 #if defined(SKEIN_CODE_SIZE) || defined(SKEIN_PERF)
 size_t Skein_256_Process_Block_CodeSize(void)
 {
-	return ((u08b_t *) Skein_256_Process_Block_CodeSize) -
-	    ((u08b_t *) Skein_256_Process_Block);
+	return Skein_Code_Size(256);
 }
 
 uint_t Skein_256_Unroll_Cnt(void)
@@ -395,16 +444,27 @@ uint_t Skein_256_Unroll_Cnt(void)
 	X3 = vec_add64(X3, tmp_vec3);					\
 
 #define Skein_Get64_512_altivec(addr)				\
-	tmp_vec0 = vec_ld(0, (unsigned int*) (addr));		\
-	w0 = vec_ld(0x10, (unsigned int*) (addr));		\
-	w1 = vec_ld(0x20, (unsigned int*) (addr));		\
-	w2 = vec_ld(0x30, (unsigned int*) (addr));		\
-	w3 = vec_ld(0x3f, (unsigned int*) (addr));		\
+	if (aligned) {	/* one load and one permute per vector */ \
+		w0 = vec_ld(0x00, (unsigned int*) (addr));	\
+		w1 = vec_ld(0x10, (unsigned int*) (addr));	\
+		w2 = vec_ld(0x20, (unsigned int*) (addr));	\
+		w3 = vec_ld(0x30, (unsigned int*) (addr));	\
+		w0 = vec_perm(w0, w0, load_vec);		\
+		w1 = vec_perm(w1, w1, load_vec);		\
+		w2 = vec_perm(w2, w2, load_vec);		\
+		w3 = vec_perm(w3, w3, load_vec);		\
+	} else {						\
+		tmp_vec0 = vec_ld(0, (unsigned int*) (addr));	\
+		w0 = vec_ld(0x10, (unsigned int*) (addr));	\
+		w1 = vec_ld(0x20, (unsigned int*) (addr));	\
+		w2 = vec_ld(0x30, (unsigned int*) (addr));	\
+		w3 = vec_ld(0x3f, (unsigned int*) (addr));	\
 								\
-	w3 = vec_perm(w2, w3, load_vec);			\
-	w2 = vec_perm(w1, w2, load_vec);			\
-	w1 = vec_perm(w0, w1, load_vec);			\
-	w0 = vec_perm(tmp_vec0, w0, load_vec);		\
+		w3 = vec_perm(w2, w3, load_vec);		\
+		w2 = vec_perm(w1, w2, load_vec);		\
+		w1 = vec_perm(w0, w1, load_vec);		\
+		w0 = vec_perm(tmp_vec0, w0, load_vec);		\
+	}							\
 								\
 	/* ALTIVEC ORDER */					\
 	tmp_vec0 = w0;						\
@@ -418,17 +478,17 @@ uint_t Skein_256_Unroll_Cnt(void)
 #define rotl64_vectors rotl64b_vectors
 #define vec_rotl64 vec_rotl64b
 
-void Skein_512_Process_Block(Skein_512_Ctxt_t * ctx, const u08b_t * blkPtr,
-			     size_t blkCnt, size_t byteCntAdd)
+/* aligned is a constant, so this is specialized for both callers below */
+static inline __attribute__((always_inline))
+void Skein_512_Process_Block_body(Skein_512_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd, const int aligned)
 {	/* do it in C with altivec! */
 	size_t r;
 	u64b_t ks[10] __attribute__((aligned(16)));
 	u64b_t ts[3] __attribute__((aligned(16)));
 	u64b_t KeyInject_add[8] __attribute__((aligned(16)));
 
-	/* The Xi is only used for storing the data. */
-	u64b_t Xi[8] __attribute__((aligned(16)));
-
 	vector unsigned int X0, X1, X2, X3;
 	vector unsigned int w0, w1, w2, w3;
 
@@ -440,45 +500,35 @@ void Skein_512_Process_Block(Skein_512_Ctxt_t * ctx, const u08b_t * blkPtr,
 	vector unsigned char perm_swap_u64 = {8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7};
 	/* The byte offset of the input data will be added to this (using vec_lvsl).
 	 * It is then possible to load the input data, and swap its endianness at
-	 * the same time. */
+	 * the same time. For aligned input it is just the byte swap. */
 	vector char load_vec = {7, 5, 3, 1, -1, -3, -5, -7, 7, 5, 3, 1, -1, -3, -5, -7,};
 
 	vector unsigned int tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;
-	unsigned int dst_control_word = 0x05020040; /* Preload two blocks of 64 bytes each. */
+	Skein_Prefetch_vars(SKEIN_512_BLOCK_BYTES)
 
 	tmp_vec0 = (vector unsigned int) vec_lvsl(0, blkPtr);
 	load_vec = vec_add((vector char) tmp_vec0, load_vec);
 
 	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
 
-	Xi[0] = ctx->X[0];
-	Xi[1] = ctx->X[1];
-	Xi[2] = ctx->X[2];
-	Xi[3] = ctx->X[3];
-	Xi[4] = ctx->X[4];
-	Xi[5] = ctx->X[5];
-	Xi[6] = ctx->X[6];
-	Xi[7] = ctx->X[7];
-
-	X0 = vec_ld(0x00, (unsigned int*) Xi);
-	X1 = vec_ld(0x10, (unsigned int*) Xi);
-	X2 = vec_ld(0x20, (unsigned int*) Xi);
-	X3 = vec_ld(0x30, (unsigned int*) Xi);
-
-	/* ALTIVEC ORDER */
-	tmp_vec0 = X0;
-	X0 = vec_perm(X0, X1, perm_load_upper);
-	tmp_vec1 = X1;
-	X1 = vec_perm(X2, X3, perm_load_upper);
-	tmp_vec2 = X2;
+	/* ctx->X is in the spec's order: ALTIVEC ORDER for the rounds */
+	tmp_vec0 = vec_ld(0x00, (unsigned int*) ctx->X);
+	tmp_vec1 = vec_ld(0x10, (unsigned int*) ctx->X);
+	tmp_vec2 = vec_ld(0x20, (unsigned int*) ctx->X);
+	tmp_vec3 = vec_ld(0x30, (unsigned int*) ctx->X);
+	X0 = vec_perm(tmp_vec0, tmp_vec1, perm_load_upper);
 	X2 = vec_perm(tmp_vec0, tmp_vec1, perm_load_lower);
-	X3 = vec_perm(tmp_vec2, X3, perm_load_lower);
+	X1 = vec_perm(tmp_vec2, tmp_vec3, perm_load_upper);
+	X3 = vec_perm(tmp_vec2, tmp_vec3, perm_load_lower);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
 
 	do {
-		vec_dst(blkPtr, dst_control_word, 0);
+		Skein_Prefetch_Block(blkPtr, SKEIN_512_BLOCK_BYTES, 0);
 
 		/* this implementation only supports 2**64 input bytes (no carry out here) */
-		ctx->h.T[0] += byteCntAdd;	/* update processed length */
+		ts[0] += byteCntAdd;	/* update processed length */
 
 		/* Store ks in normal order. */
 		tmp_vec0 = vec_perm(X0, X2, perm_load_upper);
@@ -499,8 +549,6 @@ void Skein_512_Process_Block(Skein_512_Ctxt_t * ctx, const u08b_t * blkPtr,
 		ks[8] ^= ks[9];
 		ks[8] ^= SKEIN_KS_PARITY;
 
-		ts[0] = ctx->h.T[0];
-		ts[1] = ctx->h.T[1];
 		ts[2] = ts[0] ^ ts[1];
 		Skein_Get64_512_altivec(blkPtr); /* load input block into w[] registers */
 
@@ -613,46 +661,52 @@ void Skein_512_Process_Block(Skein_512_Ctxt_t * ctx, const u08b_t * blkPtr,
 		X2 = vec_xor(X2, w2);
 		X3 = vec_xor(X3, w3);
 
-		Skein_Clear_First_Flag(ctx->h);	/* clear the start bit */
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
 		blkPtr += SKEIN_512_BLOCK_BYTES;
 	} while (--blkCnt);
 
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
 	/* UNDO ALTIVEC ORDER */
-	tmp_vec0 = X0;
-	X0 = vec_perm(X0, X2, perm_load_upper);
-	tmp_vec1 = X1;
-	X1 = vec_perm(tmp_vec0, X2, perm_load_lower);
-	X2 = vec_perm(tmp_vec1, X3, perm_load_upper);
-	X3 = vec_perm(tmp_vec1, X3, perm_load_lower);
-
-	vec_st(X0, 0x00, (unsigned int*) Xi);
-	vec_st(X1, 0x10, (unsigned int*) Xi);
-	vec_st(X2, 0x20, (unsigned int*) Xi);
-	vec_st(X3, 0x30, (unsigned int*) Xi);
-
-	vec_dss(0);
-
-	ctx->X[0] = Xi[0];
-	ctx->X[1] = Xi[1];
-	ctx->X[2] = Xi[2];
-	ctx->X[3] = Xi[3];
-	ctx->X[4] = Xi[4];
-	ctx->X[5] = Xi[5];
-	ctx->X[6] = Xi[6];
-	ctx->X[7] = Xi[7];
+	tmp_vec0 = vec_perm(X0, X2, perm_load_upper);
+	tmp_vec1 = vec_perm(X0, X2, perm_load_lower);
+	tmp_vec2 = vec_perm(X1, X3, perm_load_upper);
+	tmp_vec3 = vec_perm(X1, X3, perm_load_lower);
+	vec_st(tmp_vec0, 0x00, (unsigned int*) ctx->X);
+	vec_st(tmp_vec1, 0x10, (unsigned int*) ctx->X);
+	vec_st(tmp_vec2, 0x20, (unsigned int*) ctx->X);
+	vec_st(tmp_vec3, 0x30, (unsigned int*) ctx->X);
+
+	Skein_Prefetch_Stop(0);
+}
+
+Skein_Code_Section(512)
+void Skein_512_Process_Block_altivec(Skein_512_Ctxt_t * ctx,
+				     const u08b_t * blkPtr, size_t blkCnt,
+				     size_t byteCntAdd)
+{
+	Skein_512_Process_Block_body(ctx, blkPtr, blkCnt, byteCntAdd, 0);
+}
+
+/* blkPtr must be 16-byte aligned */
+void Skein_512_Process_Block_aligned_altivec(Skein_512_Ctxt_t * ctx,
+					     const u08b_t * blkPtr, size_t blkCnt,
+					     size_t byteCntAdd)
+{
+	Skein_512_Process_Block_body(ctx, blkPtr, blkCnt, byteCntAdd, 1);
 }
 
 #undef rotl64_vectors
 #undef vec_rotl64
 
 #undef InjectKey_512_altivec
-#undef Skein_Get64_512_Altivec
+#undef Skein_Get64_512_altivec
 
 #if defined(SKEIN_CODE_SIZE) || defined(SKEIN_PERF)
 size_t Skein_512_Process_Block_CodeSize(void)
 {
-	return ((u08b_t *) Skein_512_Process_Block_CodeSize) -
-	    ((u08b_t *) Skein_512_Process_Block);
+	return Skein_Code_Size(512);
 }
 
 uint_t Skein_512_Unroll_Cnt(void)
@@ -661,32 +715,310 @@ uint_t Skein_512_Unroll_Cnt(void)
 }
 #endif
 
-#define InjectKey_1024_altivec(r)					\
-	KeyInject_add[ 0] = ks[((r)+ 0) % (16+1)];			\
-	KeyInject_add[ 8] = ks[((r)+ 1) % (16+1)];			\
-	KeyInject_add[ 1] = ks[((r)+ 2) % (16+1)];			\
-	KeyInject_add[ 9] = ks[((r)+ 3) % (16+1)];			\
-	KeyInject_add[ 2] = ks[((r)+ 4) % (16+1)];			\
-	KeyInject_add[10] = ks[((r)+ 5) % (16+1)];			\
-	KeyInject_add[ 3] = ks[((r)+ 6) % (16+1)];			\
-	KeyInject_add[11] = ks[((r)+ 7) % (16+1)];			\
-	KeyInject_add[ 4] = ks[((r)+ 8) % (16+1)];			\
-	KeyInject_add[12] = ks[((r)+ 9) % (16+1)];			\
-	KeyInject_add[ 5] = ks[((r)+10) % (16+1)];			\
-	KeyInject_add[13] = ks[((r)+11) % (16+1)];			\
-	KeyInject_add[ 6] = ks[((r)+12) % (16+1)];			\
-	KeyInject_add[14] = ks[((r)+13) % (16+1)] + ts[((r)+0) % 3];	\
-	KeyInject_add[ 7] = ks[((r)+14) % (16+1)] + ts[((r)+1) % 3];	\
-	KeyInject_add[15] = ks[((r)+15) % (16+1)] + (r);		\
+/* Multi-buffer Skein-512
+ *
+ * Processing a single block is one long dependency chain: every vec_add64
+ * has to wait for the vec_rotl64 before it, and most of the time the vector
+ * units are idle. If there are several independent messages, their rounds
+ * can be run interleaved, so that the latency of one chain is hidden by the
+ * calculations of the other ones.
+ *
+ * The code is the same as in Skein_512_Process_Block, but every macro works
+ * on one "lane" l (all variables carry the lane number as a suffix). The
+ * FOR_LANES macros expand them once for every lane, and the compiler is then
+ * free to schedule the independent instructions. With four lanes there are
+ * not enough registers for all the w vectors, but those are only needed for
+ * the final feedforward, so spilling them is cheap.
+ */
+
+#define Skein_512_lane_vectors(l)					\
+	vector unsigned int X0_##l, X1_##l, X2_##l, X3_##l;		\
+	vector unsigned int w0_##l, w1_##l, w2_##l, w3_##l;		\
+	vector char load_vec_##l;					\
+	const u08b_t *blk_##l = blkPtr[l];				\
+	u64b_t ks_##l[10] __attribute__((aligned(16)));			\
+	u64b_t ts_##l[3] __attribute__((aligned(16)));			\
+	u64b_t KeyInject_add_##l[8] __attribute__((aligned(16)));
+
+#define Skein_512_lane_load(l)						\
+	tmp_vec0 = (vector unsigned int) vec_lvsl(0, blk_##l);		\
+	load_vec_##l = vec_add((vector char) tmp_vec0, load_vec);	\
 									\
-	tmp_vec0 = vec_ld(0x00, (unsigned int*) KeyInject_add);		\
-	tmp_vec1 = vec_ld(0x10, (unsigned int*) KeyInject_add);		\
-	tmp_vec2 = vec_ld(0x20, (unsigned int*) KeyInject_add);		\
-	tmp_vec3 = vec_ld(0x30, (unsigned int*) KeyInject_add);		\
-	tmp_vec4 = vec_ld(0x40, (unsigned int*) KeyInject_add);		\
-	tmp_vec5 = vec_ld(0x50, (unsigned int*) KeyInject_add);		\
-	tmp_vec6 = vec_ld(0x60, (unsigned int*) KeyInject_add);		\
-	tmp_vec7 = vec_ld(0x70, (unsigned int*) KeyInject_add);		\
+	/* ctx->X is in the spec's order: ALTIVEC ORDER for the rounds */ \
+	tmp_vec0 = vec_ld(0x00, (unsigned int*) ctx[l]->X);		\
+	tmp_vec1 = vec_ld(0x10, (unsigned int*) ctx[l]->X);		\
+	tmp_vec2 = vec_ld(0x20, (unsigned int*) ctx[l]->X);		\
+	tmp_vec3 = vec_ld(0x30, (unsigned int*) ctx[l]->X);		\
+	X0_##l = vec_perm(tmp_vec0, tmp_vec1, perm_load_upper);		\
+	X2_##l = vec_perm(tmp_vec0, tmp_vec1, perm_load_lower);		\
+	X1_##l = vec_perm(tmp_vec2, tmp_vec3, perm_load_upper);		\
+	X3_##l = vec_perm(tmp_vec2, tmp_vec3, perm_load_lower);	\
+									\
+	ts_##l[0] = ctx[l]->h.T[0];	/* the tweak stays in ts for the whole loop */ \
+	ts_##l[1] = ctx[l]->h.T[1];
+
+/* key schedule, input block and first key injection of one lane */
+#define Skein_512_lane_start(l)						\
+	Skein_Prefetch_Block(blk_##l, SKEIN_512_BLOCK_BYTES, l);	\
+									\
+	/* this implementation only supports 2**64 input bytes (no carry out here) */ \
+	ts_##l[0] += byteCntAdd[l];	/* update processed length */	\
+									\
+	/* Store ks in normal order. */					\
+	tmp_vec0 = vec_perm(X0_##l, X2_##l, perm_load_upper);		\
+	tmp_vec1 = vec_perm(X0_##l, X2_##l, perm_load_lower);		\
+	tmp_vec2 = vec_perm(X1_##l, X3_##l, perm_load_upper);		\
+	tmp_vec3 = vec_perm(X1_##l, X3_##l, perm_load_lower);		\
+									\
+	vec_st(tmp_vec0, 0x00, (unsigned int*) ks_##l);			\
+	vec_st(tmp_vec1, 0x10, (unsigned int*) ks_##l);			\
+	vec_st(tmp_vec2, 0x20, (unsigned int*) ks_##l);			\
+	vec_st(tmp_vec3, 0x30, (unsigned int*) ks_##l);			\
+									\
+	tmp_vec0 = vec_xor(tmp_vec0, tmp_vec1);				\
+	tmp_vec0 = vec_xor(tmp_vec0, tmp_vec2);				\
+	tmp_vec0 = vec_xor(tmp_vec0, tmp_vec3);				\
+	vec_st(tmp_vec0, 0x40, (unsigned int*) ks_##l);			\
+									\
+	ks_##l[8] ^= ks_##l[9];						\
+	ks_##l[8] ^= SKEIN_KS_PARITY;					\
+									\
+	ts_##l[2] = ts_##l[0] ^ ts_##l[1];				\
+									\
+	/* load input block into w registers */				\
+	tmp_vec0 = vec_ld(0, (unsigned int*) blk_##l);			\
+	w0_##l = vec_ld(0x10, (unsigned int*) blk_##l);		\
+	w1_##l = vec_ld(0x20, (unsigned int*) blk_##l);		\
+	w2_##l = vec_ld(0x30, (unsigned int*) blk_##l);		\
+	w3_##l = vec_ld(0x3f, (unsigned int*) blk_##l);		\
+									\
+	w3_##l = vec_perm(w2_##l, w3_##l, load_vec_##l);		\
+	w2_##l = vec_perm(w1_##l, w2_##l, load_vec_##l);		\
+	w1_##l = vec_perm(w0_##l, w1_##l, load_vec_##l);		\
+	w0_##l = vec_perm(tmp_vec0, w0_##l, load_vec_##l);		\
+									\
+	/* ALTIVEC ORDER */						\
+	tmp_vec0 = w0_##l;						\
+	w0_##l = vec_perm(w0_##l, w1_##l, perm_load_upper);		\
+	tmp_vec1 = w1_##l;						\
+	w1_##l = vec_perm(w2_##l, w3_##l, perm_load_upper);		\
+	tmp_vec2 = w2_##l;						\
+	w2_##l = vec_perm(tmp_vec0, tmp_vec1, perm_load_lower);		\
+	w3_##l = vec_perm(tmp_vec2, w3_##l, perm_load_lower);		\
+									\
+	tmp_vec2 = vec_ld(0, (unsigned int*) ts_##l);			\
+	tmp_vec0 = vec_sld(X1_##l, X3_##l, 8);				\
+	tmp_vec1 = vec_sld(tmp_vec2, tmp_vec2, 8);			\
+	tmp_vec0 = vec_add64(tmp_vec0, tmp_vec1);			\
+									\
+	X1_##l = vec_perm(X1_##l, tmp_vec0, perm_load_upper);		\
+	X3_##l = vec_perm(tmp_vec0, X3_##l, perm_load_lower);		\
+									\
+	X0_##l = vec_add64(X0_##l, w0_##l);				\
+	X1_##l = vec_add64(X1_##l, w1_##l);				\
+	X2_##l = vec_add64(X2_##l, w2_##l);				\
+	X3_##l = vec_add64(X3_##l, w3_##l);
+
+#define Skein_512_lane_round(l, rot_a, rot_b, rot_c, rot_d)		\
+	X0_##l = vec_add64(X0_##l, X2_##l);				\
+	X1_##l = vec_add64(X1_##l, X3_##l);				\
+	vec_rotl64(X2_##l, rot_a, rot_b);				\
+	vec_rotl64(X3_##l, rot_c, rot_d);				\
+	X2_##l = vec_xor(X2_##l, X0_##l);				\
+	X3_##l = vec_xor(X3_##l, X1_##l);
+
+/* lane permutation after the rounds 0, 2, 4 and 6 */
+#define Skein_512_lane_swap_even(l)					\
+	X2_##l = vec_perm(X2_##l, X2_##l, perm_swap_u64);		\
+	X3_##l = vec_perm(X3_##l, X3_##l, perm_swap_u64);
+
+/* lane permutation after the rounds 1, 3, 5 and 7 */
+#define Skein_512_lane_swap_odd(l)					\
+	tmp_vec0 = X2_##l;						\
+	X2_##l = vec_perm(X3_##l, X3_##l, perm_swap_u64);		\
+	X3_##l = vec_perm(tmp_vec0, tmp_vec0, perm_swap_u64);
+
+#define Skein_512_lane_inject(l, r)					\
+	KeyInject_add_##l[0] = ks_##l[((r)+0) % (8+1)];			\
+	KeyInject_add_##l[4] = ks_##l[((r)+1) % (8+1)];			\
+	KeyInject_add_##l[1] = ks_##l[((r)+2) % (8+1)];			\
+	KeyInject_add_##l[5] = ks_##l[((r)+3) % (8+1)];			\
+	KeyInject_add_##l[2] = ks_##l[((r)+4) % (8+1)];			\
+	KeyInject_add_##l[6] = ks_##l[((r)+5) % (8+1)] + ts_##l[((r)+0) % 3];	\
+	KeyInject_add_##l[3] = ks_##l[((r)+6) % (8+1)] + ts_##l[((r)+1) % 3];	\
+	KeyInject_add_##l[7] = ks_##l[((r)+7) % (8+1)] + (r);		\
+									\
+	tmp_vec0 = vec_ld(0x00, (unsigned int*) KeyInject_add_##l);	\
+	tmp_vec1 = vec_ld(0x10, (unsigned int*) KeyInject_add_##l);	\
+	tmp_vec2 = vec_ld(0x20, (unsigned int*) KeyInject_add_##l);	\
+	tmp_vec3 = vec_ld(0x30, (unsigned int*) KeyInject_add_##l);	\
+	X0_##l = vec_add64(X0_##l, tmp_vec0);				\
+	X1_##l = vec_add64(X1_##l, tmp_vec1);				\
+	X2_##l = vec_add64(X2_##l, tmp_vec2);				\
+	X3_##l = vec_add64(X3_##l, tmp_vec3);
+
+/* the final "feedforward" xor of one lane */
+#define Skein_512_lane_end(l)						\
+	X0_##l = vec_xor(X0_##l, w0_##l);				\
+	X1_##l = vec_xor(X1_##l, w1_##l);				\
+	X2_##l = vec_xor(X2_##l, w2_##l);				\
+	X3_##l = vec_xor(X3_##l, w3_##l);				\
+									\
+	ts_##l[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */	\
+	blk_##l += SKEIN_512_BLOCK_BYTES;
+
+#define Skein_512_lane_store(l)						\
+	/* UNDO ALTIVEC ORDER */					\
+	tmp_vec0 = vec_perm(X0_##l, X2_##l, perm_load_upper);		\
+	tmp_vec1 = vec_perm(X0_##l, X2_##l, perm_load_lower);		\
+	tmp_vec2 = vec_perm(X1_##l, X3_##l, perm_load_upper);		\
+	tmp_vec3 = vec_perm(X1_##l, X3_##l, perm_load_lower);		\
+	vec_st(tmp_vec0, 0x00, (unsigned int*) ctx[l]->X);		\
+	vec_st(tmp_vec1, 0x10, (unsigned int*) ctx[l]->X);		\
+	vec_st(tmp_vec2, 0x20, (unsigned int*) ctx[l]->X);		\
+	vec_st(tmp_vec3, 0x30, (unsigned int*) ctx[l]->X);		\
+									\
+	ctx[l]->h.T[0] = ts_##l[0];					\
+	ctx[l]->h.T[1] = ts_##l[1];					\
+									\
+	Skein_Prefetch_Stop(l);
+
+/* eight rounds (and two key injections) of all lanes */
+#define Skein_512_lanes_8_rounds(r)					\
+	FOR_LANES_R(Skein_512_lane_round, R_512_0_0, R_512_0_1, R_512_0_2, R_512_0_3) \
+	FOR_LANES(Skein_512_lane_swap_even)				\
+	FOR_LANES_R(Skein_512_lane_round, R_512_1_3, R_512_1_0, R_512_1_1, R_512_1_2) \
+	FOR_LANES(Skein_512_lane_swap_odd)				\
+	FOR_LANES_R(Skein_512_lane_round, R_512_2_2, R_512_2_3, R_512_2_0, R_512_2_1) \
+	FOR_LANES(Skein_512_lane_swap_even)				\
+	FOR_LANES_R(Skein_512_lane_round, R_512_3_1, R_512_3_2, R_512_3_3, R_512_3_0) \
+	FOR_LANES(Skein_512_lane_swap_odd)				\
+									\
+	FOR_LANES_K(Skein_512_lane_inject, 2 * (r) - 1)			\
+									\
+	FOR_LANES_R(Skein_512_lane_round, R_512_4_0, R_512_4_1, R_512_4_2, R_512_4_3) \
+	FOR_LANES(Skein_512_lane_swap_even)				\
+	FOR_LANES_R(Skein_512_lane_round, R_512_5_3, R_512_5_0, R_512_5_1, R_512_5_2) \
+	FOR_LANES(Skein_512_lane_swap_odd)				\
+	FOR_LANES_R(Skein_512_lane_round, R_512_6_2, R_512_6_3, R_512_6_0, R_512_6_1) \
+	FOR_LANES(Skein_512_lane_swap_even)				\
+	FOR_LANES_R(Skein_512_lane_round, R_512_7_1, R_512_7_2, R_512_7_3, R_512_7_0) \
+	FOR_LANES(Skein_512_lane_swap_odd)				\
+									\
+	FOR_LANES_K(Skein_512_lane_inject, 2 * (r))
+
+/* constants shared by all lanes */
+#define Skein_512_lanes_vectors						\
+	rotl64_vectors							\
+	add64_vectors							\
+	vector unsigned char perm_load_upper = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17}; \
+	vector unsigned char perm_load_lower = {0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F}; \
+	vector unsigned char perm_swap_u64 = {8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7}; \
+	vector char load_vec = {7, 5, 3, 1, -1, -3, -5, -7, 7, 5, 3, 1, -1, -3, -5, -7,}; \
+									\
+	vector unsigned int tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;	\
+	Skein_Prefetch_vars(SKEIN_512_BLOCK_BYTES)
+
+#define rotl64_vectors rotl64b_vectors
+#define vec_rotl64 vec_rotl64b
+
+#define FOR_LANES(M)			M(0) M(1)
+#define FOR_LANES_K(M, r)		M(0, r) M(1, r)
+#define FOR_LANES_R(M, a, b, c, d)	M(0, a, b, c, d) M(1, a, b, c, d)
+
+void Skein_512_Process_Block_x2_altivec(Skein_512_Ctxt_t * ctx[2],
+					const u08b_t * blkPtr[2], size_t blkCnt,
+					const size_t byteCntAdd[2])
+{	/* two independent contexts at once */
+	size_t r;
+
+	FOR_LANES(Skein_512_lane_vectors)
+	Skein_512_lanes_vectors
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	FOR_LANES(Skein_512_lane_load)
+
+	do {
+		FOR_LANES(Skein_512_lane_start)
+
+		for (r = 1; r <= SKEIN_512_ROUNDS_TOTAL / 8; r++) { /* unroll 8 rounds */
+			Skein_512_lanes_8_rounds(r)
+		}
+
+		FOR_LANES(Skein_512_lane_end)
+	} while (--blkCnt);
+
+	FOR_LANES(Skein_512_lane_store)
+}
+
+#undef FOR_LANES
+#undef FOR_LANES_K
+#undef FOR_LANES_R
+
+#define FOR_LANES(M)			M(0) M(1) M(2) M(3)
+#define FOR_LANES_K(M, r)		M(0, r) M(1, r) M(2, r) M(3, r)
+#define FOR_LANES_R(M, a, b, c, d)	M(0, a, b, c, d) M(1, a, b, c, d) \
+					M(2, a, b, c, d) M(3, a, b, c, d)
+
+void Skein_512_Process_Block_x4_altivec(Skein_512_Ctxt_t * ctx[4],
+					const u08b_t * blkPtr[4], size_t blkCnt,
+					const size_t byteCntAdd[4])
+{	/* four independent contexts at once */
+	size_t r;
+
+	FOR_LANES(Skein_512_lane_vectors)
+	Skein_512_lanes_vectors
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	FOR_LANES(Skein_512_lane_load)
+
+	do {
+		FOR_LANES(Skein_512_lane_start)
+
+		for (r = 1; r <= SKEIN_512_ROUNDS_TOTAL / 8; r++) { /* unroll 8 rounds */
+			Skein_512_lanes_8_rounds(r)
+		}
+
+		FOR_LANES(Skein_512_lane_end)
+	} while (--blkCnt);
+
+	FOR_LANES(Skein_512_lane_store)
+}
+
+#undef FOR_LANES
+#undef FOR_LANES_K
+#undef FOR_LANES_R
+
+#undef rotl64_vectors
+#undef vec_rotl64
+
+/*
+ * SKEIN_UNROLL_1024: number of 8 round groups in one pass of the 1024 bit
+ * round loop (0: all of them). More groups mean fewer loop branches and
+ * constant subkey offsets, but more I-cache.
+ */
+#ifndef SKEIN_UNROLL_1024
+#define SKEIN_UNROLL_1024 (1)
+#endif
+
+#if SKEIN_UNROLL_1024 == 0 || SKEIN_UNROLL_1024 > SKEIN1024_ROUNDS_TOTAL / 8
+#define SKEIN_UNROLL_1024_CNT (SKEIN1024_ROUNDS_TOTAL / 8)	/* fully unrolled */
+#else
+#define SKEIN_UNROLL_1024_CNT (SKEIN_UNROLL_1024)
+#endif
+
+/* the subkeys are precomputed once per block (in ALTIVEC ORDER) */
+#define InjectKey_1024_altivec(r)					\
+	tmp_vec0 = vec_ld(0x00, (unsigned int*) sk[r]);			\
+	tmp_vec1 = vec_ld(0x10, (unsigned int*) sk[r]);			\
+	tmp_vec2 = vec_ld(0x20, (unsigned int*) sk[r]);			\
+	tmp_vec3 = vec_ld(0x30, (unsigned int*) sk[r]);			\
+	tmp_vec4 = vec_ld(0x40, (unsigned int*) sk[r]);			\
+	tmp_vec5 = vec_ld(0x50, (unsigned int*) sk[r]);			\
+	tmp_vec6 = vec_ld(0x60, (unsigned int*) sk[r]);			\
+	tmp_vec7 = vec_ld(0x70, (unsigned int*) sk[r]);			\
 	X0 = vec_add64(X0, tmp_vec0);					\
 	X1 = vec_add64(X1, tmp_vec1);					\
 	X2 = vec_add64(X2, tmp_vec2);					\
@@ -697,24 +1029,43 @@ uint_t Skein_512_Unroll_Cnt(void)
 	X7 = vec_add64(X7, tmp_vec7);
 
 #define Skein_Get64_1024_altivec(addr)				\
-	tmp_vec0 = vec_ld(0, (unsigned int*) (addr));		\
-	w0 = vec_ld(0x10, (unsigned int*) (addr));		\
-	w1 = vec_ld(0x20, (unsigned int*) (addr));		\
-	w2 = vec_ld(0x30, (unsigned int*) (addr));		\
-	w3 = vec_ld(0x40, (unsigned int*) (addr));		\
-	w4 = vec_ld(0x50, (unsigned int*) (addr));		\
-	w5 = vec_ld(0x60, (unsigned int*) (addr));		\
-	w6 = vec_ld(0x70, (unsigned int*) (addr));		\
-	w7 = vec_ld(0x7f, (unsigned int*) (addr));		\
+	if (aligned) {	/* one load and one permute per vector */ \
+		w0 = vec_ld(0x00, (unsigned int*) (addr));	\
+		w1 = vec_ld(0x10, (unsigned int*) (addr));	\
+		w2 = vec_ld(0x20, (unsigned int*) (addr));	\
+		w3 = vec_ld(0x30, (unsigned int*) (addr));	\
+		w4 = vec_ld(0x40, (unsigned int*) (addr));	\
+		w5 = vec_ld(0x50, (unsigned int*) (addr));	\
+		w6 = vec_ld(0x60, (unsigned int*) (addr));	\
+		w7 = vec_ld(0x70, (unsigned int*) (addr));	\
+		w0 = vec_perm(w0, w0, load_vec);		\
+		w1 = vec_perm(w1, w1, load_vec);		\
+		w2 = vec_perm(w2, w2, load_vec);		\
+		w3 = vec_perm(w3, w3, load_vec);		\
+		w4 = vec_perm(w4, w4, load_vec);		\
+		w5 = vec_perm(w5, w5, load_vec);		\
+		w6 = vec_perm(w6, w6, load_vec);		\
+		w7 = vec_perm(w7, w7, load_vec);		\
+	} else {						\
+		tmp_vec0 = vec_ld(0, (unsigned int*) (addr));	\
+		w0 = vec_ld(0x10, (unsigned int*) (addr));	\
+		w1 = vec_ld(0x20, (unsigned int*) (addr));	\
+		w2 = vec_ld(0x30, (unsigned int*) (addr));	\
+		w3 = vec_ld(0x40, (unsigned int*) (addr));	\
+		w4 = vec_ld(0x50, (unsigned int*) (addr));	\
+		w5 = vec_ld(0x60, (unsigned int*) (addr));	\
+		w6 = vec_ld(0x70, (unsigned int*) (addr));	\
+		w7 = vec_ld(0x7f, (unsigned int*) (addr));	\
 								\
-	w7 = vec_perm(w6, w7, load_vec);			\
-	w6 = vec_perm(w5, w6, load_vec);			\
-	w5 = vec_perm(w4, w5, load_vec);			\
-	w4 = vec_perm(w3, w4, load_vec);			\
-	w3 = vec_perm(w2, w3, load_vec);			\
-	w2 = vec_perm(w1, w2, load_vec);			\
-	w1 = vec_perm(w0, w1, load_vec);			\
-	w0 = vec_perm(tmp_vec0, w0, load_vec);			\
+		w7 = vec_perm(w6, w7, load_vec);		\
+		w6 = vec_perm(w5, w6, load_vec);		\
+		w5 = vec_perm(w4, w5, load_vec);		\
+		w4 = vec_perm(w3, w4, load_vec);		\
+		w3 = vec_perm(w2, w3, load_vec);		\
+		w2 = vec_perm(w1, w2, load_vec);		\
+		w1 = vec_perm(w0, w1, load_vec);		\
+		w0 = vec_perm(tmp_vec0, w0, load_vec);		\
+	}							\
 								\
 	/* ALTIVEC ORDER */					\
 	tmp_vec0 = w0;						\
@@ -734,19 +1085,188 @@ uint_t Skein_512_Unroll_Cnt(void)
 	w6 = vec_perm(tmp_vec4, tmp_vec5, perm_load_lower);	\
 	w7 = vec_perm(tmp_vec6, w7, perm_load_lower);
 
+/* B was only found faster with 256 and 512 bit (see above); with eight state,
+ * eight message/temporary and the permute vectors live, its three extra
+ * constants and three temporaries would not fit in the 32 vector registers */
 #define rotl64_vectors rotl64a_vectors
 #define vec_rotl64 vec_rotl64a
 
-void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
-			     size_t blkCnt, size_t byteCntAdd)
+/* eight rounds and two key injections */
+#define Round1024_8_altivec(r)						\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_0_0, R1024_0_1);				\
+	vec_rotl64(X5, R1024_0_2, R1024_0_3);				\
+	vec_rotl64(X6, R1024_0_4, R1024_0_5);				\
+	vec_rotl64(X7, R1024_0_6, R1024_0_7);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X6, X7, perm_load_upper);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X7, X6, perm_load_lower);				\
+	X6 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);	\
+	X7 = vec_sld(tmp_vec4, tmp_vec5, 8);				\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_1_0, R1024_1_1);				\
+	vec_rotl64(X5, R1024_1_3, R1024_1_2);				\
+	vec_rotl64(X6, R1024_1_7, R1024_1_4);				\
+	vec_rotl64(X7, R1024_1_5, R1024_1_6);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X6, X7, perm_load_lower);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X7, X6, perm_load_upper);				\
+	X6 = vec_sld(tmp_vec5, tmp_vec4, 8);				\
+	X7 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);	\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_2_0, R1024_2_1);				\
+	vec_rotl64(X5, R1024_2_2, R1024_2_3);				\
+	vec_rotl64(X6, R1024_2_6, R1024_2_7);				\
+	vec_rotl64(X7, R1024_2_4, R1024_2_5);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X7, X6, perm_load_upper);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X6, X7, perm_load_lower);				\
+	X6 = vec_sld(tmp_vec4, tmp_vec5, 8);				\
+	X7 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);	\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_3_0, R1024_3_1);				\
+	vec_rotl64(X5, R1024_3_3, R1024_3_2);				\
+	vec_rotl64(X6, R1024_3_5, R1024_3_6);				\
+	vec_rotl64(X7, R1024_3_7, R1024_3_4);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X7, X6, perm_load_lower);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X6, X7, perm_load_upper);				\
+	X6 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);	\
+	X7 = vec_sld(tmp_vec5, tmp_vec4, 8);				\
+									\
+	InjectKey_1024_altivec(2 * (r) - 1);				\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_4_0, R1024_4_1);				\
+	vec_rotl64(X5, R1024_4_2, R1024_4_3);				\
+	vec_rotl64(X6, R1024_4_4, R1024_4_5);				\
+	vec_rotl64(X7, R1024_4_6, R1024_4_7);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X6, X7, perm_load_upper);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X7, X6, perm_load_lower);				\
+	X6 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);	\
+	X7 = vec_sld(tmp_vec4, tmp_vec5, 8);				\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_5_0, R1024_5_1);				\
+	vec_rotl64(X5, R1024_5_3, R1024_5_2);				\
+	vec_rotl64(X6, R1024_5_7, R1024_5_4);				\
+	vec_rotl64(X7, R1024_5_5, R1024_5_6);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X6, X7, perm_load_lower);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X7, X6, perm_load_upper);				\
+	X6 = vec_sld(tmp_vec5, tmp_vec4, 8);				\
+	X7 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);	\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_6_0, R1024_6_1);				\
+	vec_rotl64(X5, R1024_6_2, R1024_6_3);				\
+	vec_rotl64(X6, R1024_6_6, R1024_6_7);				\
+	vec_rotl64(X7, R1024_6_4, R1024_6_5);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X7, X6, perm_load_upper);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X6, X7, perm_load_lower);				\
+	X6 = vec_sld(tmp_vec4, tmp_vec5, 8);				\
+	X7 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);	\
+									\
+	X0 = vec_add64(X0, X4);						\
+	X1 = vec_add64(X1, X5);						\
+	X2 = vec_add64(X2, X6);						\
+	X3 = vec_add64(X3, X7);						\
+	vec_rotl64(X4, R1024_7_0, R1024_7_1);				\
+	vec_rotl64(X5, R1024_7_3, R1024_7_2);				\
+	vec_rotl64(X6, R1024_7_5, R1024_7_6);				\
+	vec_rotl64(X7, R1024_7_7, R1024_7_4);				\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);						\
+									\
+	tmp_vec4 = X4;							\
+	X4 = vec_perm(X7, X6, perm_load_lower);				\
+	tmp_vec5 = X5;							\
+	X5 = vec_perm(X6, X7, perm_load_upper);				\
+	X6 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);	\
+	X7 = vec_sld(tmp_vec5, tmp_vec4, 8);				\
+									\
+	InjectKey_1024_altivec(2 * (r));
+
+/* aligned is a constant, so this is specialized for both callers below */
+static inline __attribute__((always_inline))
+void Skein1024_Process_Block_body(Skein1024_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd, const int aligned)
 {	/* do it in C with altivec! */
-	size_t r;
-	u64b_t ks[18] __attribute__((aligned(16)));
+	size_t r, i;
+	u64b_t ks[17 + 19] __attribute__((aligned(16)));	/* repeated: no modulo */
 	u64b_t ts[3] __attribute__((aligned(16)));
-	u64b_t KeyInject_add[16] __attribute__((aligned(16)));
-
-	/* The Xi is only used for storing the data. */
-	u64b_t Xi[16] __attribute__((aligned(16)));
+	u64b_t sk[SKEIN1024_ROUNDS_TOTAL / 4 + 1][16] __attribute__((aligned(16)));
 
 	vector unsigned int X0, X1, X2, X3, X4, X5, X6, X7;
 	vector unsigned int w0, w1, w2, w3, w4, w5, w6, w7;
@@ -760,53 +1280,45 @@ void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
 	vector unsigned char perm_load_upper_lower = {0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F};
 	/* The byte offset of the input data will be added to this (using vec_lvsl).
 	 * It is then possible to load the input data, and swap its endianness at
-	 * the same time. */
+	 * the same time. For aligned input it is just the byte swap. */
 	vector char load_vec = {7, 5, 3, 1, -1, -3, -5, -7, 7, 5, 3, 1, -1, -3, -5, -7,};
 
 	vector unsigned int tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;
 	vector unsigned int tmp_vec4, tmp_vec5, tmp_vec6, tmp_vec7;
-	unsigned int dst_control_word = 0x09020080; /* Preload two blocks of 64 bytes each. */
+	Skein_Prefetch_vars(SKEIN1024_BLOCK_BYTES)
 
 	tmp_vec0 = (vector unsigned int) vec_lvsl(0, blkPtr);
 	load_vec = vec_add((vector char) tmp_vec0, load_vec);
 
 	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
 
-	memcpy(Xi, ctx->X, 8*16);
-	
-	X0 = vec_ld(0x00, (unsigned int*) Xi);
-	X1 = vec_ld(0x10, (unsigned int*) Xi);
-	X2 = vec_ld(0x20, (unsigned int*) Xi);
-	X3 = vec_ld(0x30, (unsigned int*) Xi);
-	X4 = vec_ld(0x40, (unsigned int*) Xi);
-	X5 = vec_ld(0x50, (unsigned int*) Xi);
-	X6 = vec_ld(0x60, (unsigned int*) Xi);
-	X7 = vec_ld(0x70, (unsigned int*) Xi);
-
-	/* ALTIVEC ORDER */
-	tmp_vec0 = X0;
-	X0 = vec_perm(X0, X1, perm_load_upper);
-	tmp_vec1 = X1;
-	X1 = vec_perm(X2, X3, perm_load_upper);
-	tmp_vec2 = X2;
-	X2 = vec_perm(X4, X5, perm_load_upper);
-	tmp_vec3 = X3;
-	X3 = vec_perm(X6, X7, perm_load_upper);
-
-	tmp_vec4 = X4;
+	/* ctx->X is in the spec's order: ALTIVEC ORDER for the rounds */
+	tmp_vec0 = vec_ld(0x00, (unsigned int*) ctx->X);
+	tmp_vec1 = vec_ld(0x10, (unsigned int*) ctx->X);
+	tmp_vec2 = vec_ld(0x20, (unsigned int*) ctx->X);
+	tmp_vec3 = vec_ld(0x30, (unsigned int*) ctx->X);
+	tmp_vec4 = vec_ld(0x40, (unsigned int*) ctx->X);
+	tmp_vec5 = vec_ld(0x50, (unsigned int*) ctx->X);
+	tmp_vec6 = vec_ld(0x60, (unsigned int*) ctx->X);
+	tmp_vec7 = vec_ld(0x70, (unsigned int*) ctx->X);
+	X0 = vec_perm(tmp_vec0, tmp_vec1, perm_load_upper);
 	X4 = vec_perm(tmp_vec0, tmp_vec1, perm_load_lower);
-	tmp_vec5 = X5;
+	X1 = vec_perm(tmp_vec2, tmp_vec3, perm_load_upper);
 	X5 = vec_perm(tmp_vec2, tmp_vec3, perm_load_lower);
-	tmp_vec6 = X6;
+	X2 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper);
 	X6 = vec_perm(tmp_vec4, tmp_vec5, perm_load_lower);
-	X7 = vec_perm(tmp_vec6, X7, perm_load_lower);
+	X3 = vec_perm(tmp_vec6, tmp_vec7, perm_load_upper);
+	X7 = vec_perm(tmp_vec6, tmp_vec7, perm_load_lower);
 
 	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
 	do {
-		vec_dst(blkPtr, dst_control_word, 0);
+		Skein_Prefetch_Block(blkPtr, SKEIN1024_BLOCK_BYTES, 0);
 
 		/* this implementation only supports 2**64 input bytes (no carry out here) */
-		ctx->h.T[0] += byteCntAdd;	/* update processed length */
+		ts[0] += byteCntAdd;	/* update processed length */
 
 		/* Store ks in normal order. */
 		tmp_vec0 = vec_perm(X0, X4, perm_load_upper);
@@ -839,9 +1351,23 @@ void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
 		ks[16] ^= ks[17];
 		ks[16] ^= SKEIN_KS_PARITY;
 
-		ts[0] = ctx->h.T[0];
-		ts[1] = ctx->h.T[1];
 		ts[2] = ts[0] ^ ts[1];
+
+		/* the whole key schedule, the even words first like X: 320 word
+		 * copies and 60 adds per block, as many as the KeyInject_add fills
+		 * did, but done before the rounds instead of between them */
+		for (i = 17; i < 17 + 19; i++)
+			ks[i] = ks[i - 17];
+		for (r = 1; r <= SKEIN1024_ROUNDS_TOTAL / 4; r++) {
+			for (i = 0; i < 8; i++) {
+				sk[r][i] = ks[r + 2 * i];
+				sk[r][8 + i] = ks[r + 2 * i + 1];
+			}
+			sk[r][14] += ts[r % 3];		/* word 13 */
+			sk[r][7] += ts[(r + 1) % 3];	/* word 14 */
+			sk[r][15] += r;			/* word 15 */
+		}
+
 		Skein_Get64_1024_altivec(blkPtr); /* load input block into w[] registers */
 
 		X0 = vec_add64(X0, w0);
@@ -861,172 +1387,55 @@ void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
 		X3 = vec_perm(X3, tmp_vec0, perm_load_upper);
 		X7 = vec_perm(tmp_vec0, X7, perm_load_lower);
 
-		for (r = 1; r <= SKEIN1024_ROUNDS_TOTAL / 8; r++) {	/* unroll 8 rounds */
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_0_0, R1024_0_1);
-			vec_rotl64(X5, R1024_0_2, R1024_0_3);
-			vec_rotl64(X6, R1024_0_4, R1024_0_5);
-			vec_rotl64(X7, R1024_0_6, R1024_0_7);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X6, X7, perm_load_upper);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X7, X6, perm_load_lower);
-			X6 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);
-			X7 = vec_sld(tmp_vec4, tmp_vec5, 8);
-
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_1_0, R1024_1_1);
-			vec_rotl64(X5, R1024_1_3, R1024_1_2);
-			vec_rotl64(X6, R1024_1_7, R1024_1_4);
-			vec_rotl64(X7, R1024_1_5, R1024_1_6);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X6, X7, perm_load_lower);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X7, X6, perm_load_upper);
-			X6 = vec_sld(tmp_vec5, tmp_vec4, 8);
-			X7 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);
-
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_2_0, R1024_2_1);
-			vec_rotl64(X5, R1024_2_2, R1024_2_3);
-			vec_rotl64(X6, R1024_2_6, R1024_2_7);
-			vec_rotl64(X7, R1024_2_4, R1024_2_5);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X7, X6, perm_load_upper);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X6, X7, perm_load_lower);
-			X6 = vec_sld(tmp_vec4, tmp_vec5, 8);
-			X7 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);
-			
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_3_0, R1024_3_1);
-			vec_rotl64(X5, R1024_3_3, R1024_3_2);
-			vec_rotl64(X6, R1024_3_5, R1024_3_6);
-			vec_rotl64(X7, R1024_3_7, R1024_3_4);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X7, X6, perm_load_lower);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X6, X7, perm_load_upper);
-			X6 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);
-			X7 = vec_sld(tmp_vec5, tmp_vec4, 8);
-
-			InjectKey_1024_altivec(2 * r - 1);
-
-
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_4_0, R1024_4_1);
-			vec_rotl64(X5, R1024_4_2, R1024_4_3);
-			vec_rotl64(X6, R1024_4_4, R1024_4_5);
-			vec_rotl64(X7, R1024_4_6, R1024_4_7);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X6, X7, perm_load_upper);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X7, X6, perm_load_lower);
-			X6 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);
-			X7 = vec_sld(tmp_vec4, tmp_vec5, 8);
-
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_5_0, R1024_5_1);
-			vec_rotl64(X5, R1024_5_3, R1024_5_2);
-			vec_rotl64(X6, R1024_5_7, R1024_5_4);
-			vec_rotl64(X7, R1024_5_5, R1024_5_6);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X6, X7, perm_load_lower);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X7, X6, perm_load_upper);
-			X6 = vec_sld(tmp_vec5, tmp_vec4, 8);
-			X7 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);
-
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_6_0, R1024_6_1);
-			vec_rotl64(X5, R1024_6_2, R1024_6_3);
-			vec_rotl64(X6, R1024_6_6, R1024_6_7);
-			vec_rotl64(X7, R1024_6_4, R1024_6_5);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X7, X6, perm_load_upper);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X6, X7, perm_load_lower);
-			X6 = vec_sld(tmp_vec4, tmp_vec5, 8);
-			X7 = vec_perm(tmp_vec4, tmp_vec5, perm_load_upper_lower);
-			
-			X0 = vec_add64(X0, X4);
-			X1 = vec_add64(X1, X5);
-			X2 = vec_add64(X2, X6);
-			X3 = vec_add64(X3, X7);
-			vec_rotl64(X4, R1024_7_0, R1024_7_1);
-			vec_rotl64(X5, R1024_7_3, R1024_7_2);
-			vec_rotl64(X6, R1024_7_5, R1024_7_6);
-			vec_rotl64(X7, R1024_7_7, R1024_7_4);
-			X4 = vec_xor(X4, X0);
-			X5 = vec_xor(X5, X1);
-			X6 = vec_xor(X6, X2);
-			X7 = vec_xor(X7, X3);
-
-			tmp_vec4 = X4;
-			X4 = vec_perm(X7, X6, perm_load_lower);
-			tmp_vec5 = X5;
-			X5 = vec_perm(X6, X7, perm_load_upper);
-			X6 = vec_perm(tmp_vec5, tmp_vec4, perm_load_upper_lower);
-			X7 = vec_sld(tmp_vec5, tmp_vec4, 8);
-
-			InjectKey_1024_altivec(2 * r);
+		/* SKEIN_UNROLL_1024_CNT groups of 8 rounds per pass */
+		for (r = 1; r + SKEIN_UNROLL_1024_CNT - 1 <= SKEIN1024_ROUNDS_TOTAL / 8;
+		     r += SKEIN_UNROLL_1024_CNT) {
+			Round1024_8_altivec(r);
+#if SKEIN_UNROLL_1024_CNT > 1
+			Round1024_8_altivec(r + 1);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 2
+			Round1024_8_altivec(r + 2);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 3
+			Round1024_8_altivec(r + 3);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 4
+			Round1024_8_altivec(r + 4);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 5
+			Round1024_8_altivec(r + 5);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 6
+			Round1024_8_altivec(r + 6);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 7
+			Round1024_8_altivec(r + 7);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 8
+			Round1024_8_altivec(r + 8);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 9
+			Round1024_8_altivec(r + 9);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 10
+			Round1024_8_altivec(r + 10);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 11
+			Round1024_8_altivec(r + 11);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 12
+			Round1024_8_altivec(r + 12);
+#endif
+#if SKEIN_UNROLL_1024_CNT > 13
+			Round1024_8_altivec(r + 13);
+#endif
+		}
+#if (SKEIN1024_ROUNDS_TOTAL / 8) % SKEIN_UNROLL_1024_CNT
+		for (; r <= SKEIN1024_ROUNDS_TOTAL / 8; r++) {	/* the groups that are left */
+			Round1024_8_altivec(r);
 		}
+#endif
 		/* do the final "feedforward" xor */
 		X0 = vec_xor(X0, w0);
 		X1 = vec_xor(X1, w1);
@@ -1037,12 +1446,15 @@ void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
 		X6 = vec_xor(X6, w6);
 		X7 = vec_xor(X7, w7);
 
-		Skein_Clear_First_Flag(ctx->h);	/* clear the start bit */
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
 		blkPtr += SKEIN1024_BLOCK_BYTES;
 	}
 	while (--blkCnt);
 
-	vec_dss(0);
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	Skein_Prefetch_Stop(0);
 
 	/* UNDO ALTIVEC ORDER */
 	tmp_vec0 = vec_perm(X0, X4, perm_load_upper);
@@ -1053,34 +1465,47 @@ void Skein1024_Process_Block(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
 	tmp_vec5 = vec_perm(X2, X6, perm_load_lower);
 	tmp_vec6 = vec_perm(X3, X7, perm_load_upper);
 	tmp_vec7 = vec_perm(X3, X7, perm_load_lower);
+	vec_st(tmp_vec0, 0x00, (unsigned int*) ctx->X);
+	vec_st(tmp_vec1, 0x10, (unsigned int*) ctx->X);
+	vec_st(tmp_vec2, 0x20, (unsigned int*) ctx->X);
+	vec_st(tmp_vec3, 0x30, (unsigned int*) ctx->X);
+	vec_st(tmp_vec4, 0x40, (unsigned int*) ctx->X);
+	vec_st(tmp_vec5, 0x50, (unsigned int*) ctx->X);
+	vec_st(tmp_vec6, 0x60, (unsigned int*) ctx->X);
+	vec_st(tmp_vec7, 0x70, (unsigned int*) ctx->X);
+}
 
-	vec_st(tmp_vec0, 0x00, (unsigned int*) Xi);
-	vec_st(tmp_vec1, 0x10, (unsigned int*) Xi);
-	vec_st(tmp_vec2, 0x20, (unsigned int*) Xi);
-	vec_st(tmp_vec3, 0x30, (unsigned int*) Xi);
-	vec_st(tmp_vec4, 0x40, (unsigned int*) Xi);
-	vec_st(tmp_vec5, 0x50, (unsigned int*) Xi);
-	vec_st(tmp_vec6, 0x60, (unsigned int*) Xi);
-	vec_st(tmp_vec7, 0x70, (unsigned int*) Xi);
+Skein_Code_Section(1024)
+void Skein1024_Process_Block_altivec(Skein1024_Ctxt_t * ctx,
+				     const u08b_t * blkPtr, size_t blkCnt,
+				     size_t byteCntAdd)
+{
+	Skein1024_Process_Block_body(ctx, blkPtr, blkCnt, byteCntAdd, 0);
+}
 
-	memcpy(ctx->X, Xi, 8*16);
+/* blkPtr must be 16-byte aligned */
+void Skein1024_Process_Block_aligned_altivec(Skein1024_Ctxt_t * ctx,
+					     const u08b_t * blkPtr, size_t blkCnt,
+					     size_t byteCntAdd)
+{
+	Skein1024_Process_Block_body(ctx, blkPtr, blkCnt, byteCntAdd, 1);
 }
 
 #undef rotl64_vectors
 #undef vec_rotl64
 
 #undef InjectKey_1024_altivec
-#undef Skein_Get64_1024_Altivec
+#undef Round1024_8_altivec
+#undef Skein_Get64_1024_altivec
 
 #if defined(SKEIN_CODE_SIZE) || defined(SKEIN_PERF)
 size_t Skein1024_Process_Block_CodeSize(void)
 {
-	return ((u08b_t *) Skein1024_Process_Block_CodeSize) -
-	    ((u08b_t *) Skein1024_Process_Block);
+	return Skein_Code_Size(1024);
 }
 
 uint_t Skein1024_Unroll_Cnt(void)
 {
-	return 1;
+	return SKEIN_UNROLL_1024_CNT;
 }
 #endif
@@ -0,0 +1,504 @@
+/***********************************************************************
+**
+** Implementation of the Skein block functions in portable C.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+/* About the scalar version
+ *
+ * This is the kernel for all CPUs without a vector unit that the other
+ * kernels can use (x86, ARM, the e300 PowerPC cores, ...). The state is
+ * kept in 64 bit locals, which 64 bit CPUs hold in registers, and the
+ * rounds are fully unrolled, so that all word permutations and key
+ * schedule indices are resolved at compile time. The rotations are
+ * written such that compilers emit a single rotate instruction where
+ * the CPU has one.
+ *
+ * ctx->X is kept in the spec's word order between calls.
+ */
+
+#include <string.h>
+#include "skein.h"
+#include "skein_kernel.h"
+
+#define RotL_64(x, N)	(((x) << (N)) | ((x) >> (64 - (N))))
+
+#if SKEIN_256_ROUNDS_TOTAL % 8 || SKEIN_512_ROUNDS_TOTAL % 8 || SKEIN1024_ROUNDS_TOTAL % 8
+#error "The unrolled rounds need a multiple of 8 rounds"
+#endif
+
+/*****************************  Skein_256 ******************************/
+
+#define Round256(p0, p1, p2, p3, ROT)					\
+	X##p0 += X##p1; X##p1 = RotL_64(X##p1, ROT##_0); X##p1 ^= X##p0;	\
+	X##p2 += X##p3; X##p3 = RotL_64(X##p3, ROT##_1); X##p3 ^= X##p2;
+
+/* key injection number s (after 4*s rounds) */
+#define I256(s)								\
+	X0 += ks[((s) + 0) % 5];					\
+	X1 += ks[((s) + 1) % 5] + ts[((s) + 0) % 3];			\
+	X2 += ks[((s) + 2) % 5] + ts[((s) + 1) % 3];			\
+	X3 += ks[((s) + 3) % 5] + (s);
+
+/* rounds 8*R+1 .. 8*R+8 */
+#define R256_8_rounds(R)						\
+	Round256(0, 1, 2, 3, R_256_0)					\
+	Round256(0, 3, 2, 1, R_256_1)					\
+	Round256(0, 1, 2, 3, R_256_2)					\
+	Round256(0, 3, 2, 1, R_256_3)					\
+	I256(2 * (R) + 1)						\
+	Round256(0, 1, 2, 3, R_256_4)					\
+	Round256(0, 3, 2, 1, R_256_5)					\
+	Round256(0, 1, 2, 3, R_256_6)					\
+	Round256(0, 3, 2, 1, R_256_7)					\
+	I256(2 * (R) + 2)
+
+void Skein_256_Process_Block_scalar(Skein_256_Ctxt_t * ctx,
+				    const u08b_t * blkPtr, size_t blkCnt,
+				    size_t byteCntAdd)
+{	/* do it in C */
+	u64b_t ks[SKEIN_256_STATE_WORDS + 1];	/* key schedule */
+	u64b_t ts[3];		/* tweak schedule */
+	u64b_t w[SKEIN_256_STATE_WORDS];	/* local copy of input block */
+	u64b_t X0, X1, X2, X3;	/* local copy of the state */
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	X0 = ctx->X[0];
+	X1 = ctx->X[1];
+	X2 = ctx->X[2];
+	X3 = ctx->X[3];
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* precompute the key schedule for this block */
+		ks[0] = X0;
+		ks[1] = X1;
+		ks[2] = X2;
+		ks[3] = X3;
+		ks[4] = X0 ^ X1 ^ X2 ^ X3 ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		Skein_Get64_LSB_First(w, blkPtr, SKEIN_256_STATE_WORDS);	/* get input block in little-endian format */
+
+		X0 = w[0] + ks[0];	/* do the first full key injection */
+		X1 = w[1] + ks[1] + ts[0];
+		X2 = w[2] + ks[2] + ts[1];
+		X3 = w[3] + ks[3];
+
+		R256_8_rounds(0)
+		R256_8_rounds(1)
+		R256_8_rounds(2)
+		R256_8_rounds(3)
+		R256_8_rounds(4)
+#if SKEIN_256_ROUNDS_TOTAL > 40
+		R256_8_rounds(5)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 48
+		R256_8_rounds(6)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 56
+		R256_8_rounds(7)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 64
+		R256_8_rounds(8)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 72
+		R256_8_rounds(9)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 80
+		R256_8_rounds(10)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 88
+		R256_8_rounds(11)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 96
+		R256_8_rounds(12)
+#endif
+#if SKEIN_256_ROUNDS_TOTAL > 104
+		R256_8_rounds(13)
+#endif
+
+		/* do the final "feedforward" xor */
+		X0 ^= w[0];
+		X1 ^= w[1];
+		X2 ^= w[2];
+		X3 ^= w[3];
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN_256_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	ctx->X[0] = X0;
+	ctx->X[1] = X1;
+	ctx->X[2] = X2;
+	ctx->X[3] = X3;
+}
+
+/*****************************  Skein_512 ******************************/
+
+#define Round512(p0, p1, p2, p3, p4, p5, p6, p7, ROT)			\
+	X##p0 += X##p1; X##p1 = RotL_64(X##p1, ROT##_0); X##p1 ^= X##p0;	\
+	X##p2 += X##p3; X##p3 = RotL_64(X##p3, ROT##_1); X##p3 ^= X##p2;	\
+	X##p4 += X##p5; X##p5 = RotL_64(X##p5, ROT##_2); X##p5 ^= X##p4;	\
+	X##p6 += X##p7; X##p7 = RotL_64(X##p7, ROT##_3); X##p7 ^= X##p6;
+
+#define I512(s)								\
+	X0 += ks[((s) + 0) % 9];					\
+	X1 += ks[((s) + 1) % 9];					\
+	X2 += ks[((s) + 2) % 9];					\
+	X3 += ks[((s) + 3) % 9];					\
+	X4 += ks[((s) + 4) % 9];					\
+	X5 += ks[((s) + 5) % 9] + ts[((s) + 0) % 3];			\
+	X6 += ks[((s) + 6) % 9] + ts[((s) + 1) % 3];			\
+	X7 += ks[((s) + 7) % 9] + (s);
+
+#define R512_8_rounds(R)						\
+	Round512(0, 1, 2, 3, 4, 5, 6, 7, R_512_0)			\
+	Round512(2, 1, 4, 7, 6, 5, 0, 3, R_512_1)			\
+	Round512(4, 1, 6, 3, 0, 5, 2, 7, R_512_2)			\
+	Round512(6, 1, 0, 7, 2, 5, 4, 3, R_512_3)			\
+	I512(2 * (R) + 1)						\
+	Round512(0, 1, 2, 3, 4, 5, 6, 7, R_512_4)			\
+	Round512(2, 1, 4, 7, 6, 5, 0, 3, R_512_5)			\
+	Round512(4, 1, 6, 3, 0, 5, 2, 7, R_512_6)			\
+	Round512(6, 1, 0, 7, 2, 5, 4, 3, R_512_7)			\
+	I512(2 * (R) + 2)
+
+void Skein_512_Process_Block_scalar(Skein_512_Ctxt_t * ctx,
+				    const u08b_t * blkPtr, size_t blkCnt,
+				    size_t byteCntAdd)
+{	/* do it in C */
+	u64b_t ks[SKEIN_512_STATE_WORDS + 1];	/* key schedule */
+	u64b_t ts[3];		/* tweak schedule */
+	u64b_t w[SKEIN_512_STATE_WORDS];	/* local copy of input block */
+	u64b_t X0, X1, X2, X3, X4, X5, X6, X7;	/* local copy of the state */
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	X0 = ctx->X[0];
+	X1 = ctx->X[1];
+	X2 = ctx->X[2];
+	X3 = ctx->X[3];
+	X4 = ctx->X[4];
+	X5 = ctx->X[5];
+	X6 = ctx->X[6];
+	X7 = ctx->X[7];
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* precompute the key schedule for this block */
+		ks[0] = X0;
+		ks[1] = X1;
+		ks[2] = X2;
+		ks[3] = X3;
+		ks[4] = X4;
+		ks[5] = X5;
+		ks[6] = X6;
+		ks[7] = X7;
+		ks[8] = X0 ^ X1 ^ X2 ^ X3 ^ X4 ^ X5 ^ X6 ^ X7 ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		Skein_Get64_LSB_First(w, blkPtr, SKEIN_512_STATE_WORDS);	/* get input block in little-endian format */
+
+		X0 = w[0] + ks[0];	/* do the first full key injection */
+		X1 = w[1] + ks[1];
+		X2 = w[2] + ks[2];
+		X3 = w[3] + ks[3];
+		X4 = w[4] + ks[4];
+		X5 = w[5] + ks[5] + ts[0];
+		X6 = w[6] + ks[6] + ts[1];
+		X7 = w[7] + ks[7];
+
+		R512_8_rounds(0)
+		R512_8_rounds(1)
+		R512_8_rounds(2)
+		R512_8_rounds(3)
+		R512_8_rounds(4)
+#if SKEIN_512_ROUNDS_TOTAL > 40
+		R512_8_rounds(5)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 48
+		R512_8_rounds(6)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 56
+		R512_8_rounds(7)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 64
+		R512_8_rounds(8)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 72
+		R512_8_rounds(9)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 80
+		R512_8_rounds(10)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 88
+		R512_8_rounds(11)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 96
+		R512_8_rounds(12)
+#endif
+#if SKEIN_512_ROUNDS_TOTAL > 104
+		R512_8_rounds(13)
+#endif
+
+		/* do the final "feedforward" xor */
+		X0 ^= w[0];
+		X1 ^= w[1];
+		X2 ^= w[2];
+		X3 ^= w[3];
+		X4 ^= w[4];
+		X5 ^= w[5];
+		X6 ^= w[6];
+		X7 ^= w[7];
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN_512_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	ctx->X[0] = X0;
+	ctx->X[1] = X1;
+	ctx->X[2] = X2;
+	ctx->X[3] = X3;
+	ctx->X[4] = X4;
+	ctx->X[5] = X5;
+	ctx->X[6] = X6;
+	ctx->X[7] = X7;
+}
+
+/*
+ * There is nothing to interleave the lanes with, the out of order cores
+ * that run this code overlap the independent rounds of one block anyway.
+ */
+void Skein_512_Process_Block_x2_scalar(Skein_512_Ctxt_t * ctx[2],
+				       const u08b_t * blkPtr[2], size_t blkCnt,
+				       const size_t byteCntAdd[2])
+{
+	Skein_512_Process_Block_scalar(ctx[0], blkPtr[0], blkCnt, byteCntAdd[0]);
+	Skein_512_Process_Block_scalar(ctx[1], blkPtr[1], blkCnt, byteCntAdd[1]);
+}
+
+void Skein_512_Process_Block_x4_scalar(Skein_512_Ctxt_t * ctx[4],
+				       const u08b_t * blkPtr[4], size_t blkCnt,
+				       const size_t byteCntAdd[4])
+{
+	Skein_512_Process_Block_x2_scalar(ctx, blkPtr, blkCnt, byteCntAdd);
+	Skein_512_Process_Block_x2_scalar(ctx + 2, blkPtr + 2, blkCnt,
+					  byteCntAdd + 2);
+}
+
+/*****************************  Skein1024 ******************************/
+
+#define Round1024(p0, p1, p2, p3, p4, p5, p6, p7, p8, p9, pA, pB, pC, pD, pE, pF, ROT) \
+	X##p0 += X##p1; X##p1 = RotL_64(X##p1, ROT##_0); X##p1 ^= X##p0;	\
+	X##p2 += X##p3; X##p3 = RotL_64(X##p3, ROT##_1); X##p3 ^= X##p2;	\
+	X##p4 += X##p5; X##p5 = RotL_64(X##p5, ROT##_2); X##p5 ^= X##p4;	\
+	X##p6 += X##p7; X##p7 = RotL_64(X##p7, ROT##_3); X##p7 ^= X##p6;	\
+	X##p8 += X##p9; X##p9 = RotL_64(X##p9, ROT##_4); X##p9 ^= X##p8;	\
+	X##pA += X##pB; X##pB = RotL_64(X##pB, ROT##_5); X##pB ^= X##pA;	\
+	X##pC += X##pD; X##pD = RotL_64(X##pD, ROT##_6); X##pD ^= X##pC;	\
+	X##pE += X##pF; X##pF = RotL_64(X##pF, ROT##_7); X##pF ^= X##pE;
+
+#define I1024(s)							\
+	X00 += ks[((s) +  0) % 17];					\
+	X01 += ks[((s) +  1) % 17];					\
+	X02 += ks[((s) +  2) % 17];					\
+	X03 += ks[((s) +  3) % 17];					\
+	X04 += ks[((s) +  4) % 17];					\
+	X05 += ks[((s) +  5) % 17];					\
+	X06 += ks[((s) +  6) % 17];					\
+	X07 += ks[((s) +  7) % 17];					\
+	X08 += ks[((s) +  8) % 17];					\
+	X09 += ks[((s) +  9) % 17];					\
+	X10 += ks[((s) + 10) % 17];					\
+	X11 += ks[((s) + 11) % 17];					\
+	X12 += ks[((s) + 12) % 17];					\
+	X13 += ks[((s) + 13) % 17] + ts[((s) + 0) % 3];		\
+	X14 += ks[((s) + 14) % 17] + ts[((s) + 1) % 3];		\
+	X15 += ks[((s) + 15) % 17] + (s);
+
+#define R1024_8_rounds(R)						\
+	Round1024(00, 01, 02, 03, 04, 05, 06, 07, 08, 09, 10, 11, 12, 13, 14, 15, R1024_0) \
+	Round1024(00, 09, 02, 13, 06, 11, 04, 15, 10, 07, 12, 03, 14, 05, 08, 01, R1024_1) \
+	Round1024(00, 07, 02, 05, 04, 03, 06, 01, 12, 15, 14, 13, 08, 11, 10, 09, R1024_2) \
+	Round1024(00, 15, 02, 11, 06, 13, 04, 09, 14, 01, 08, 05, 10, 03, 12, 07, R1024_3) \
+	I1024(2 * (R) + 1)						\
+	Round1024(00, 01, 02, 03, 04, 05, 06, 07, 08, 09, 10, 11, 12, 13, 14, 15, R1024_4) \
+	Round1024(00, 09, 02, 13, 06, 11, 04, 15, 10, 07, 12, 03, 14, 05, 08, 01, R1024_5) \
+	Round1024(00, 07, 02, 05, 04, 03, 06, 01, 12, 15, 14, 13, 08, 11, 10, 09, R1024_6) \
+	Round1024(00, 15, 02, 11, 06, 13, 04, 09, 14, 01, 08, 05, 10, 03, 12, 07, R1024_7) \
+	I1024(2 * (R) + 2)
+
+void Skein1024_Process_Block_scalar(Skein1024_Ctxt_t * ctx,
+				    const u08b_t * blkPtr, size_t blkCnt,
+				    size_t byteCntAdd)
+{	/* do it in C, with 17 words of key schedule and 16 of state */
+	u64b_t ks[SKEIN1024_STATE_WORDS + 1];	/* key schedule */
+	u64b_t ts[3];		/* tweak schedule */
+	u64b_t w[SKEIN1024_STATE_WORDS];	/* local copy of input block */
+	u64b_t X00, X01, X02, X03, X04, X05, X06, X07;	/* local copy of the state */
+	u64b_t X08, X09, X10, X11, X12, X13, X14, X15;
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	X00 = ctx->X[0];
+	X01 = ctx->X[1];
+	X02 = ctx->X[2];
+	X03 = ctx->X[3];
+	X04 = ctx->X[4];
+	X05 = ctx->X[5];
+	X06 = ctx->X[6];
+	X07 = ctx->X[7];
+	X08 = ctx->X[8];
+	X09 = ctx->X[9];
+	X10 = ctx->X[10];
+	X11 = ctx->X[11];
+	X12 = ctx->X[12];
+	X13 = ctx->X[13];
+	X14 = ctx->X[14];
+	X15 = ctx->X[15];
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* precompute the key schedule for this block */
+		ks[0] = X00;
+		ks[1] = X01;
+		ks[2] = X02;
+		ks[3] = X03;
+		ks[4] = X04;
+		ks[5] = X05;
+		ks[6] = X06;
+		ks[7] = X07;
+		ks[8] = X08;
+		ks[9] = X09;
+		ks[10] = X10;
+		ks[11] = X11;
+		ks[12] = X12;
+		ks[13] = X13;
+		ks[14] = X14;
+		ks[15] = X15;
+		ks[16] = X00 ^ X01 ^ X02 ^ X03 ^ X04 ^ X05 ^ X06 ^ X07 ^
+		    X08 ^ X09 ^ X10 ^ X11 ^ X12 ^ X13 ^ X14 ^ X15 ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		Skein_Get64_LSB_First(w, blkPtr, SKEIN1024_STATE_WORDS);	/* get input block in little-endian format */
+
+		X00 = w[0] + ks[0];	/* do the first full key injection */
+		X01 = w[1] + ks[1];
+		X02 = w[2] + ks[2];
+		X03 = w[3] + ks[3];
+		X04 = w[4] + ks[4];
+		X05 = w[5] + ks[5];
+		X06 = w[6] + ks[6];
+		X07 = w[7] + ks[7];
+		X08 = w[8] + ks[8];
+		X09 = w[9] + ks[9];
+		X10 = w[10] + ks[10];
+		X11 = w[11] + ks[11];
+		X12 = w[12] + ks[12];
+		X13 = w[13] + ks[13] + ts[0];
+		X14 = w[14] + ks[14] + ts[1];
+		X15 = w[15] + ks[15];
+
+		R1024_8_rounds(0)
+		R1024_8_rounds(1)
+		R1024_8_rounds(2)
+		R1024_8_rounds(3)
+		R1024_8_rounds(4)
+#if SKEIN1024_ROUNDS_TOTAL > 40
+		R1024_8_rounds(5)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 48
+		R1024_8_rounds(6)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 56
+		R1024_8_rounds(7)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 64
+		R1024_8_rounds(8)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 72
+		R1024_8_rounds(9)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 80
+		R1024_8_rounds(10)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 88
+		R1024_8_rounds(11)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 96
+		R1024_8_rounds(12)
+#endif
+#if SKEIN1024_ROUNDS_TOTAL > 104
+		R1024_8_rounds(13)
+#endif
+
+		/* do the final "feedforward" xor */
+		X00 ^= w[0];
+		X01 ^= w[1];
+		X02 ^= w[2];
+		X03 ^= w[3];
+		X04 ^= w[4];
+		X05 ^= w[5];
+		X06 ^= w[6];
+		X07 ^= w[7];
+		X08 ^= w[8];
+		X09 ^= w[9];
+		X10 ^= w[10];
+		X11 ^= w[11];
+		X12 ^= w[12];
+		X13 ^= w[13];
+		X14 ^= w[14];
+		X15 ^= w[15];
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN1024_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	ctx->X[0] = X00;
+	ctx->X[1] = X01;
+	ctx->X[2] = X02;
+	ctx->X[3] = X03;
+	ctx->X[4] = X04;
+	ctx->X[5] = X05;
+	ctx->X[6] = X06;
+	ctx->X[7] = X07;
+	ctx->X[8] = X08;
+	ctx->X[9] = X09;
+	ctx->X[10] = X10;
+	ctx->X[11] = X11;
+	ctx->X[12] = X12;
+	ctx->X[13] = X13;
+	ctx->X[14] = X14;
+	ctx->X[15] = X15;
+}
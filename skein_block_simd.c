@@ -0,0 +1,874 @@
+/***********************************************************************
+**
+** Implementation of the Skein block functions for SSE2, AVX2 and NEON.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+/* About the SSE2/AVX2/NEON version
+ *
+ * Like VSX, these have native 64 bit vector additions (paddq, vaddq_u64),
+ * so the single message kernels are the VSX code (which uses the word order
+ * of the G4 version, see the comment in skein_block.c) written with the GCC
+ * vector extensions. The compiler turns them into SSE2, AVX2 or NEON code,
+ * depending on the target flags. The one difference between the targets is
+ * the rotation: AVX2 (vpsllvq) and NEON (ushl) shift each element by its
+ * own count, SSE2 only by one count for both, so it rotates twice.
+ *
+ * The multi-message kernels keep word i of all lanes in one vector, so the
+ * operations (and rotation counts) of all lanes are the same and no words
+ * have to be permuted at all. With AVX2 the four lanes of Skein_512 fill a
+ * 256 bit register.
+ *
+ * This file is compiled once per instruction set, SKEIN_SIMD is the suffix
+ * of the function names (sse2, avx2 or neon). Only the kernels that the CPU
+ * supports are called, and on x86_64 only where they beat the scalar code
+ * (see skein_kernel.c). For AVX2 that is only Skein_512 x4, so the AVX2
+ * build only has that one.
+ */
+
+#include <string.h>
+#include "skein.h"
+#include "skein_kernel.h"
+
+#ifndef SKEIN_SIMD
+#if defined(__AVX2__)
+#define SKEIN_SIMD avx2
+#elif defined(__SSE2__)
+#define SKEIN_SIMD sse2
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define SKEIN_SIMD neon
+#else
+#error "No vector instruction set for skein_block_simd.c"
+#endif
+#endif
+
+#if defined(__AVX2__)
+#define SKEIN_SIMD_X4_ONLY 1	/* the rest of avx2 is the scalar code */
+#else
+#define SKEIN_SIMD_X4_ONLY 0
+#endif
+
+/* f is pasted before it could expand to the kernel table entry */
+#define SIMD_FN__(f, s)	f##s
+#define SIMD_FN_(f, s)	SIMD_FN__(f, s)
+#define SIMD_FN(f)	SIMD_FN_(f##_, SKEIN_SIMD)
+
+typedef u64b_t v2u64 __attribute__((vector_size(16)));
+typedef u64b_t v4u64 __attribute__((vector_size(32)));
+
+#define simd_add(a, b)		((a) + (b))
+#define simd_xor(a, b)		((a) ^ (b))
+
+/* doubleword permutations (the same as perm_load_upper etc. in skein_block.c) */
+#define simd_swap(a)		__builtin_shuffle(a, (v2u64) {1, 0})
+#define simd_upper(a, b)	__builtin_shuffle(a, b, (v2u64) {0, 2})
+#define simd_lower(a, b)	__builtin_shuffle(a, b, (v2u64) {1, 3})
+#define simd_upper_lower(a, b)	__builtin_shuffle(a, b, (v2u64) {0, 3})
+#define simd_sld8(a, b)		__builtin_shuffle(a, b, (v2u64) {1, 2})
+
+#define RotL_64(x, N)	(((x) << (N)) | ((x) >> (64 - (N))))
+
+/* Two independent 64bit left rotations. */
+#if defined(__AVX2__) || defined(__ARM_NEON) || defined(__aarch64__)
+#define simd_rotl64(input, rot_a, rot_b)				\
+	input = (input << ((v2u64) {rot_a, rot_b})) |			\
+		(input >> ((v2u64) {64 - (rot_a), 64 - (rot_b)}))
+#else
+#define simd_rotl64(input, rot_a, rot_b)				\
+	input = __builtin_shuffle(RotL_64(input, rot_a), RotL_64(input, rot_b), \
+				  (v2u64) {0, 3})
+#endif
+
+/* (unaligned) loads and stores of 16/32 bytes */
+#define simd_load(off, addr)						\
+	({ v2u64 _v; memcpy(&_v, (const u08b_t *) (addr) + (off), 16); _v; })
+#define simd_store(v, off, addr)					\
+	do { v2u64 _v = (v); memcpy((u08b_t *) (addr) + (off), &_v, 16); } while (0)
+#define simd_load4(off, addr)						\
+	({ v4u64 _v; memcpy(&_v, (const u08b_t *) (addr) + (off), 32); _v; })
+#define simd_store4(v, off, addr)					\
+	do { v4u64 _v = (v); memcpy((u08b_t *) (addr) + (off), &_v, 32); } while (0)
+
+/* Load two/four little endian words of the input block. */
+#if SKEIN_NEED_SWAP
+typedef u08b_t v16u08 __attribute__((vector_size(16)));
+typedef u08b_t v32u08 __attribute__((vector_size(32)));
+
+#define simd_load64(off, addr)						\
+	((v2u64) __builtin_shuffle((v16u08) simd_load(off, addr),	\
+				   (v16u08) {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}))
+#define simd_load64_4(off, addr)					\
+	((v4u64) __builtin_shuffle((v32u08) simd_load4(off, addr),	\
+				   (v32u08) {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, \
+					     23, 22, 21, 20, 19, 18, 17, 16, 31, 30, 29, 28, 27, 26, 25, 24}))
+#else
+#define simd_load64(off, addr)		simd_load(off, addr)
+#define simd_load64_4(off, addr)	simd_load4(off, addr)
+#endif
+
+#if !SKEIN_SIMD_X4_ONLY
+#define InjectKey_256_simd(r)						\
+	X0 = simd_add(X0, ((v2u64) {ks[((r)+0) % (4+1)],		\
+				     ks[((r)+2) % (4+1)] + ts[((r)+1) % 3]})); \
+	X1 = simd_add(X1, ((v2u64) {ks[((r)+1) % (4+1)] + ts[((r)+0) % 3], \
+				     ks[((r)+3) % (4+1)] + (r)}));
+
+void SIMD_FN(Skein_256_Process_Block) (Skein_256_Ctxt_t * ctx,
+				       const u08b_t * blkPtr, size_t blkCnt,
+				       size_t byteCntAdd)
+{	/* do it in C with vectors! */
+	size_t r;
+	u64b_t ks[4 + 1] __attribute__((aligned(16)));
+	u64b_t ts[3];
+
+	v2u64 X0, X1;
+	v2u64 w0, w1;
+	v2u64 tmp_vec0, tmp_vec1;
+
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	tmp_vec0 = simd_load(0x00, ctx->X);
+	tmp_vec1 = simd_load(0x10, ctx->X);
+
+	/* ALTIVEC ORDER */
+	X0 = simd_upper(tmp_vec0, tmp_vec1);
+	X1 = simd_lower(tmp_vec0, tmp_vec1);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* Store ks in normal order. */
+		tmp_vec0 = simd_upper(X0, X1);
+		tmp_vec1 = simd_lower(X0, X1);
+		simd_store(tmp_vec0, 0x00, ks);
+		simd_store(tmp_vec1, 0x10, ks);
+
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec1);
+		ks[4] = tmp_vec0[0] ^ tmp_vec0[1] ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		/* load input block into w registers */
+		tmp_vec0 = simd_load64(0x00, blkPtr);
+		tmp_vec1 = simd_load64(0x10, blkPtr);
+		w0 = simd_upper(tmp_vec0, tmp_vec1);
+		w1 = simd_lower(tmp_vec0, tmp_vec1);
+
+		/* first key injection (it adds round number 0) */
+		X0 = w0;
+		X1 = w1;
+		InjectKey_256_simd(0);
+
+		for (r = 1; r <= SKEIN_256_ROUNDS_TOTAL / 8; r++) {	/* unroll 8 rounds */
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_0_0, R_256_0_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_1_0, R_256_1_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_2_0, R_256_2_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_3_0, R_256_3_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			InjectKey_256_simd(2 * r - 1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_4_0, R_256_4_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_5_0, R_256_5_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_6_0, R_256_6_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			X0 = simd_add(X0, X1);
+			simd_rotl64(X1, R_256_7_0, R_256_7_1);
+			X1 = simd_xor(X1, X0);
+			X1 = simd_swap(X1);
+
+			InjectKey_256_simd(2 * r);
+		}
+		/* do the final "feedforward" xor */
+		X0 = simd_xor(X0, w0);
+		X1 = simd_xor(X1, w1);
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN_256_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	/* UNDO ALTIVEC ORDER */
+	simd_store(simd_upper(X0, X1), 0x00, ctx->X);
+	simd_store(simd_lower(X0, X1), 0x10, ctx->X);
+}
+
+#undef InjectKey_256_simd
+
+#define InjectKey_512_simd(r)						\
+	X0 = simd_add(X0, ((v2u64) {ks[((r)+0) % (8+1)],		\
+				     ks[((r)+2) % (8+1)]}));		\
+	X1 = simd_add(X1, ((v2u64) {ks[((r)+4) % (8+1)],		\
+				     ks[((r)+6) % (8+1)] + ts[((r)+1) % 3]})); \
+	X2 = simd_add(X2, ((v2u64) {ks[((r)+1) % (8+1)],		\
+				     ks[((r)+3) % (8+1)]}));		\
+	X3 = simd_add(X3, ((v2u64) {ks[((r)+5) % (8+1)] + ts[((r)+0) % 3], \
+				     ks[((r)+7) % (8+1)] + (r)}));
+
+void SIMD_FN(Skein_512_Process_Block) (Skein_512_Ctxt_t * ctx,
+				       const u08b_t * blkPtr, size_t blkCnt,
+				       size_t byteCntAdd)
+{	/* do it in C with vectors! */
+	size_t r;
+	u64b_t ks[8 + 1] __attribute__((aligned(16)));
+	u64b_t ts[3];
+
+	v2u64 X0, X1, X2, X3;
+	v2u64 w0, w1, w2, w3;
+	v2u64 tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;
+
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	tmp_vec0 = simd_load(0x00, ctx->X);
+	tmp_vec1 = simd_load(0x10, ctx->X);
+	tmp_vec2 = simd_load(0x20, ctx->X);
+	tmp_vec3 = simd_load(0x30, ctx->X);
+
+	/* ALTIVEC ORDER */
+	X0 = simd_upper(tmp_vec0, tmp_vec1);
+	X1 = simd_upper(tmp_vec2, tmp_vec3);
+	X2 = simd_lower(tmp_vec0, tmp_vec1);
+	X3 = simd_lower(tmp_vec2, tmp_vec3);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* Store ks in normal order. */
+		tmp_vec0 = simd_upper(X0, X2);
+		tmp_vec1 = simd_lower(X0, X2);
+		tmp_vec2 = simd_upper(X1, X3);
+		tmp_vec3 = simd_lower(X1, X3);
+		simd_store(tmp_vec0, 0x00, ks);
+		simd_store(tmp_vec1, 0x10, ks);
+		simd_store(tmp_vec2, 0x20, ks);
+		simd_store(tmp_vec3, 0x30, ks);
+
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec1);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec2);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec3);
+		ks[8] = tmp_vec0[0] ^ tmp_vec0[1] ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		/* load input block into w registers */
+		tmp_vec0 = simd_load64(0x00, blkPtr);
+		tmp_vec1 = simd_load64(0x10, blkPtr);
+		tmp_vec2 = simd_load64(0x20, blkPtr);
+		tmp_vec3 = simd_load64(0x30, blkPtr);
+		w0 = simd_upper(tmp_vec0, tmp_vec1);
+		w1 = simd_upper(tmp_vec2, tmp_vec3);
+		w2 = simd_lower(tmp_vec0, tmp_vec1);
+		w3 = simd_lower(tmp_vec2, tmp_vec3);
+
+		/* first key injection (it adds round number 0) */
+		X0 = w0;
+		X1 = w1;
+		X2 = w2;
+		X3 = w3;
+		InjectKey_512_simd(0);
+
+		for (r = 1; r <= SKEIN_512_ROUNDS_TOTAL / 8; r++) { /* unroll 8 rounds */
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_0_0, R_512_0_1);
+			simd_rotl64(X3, R_512_0_2, R_512_0_3);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			X2 = simd_swap(X2);
+			X3 = simd_swap(X3);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_1_3, R_512_1_0);
+			simd_rotl64(X3, R_512_1_1, R_512_1_2);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = simd_swap(X3);
+			X3 = simd_swap(tmp_vec0);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_2_2, R_512_2_3);
+			simd_rotl64(X3, R_512_2_0, R_512_2_1);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			X2 = simd_swap(X2);
+			X3 = simd_swap(X3);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_3_1, R_512_3_2);
+			simd_rotl64(X3, R_512_3_3, R_512_3_0);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = simd_swap(X3);
+			X3 = simd_swap(tmp_vec0);
+
+			InjectKey_512_simd(2 * r - 1);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_4_0, R_512_4_1);
+			simd_rotl64(X3, R_512_4_2, R_512_4_3);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			X2 = simd_swap(X2);
+			X3 = simd_swap(X3);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_5_3, R_512_5_0);
+			simd_rotl64(X3, R_512_5_1, R_512_5_2);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = simd_swap(X3);
+			X3 = simd_swap(tmp_vec0);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_6_2, R_512_6_3);
+			simd_rotl64(X3, R_512_6_0, R_512_6_1);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			X2 = simd_swap(X2);
+			X3 = simd_swap(X3);
+
+			X0 = simd_add(X0, X2);
+			X1 = simd_add(X1, X3);
+			simd_rotl64(X2, R_512_7_1, R_512_7_2);
+			simd_rotl64(X3, R_512_7_3, R_512_7_0);
+			X2 = simd_xor(X2, X0);
+			X3 = simd_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = simd_swap(X3);
+			X3 = simd_swap(tmp_vec0);
+
+			InjectKey_512_simd(2 * r);
+		}
+
+		/* do the final "feedforward" xor */
+		X0 = simd_xor(X0, w0);
+		X1 = simd_xor(X1, w1);
+		X2 = simd_xor(X2, w2);
+		X3 = simd_xor(X3, w3);
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN_512_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	/* UNDO ALTIVEC ORDER */
+	simd_store(simd_upper(X0, X2), 0x00, ctx->X);
+	simd_store(simd_lower(X0, X2), 0x10, ctx->X);
+	simd_store(simd_upper(X1, X3), 0x20, ctx->X);
+	simd_store(simd_lower(X1, X3), 0x30, ctx->X);
+}
+
+#undef InjectKey_512_simd
+
+#define InjectKey_1024_simd(r)						\
+	X0 = simd_add(X0, ((v2u64) {ks[((r)+ 0) % (16+1)],		\
+				     ks[((r)+ 2) % (16+1)]}));		\
+	X1 = simd_add(X1, ((v2u64) {ks[((r)+ 4) % (16+1)],		\
+				     ks[((r)+ 6) % (16+1)]}));		\
+	X2 = simd_add(X2, ((v2u64) {ks[((r)+ 8) % (16+1)],		\
+				     ks[((r)+10) % (16+1)]}));		\
+	X3 = simd_add(X3, ((v2u64) {ks[((r)+12) % (16+1)],		\
+				     ks[((r)+14) % (16+1)] + ts[((r)+1) % 3]})); \
+	X4 = simd_add(X4, ((v2u64) {ks[((r)+ 1) % (16+1)],		\
+				     ks[((r)+ 3) % (16+1)]}));		\
+	X5 = simd_add(X5, ((v2u64) {ks[((r)+ 5) % (16+1)],		\
+				     ks[((r)+ 7) % (16+1)]}));		\
+	X6 = simd_add(X6, ((v2u64) {ks[((r)+ 9) % (16+1)],		\
+				     ks[((r)+11) % (16+1)]}));		\
+	X7 = simd_add(X7, ((v2u64) {ks[((r)+13) % (16+1)] + ts[((r)+0) % 3], \
+				     ks[((r)+15) % (16+1)] + (r)}));
+
+/* one round of Skein1024: add, rotate, xor (the permutation follows) */
+#define Round_1024_simd(rot0, rot1, rot2, rot3, rot4, rot5, rot6, rot7)	\
+	X0 = simd_add(X0, X4);						\
+	X1 = simd_add(X1, X5);						\
+	X2 = simd_add(X2, X6);						\
+	X3 = simd_add(X3, X7);						\
+	simd_rotl64(X4, rot0, rot1);					\
+	simd_rotl64(X5, rot2, rot3);					\
+	simd_rotl64(X6, rot4, rot5);					\
+	simd_rotl64(X7, rot6, rot7);					\
+	X4 = simd_xor(X4, X0);						\
+	X5 = simd_xor(X5, X1);						\
+	X6 = simd_xor(X6, X2);						\
+	X7 = simd_xor(X7, X3);
+
+void SIMD_FN(Skein1024_Process_Block) (Skein1024_Ctxt_t * ctx,
+				       const u08b_t * blkPtr, size_t blkCnt,
+				       size_t byteCntAdd)
+{	/* do it in C with vectors! */
+	size_t r;
+	u64b_t ks[16 + 1] __attribute__((aligned(16)));
+	u64b_t ts[3];
+
+	v2u64 X0, X1, X2, X3, X4, X5, X6, X7;
+	v2u64 w0, w1, w2, w3, w4, w5, w6, w7;
+	v2u64 tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;
+	v2u64 tmp_vec4, tmp_vec5, tmp_vec6, tmp_vec7;
+
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	tmp_vec0 = simd_load(0x00, ctx->X);
+	tmp_vec1 = simd_load(0x10, ctx->X);
+	tmp_vec2 = simd_load(0x20, ctx->X);
+	tmp_vec3 = simd_load(0x30, ctx->X);
+	tmp_vec4 = simd_load(0x40, ctx->X);
+	tmp_vec5 = simd_load(0x50, ctx->X);
+	tmp_vec6 = simd_load(0x60, ctx->X);
+	tmp_vec7 = simd_load(0x70, ctx->X);
+
+	/* ALTIVEC ORDER */
+	X0 = simd_upper(tmp_vec0, tmp_vec1);
+	X1 = simd_upper(tmp_vec2, tmp_vec3);
+	X2 = simd_upper(tmp_vec4, tmp_vec5);
+	X3 = simd_upper(tmp_vec6, tmp_vec7);
+	X4 = simd_lower(tmp_vec0, tmp_vec1);
+	X5 = simd_lower(tmp_vec2, tmp_vec3);
+	X6 = simd_lower(tmp_vec4, tmp_vec5);
+	X7 = simd_lower(tmp_vec6, tmp_vec7);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* Store ks in normal order. */
+		tmp_vec0 = simd_upper(X0, X4);
+		tmp_vec1 = simd_lower(X0, X4);
+		tmp_vec2 = simd_upper(X1, X5);
+		tmp_vec3 = simd_lower(X1, X5);
+		tmp_vec4 = simd_upper(X2, X6);
+		tmp_vec5 = simd_lower(X2, X6);
+		tmp_vec6 = simd_upper(X3, X7);
+		tmp_vec7 = simd_lower(X3, X7);
+		simd_store(tmp_vec0, 0x00, ks);
+		simd_store(tmp_vec1, 0x10, ks);
+		simd_store(tmp_vec2, 0x20, ks);
+		simd_store(tmp_vec3, 0x30, ks);
+		simd_store(tmp_vec4, 0x40, ks);
+		simd_store(tmp_vec5, 0x50, ks);
+		simd_store(tmp_vec6, 0x60, ks);
+		simd_store(tmp_vec7, 0x70, ks);
+
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec1);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec2);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec3);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec4);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec5);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec6);
+		tmp_vec0 = simd_xor(tmp_vec0, tmp_vec7);
+		ks[16] = tmp_vec0[0] ^ tmp_vec0[1] ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		/* load input block into w registers */
+		tmp_vec0 = simd_load64(0x00, blkPtr);
+		tmp_vec1 = simd_load64(0x10, blkPtr);
+		tmp_vec2 = simd_load64(0x20, blkPtr);
+		tmp_vec3 = simd_load64(0x30, blkPtr);
+		tmp_vec4 = simd_load64(0x40, blkPtr);
+		tmp_vec5 = simd_load64(0x50, blkPtr);
+		tmp_vec6 = simd_load64(0x60, blkPtr);
+		tmp_vec7 = simd_load64(0x70, blkPtr);
+		w0 = simd_upper(tmp_vec0, tmp_vec1);
+		w1 = simd_upper(tmp_vec2, tmp_vec3);
+		w2 = simd_upper(tmp_vec4, tmp_vec5);
+		w3 = simd_upper(tmp_vec6, tmp_vec7);
+		w4 = simd_lower(tmp_vec0, tmp_vec1);
+		w5 = simd_lower(tmp_vec2, tmp_vec3);
+		w6 = simd_lower(tmp_vec4, tmp_vec5);
+		w7 = simd_lower(tmp_vec6, tmp_vec7);
+
+		/* first key injection (it adds round number 0) */
+		X0 = w0;
+		X1 = w1;
+		X2 = w2;
+		X3 = w3;
+		X4 = w4;
+		X5 = w5;
+		X6 = w6;
+		X7 = w7;
+		InjectKey_1024_simd(0);
+
+		for (r = 1; r <= SKEIN1024_ROUNDS_TOTAL / 8; r++) {	/* unroll 8 rounds */
+			Round_1024_simd(R1024_0_0, R1024_0_1, R1024_0_2, R1024_0_3,
+				       R1024_0_4, R1024_0_5, R1024_0_6, R1024_0_7);
+
+			tmp_vec4 = X4;
+			X4 = simd_upper(X6, X7);
+			tmp_vec5 = X5;
+			X5 = simd_lower(X7, X6);
+			X6 = simd_upper_lower(tmp_vec4, tmp_vec5);
+			X7 = simd_sld8(tmp_vec4, tmp_vec5);
+
+			Round_1024_simd(R1024_1_0, R1024_1_1, R1024_1_3, R1024_1_2,
+				       R1024_1_7, R1024_1_4, R1024_1_5, R1024_1_6);
+
+			tmp_vec4 = X4;
+			X4 = simd_lower(X6, X7);
+			tmp_vec5 = X5;
+			X5 = simd_upper(X7, X6);
+			X6 = simd_sld8(tmp_vec5, tmp_vec4);
+			X7 = simd_upper_lower(tmp_vec5, tmp_vec4);
+
+			Round_1024_simd(R1024_2_0, R1024_2_1, R1024_2_2, R1024_2_3,
+				       R1024_2_6, R1024_2_7, R1024_2_4, R1024_2_5);
+
+			tmp_vec4 = X4;
+			X4 = simd_upper(X7, X6);
+			tmp_vec5 = X5;
+			X5 = simd_lower(X6, X7);
+			X6 = simd_sld8(tmp_vec4, tmp_vec5);
+			X7 = simd_upper_lower(tmp_vec4, tmp_vec5);
+
+			Round_1024_simd(R1024_3_0, R1024_3_1, R1024_3_3, R1024_3_2,
+				       R1024_3_5, R1024_3_6, R1024_3_7, R1024_3_4);
+
+			tmp_vec4 = X4;
+			X4 = simd_lower(X7, X6);
+			tmp_vec5 = X5;
+			X5 = simd_upper(X6, X7);
+			X6 = simd_upper_lower(tmp_vec5, tmp_vec4);
+			X7 = simd_sld8(tmp_vec5, tmp_vec4);
+
+			InjectKey_1024_simd(2 * r - 1);
+
+			Round_1024_simd(R1024_4_0, R1024_4_1, R1024_4_2, R1024_4_3,
+				       R1024_4_4, R1024_4_5, R1024_4_6, R1024_4_7);
+
+			tmp_vec4 = X4;
+			X4 = simd_upper(X6, X7);
+			tmp_vec5 = X5;
+			X5 = simd_lower(X7, X6);
+			X6 = simd_upper_lower(tmp_vec4, tmp_vec5);
+			X7 = simd_sld8(tmp_vec4, tmp_vec5);
+
+			Round_1024_simd(R1024_5_0, R1024_5_1, R1024_5_3, R1024_5_2,
+				       R1024_5_7, R1024_5_4, R1024_5_5, R1024_5_6);
+
+			tmp_vec4 = X4;
+			X4 = simd_lower(X6, X7);
+			tmp_vec5 = X5;
+			X5 = simd_upper(X7, X6);
+			X6 = simd_sld8(tmp_vec5, tmp_vec4);
+			X7 = simd_upper_lower(tmp_vec5, tmp_vec4);
+
+			Round_1024_simd(R1024_6_0, R1024_6_1, R1024_6_2, R1024_6_3,
+				       R1024_6_6, R1024_6_7, R1024_6_4, R1024_6_5);
+
+			tmp_vec4 = X4;
+			X4 = simd_upper(X7, X6);
+			tmp_vec5 = X5;
+			X5 = simd_lower(X6, X7);
+			X6 = simd_sld8(tmp_vec4, tmp_vec5);
+			X7 = simd_upper_lower(tmp_vec4, tmp_vec5);
+
+			Round_1024_simd(R1024_7_0, R1024_7_1, R1024_7_3, R1024_7_2,
+				       R1024_7_5, R1024_7_6, R1024_7_7, R1024_7_4);
+
+			tmp_vec4 = X4;
+			X4 = simd_lower(X7, X6);
+			tmp_vec5 = X5;
+			X5 = simd_upper(X6, X7);
+			X6 = simd_upper_lower(tmp_vec5, tmp_vec4);
+			X7 = simd_sld8(tmp_vec5, tmp_vec4);
+
+			InjectKey_1024_simd(2 * r);
+		}
+		/* do the final "feedforward" xor */
+		X0 = simd_xor(X0, w0);
+		X1 = simd_xor(X1, w1);
+		X2 = simd_xor(X2, w2);
+		X3 = simd_xor(X3, w3);
+		X4 = simd_xor(X4, w4);
+		X5 = simd_xor(X5, w5);
+		X6 = simd_xor(X6, w6);
+		X7 = simd_xor(X7, w7);
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN1024_BLOCK_BYTES;
+	}
+	while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	/* UNDO ALTIVEC ORDER */
+	simd_store(simd_upper(X0, X4), 0x00, ctx->X);
+	simd_store(simd_lower(X0, X4), 0x10, ctx->X);
+	simd_store(simd_upper(X1, X5), 0x20, ctx->X);
+	simd_store(simd_lower(X1, X5), 0x30, ctx->X);
+	simd_store(simd_upper(X2, X6), 0x40, ctx->X);
+	simd_store(simd_lower(X2, X6), 0x50, ctx->X);
+	simd_store(simd_upper(X3, X7), 0x60, ctx->X);
+	simd_store(simd_lower(X3, X7), 0x70, ctx->X);
+}
+
+#undef InjectKey_1024_simd
+#undef Round_1024_simd
+#endif				/* !SKEIN_SIMD_X4_ONLY */
+
+/*****************************************************************
+** Multi-message kernels: word i of all lanes in one vector
+*****************************************************************/
+
+/* one round of all lanes (the same as Round512 in skein_block_scalar.c) */
+#define Round512_lanes(p0, p1, p2, p3, p4, p5, p6, p7, ROT)		\
+	X[p0] += X[p1]; X[p1] = RotL_64(X[p1], ROT##_0); X[p1] ^= X[p0];	\
+	X[p2] += X[p3]; X[p3] = RotL_64(X[p3], ROT##_1); X[p3] ^= X[p2];	\
+	X[p4] += X[p5]; X[p5] = RotL_64(X[p5], ROT##_2); X[p5] ^= X[p4];	\
+	X[p6] += X[p7]; X[p7] = RotL_64(X[p7], ROT##_3); X[p7] ^= X[p6];
+
+/* key injection number s, ks[] and ts[] hold two copies of the schedules */
+#define I512_lanes(s)							\
+	k = ks + (s) % 9;						\
+	t = ts + (s) % 3;						\
+	X[0] += k[0];							\
+	X[1] += k[1];							\
+	X[2] += k[2];							\
+	X[3] += k[3];							\
+	X[4] += k[4];							\
+	X[5] += k[5] + t[0];						\
+	X[6] += k[6] + t[1];						\
+	X[7] += k[7] + (u64b_t) (s);
+
+/* words 0..7 of two lanes to/from vectors (the transpose is its own inverse) */
+#define simd_transpose_x2(a, b)						\
+	do {								\
+		v2u64 _t = __builtin_shuffle(a, b, (v2u64) {0, 2});	\
+		b = __builtin_shuffle(a, b, (v2u64) {1, 3});		\
+		a = _t;							\
+	} while (0)
+
+#define simd_transpose_x4(a, b, c, d)					\
+	do {								\
+		v4u64 _t0 = __builtin_shuffle(a, b, (v4u64) {0, 4, 2, 6});	\
+		v4u64 _t1 = __builtin_shuffle(a, b, (v4u64) {1, 5, 3, 7});	\
+		v4u64 _t2 = __builtin_shuffle(c, d, (v4u64) {0, 4, 2, 6});	\
+		v4u64 _t3 = __builtin_shuffle(c, d, (v4u64) {1, 5, 3, 7});	\
+		a = __builtin_shuffle(_t0, _t2, (v4u64) {0, 1, 4, 5});	\
+		b = __builtin_shuffle(_t1, _t3, (v4u64) {0, 1, 4, 5});	\
+		c = __builtin_shuffle(_t0, _t2, (v4u64) {2, 3, 6, 7});	\
+		d = __builtin_shuffle(_t1, _t3, (v4u64) {2, 3, 6, 7});	\
+	} while (0)
+
+static inline __attribute__((always_inline))
+void simd_get_x2(v2u64 V[8], const u08b_t * p0, const u08b_t * p1, const int msg)
+{
+	int j;
+
+	for (j = 0; j < 8; j += 2) {
+		V[j] = msg ? simd_load64(8 * j, p0) : simd_load(8 * j, p0);
+		V[j + 1] = msg ? simd_load64(8 * j, p1) : simd_load(8 * j, p1);
+		simd_transpose_x2(V[j], V[j + 1]);
+	}
+}
+
+static inline __attribute__((always_inline))
+void simd_put_x2(u64b_t * p0, u64b_t * p1, const v2u64 V[8])
+{
+	v2u64 a, b;
+	int j;
+
+	for (j = 0; j < 8; j += 2) {
+		a = V[j];
+		b = V[j + 1];
+		simd_transpose_x2(a, b);
+		simd_store(a, 8 * j, p0);
+		simd_store(b, 8 * j, p1);
+	}
+}
+
+static inline __attribute__((always_inline))
+void simd_get_x4(v4u64 V[8], const u08b_t * p0, const u08b_t * p1,
+		 const u08b_t * p2, const u08b_t * p3, const int msg)
+{
+	int j;
+
+	for (j = 0; j < 8; j += 4) {
+		V[j] = msg ? simd_load64_4(8 * j, p0) : simd_load4(8 * j, p0);
+		V[j + 1] = msg ? simd_load64_4(8 * j, p1) : simd_load4(8 * j, p1);
+		V[j + 2] = msg ? simd_load64_4(8 * j, p2) : simd_load4(8 * j, p2);
+		V[j + 3] = msg ? simd_load64_4(8 * j, p3) : simd_load4(8 * j, p3);
+		simd_transpose_x4(V[j], V[j + 1], V[j + 2], V[j + 3]);
+	}
+}
+
+static inline __attribute__((always_inline))
+void simd_put_x4(u64b_t * p0, u64b_t * p1, u64b_t * p2, u64b_t * p3,
+		 const v4u64 V[8])
+{
+	v4u64 a, b, c, d;
+	int j;
+
+	for (j = 0; j < 8; j += 4) {
+		a = V[j];
+		b = V[j + 1];
+		c = V[j + 2];
+		d = V[j + 3];
+		simd_transpose_x4(a, b, c, d);
+		simd_store4(a, 8 * j, p0);
+		simd_store4(b, 8 * j, p1);
+		simd_store4(c, 8 * j, p2);
+		simd_store4(d, 8 * j, p3);
+	}
+}
+
+/*
+ * The block loop, the same for both lane counts. vlane is the vector type,
+ * get_block/put_state move the words of all lanes in and out.
+ */
+#define Skein_512_lanes_body(LANES, vlane, get_state, get_block, put_state) \
+	vlane ks[2 * 9], ts[2 * 3];	/* two copies: no modulo on the index */ \
+	vlane X[8], w[8], add;						\
+	const vlane *k, *t;						\
+	const u08b_t *blk[LANES];					\
+	size_t r, l;							\
+	int i;								\
+									\
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */ \
+									\
+	for (l = 0; l < LANES; l++) {					\
+		blk[l] = blkPtr[l];					\
+		add[l] = byteCntAdd[l];					\
+		ts[0][l] = ctx[l]->h.T[0];	/* the tweaks stay in ts for the whole loop */ \
+		ts[1][l] = ctx[l]->h.T[1];				\
+	}								\
+	get_state;							\
+									\
+	do {								\
+		/* this implementation only supports 2**64 input bytes (no carry out here) */ \
+		ts[0] += add;	/* update processed length */		\
+		ts[2] = ts[0] ^ ts[1];					\
+		ts[3] = ts[0];						\
+		ts[4] = ts[1];						\
+		ts[5] = ts[2];						\
+									\
+		/* precompute the key schedule for this block */	\
+		ks[8] = X[0] ^ SKEIN_KS_PARITY;				\
+		for (i = 1; i < 8; i++)					\
+			ks[8] ^= X[i];					\
+		for (i = 0; i < 8; i++) {				\
+			ks[i] = X[i];					\
+			ks[9 + i] = X[i];				\
+		}							\
+		ks[17] = ks[8];						\
+									\
+		get_block;	/* get input block in little-endian format */ \
+									\
+		for (i = 0; i < 8; i++)	/* do the first full key injection */ \
+			X[i] = w[i] + ks[i];				\
+		X[5] += ts[0];						\
+		X[6] += ts[1];						\
+									\
+		for (r = 1; r <= SKEIN_512_ROUNDS_TOTAL / 8; r++) {	/* unroll 8 rounds */ \
+			Round512_lanes(0, 1, 2, 3, 4, 5, 6, 7, R_512_0)	\
+			Round512_lanes(2, 1, 4, 7, 6, 5, 0, 3, R_512_1)	\
+			Round512_lanes(4, 1, 6, 3, 0, 5, 2, 7, R_512_2)	\
+			Round512_lanes(6, 1, 0, 7, 2, 5, 4, 3, R_512_3)	\
+			I512_lanes(2 * r - 1)				\
+			Round512_lanes(0, 1, 2, 3, 4, 5, 6, 7, R_512_4)	\
+			Round512_lanes(2, 1, 4, 7, 6, 5, 0, 3, R_512_5)	\
+			Round512_lanes(4, 1, 6, 3, 0, 5, 2, 7, R_512_6)	\
+			Round512_lanes(6, 1, 0, 7, 2, 5, 4, 3, R_512_7)	\
+			I512_lanes(2 * r)				\
+		}							\
+									\
+		/* do the final "feedforward" xor */			\
+		for (i = 0; i < 8; i++)					\
+			X[i] ^= w[i];					\
+									\
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */ \
+		for (l = 0; l < LANES; l++)				\
+			blk[l] += SKEIN_512_BLOCK_BYTES;		\
+	} while (--blkCnt);						\
+									\
+	for (l = 0; l < LANES; l++) {					\
+		ctx[l]->h.T[0] = ts[0][l];				\
+		ctx[l]->h.T[1] = ts[1][l];				\
+	}								\
+	put_state;
+
+#if !SKEIN_SIMD_X4_ONLY
+void SIMD_FN(Skein_512_Process_Block_x2) (Skein_512_Ctxt_t * ctx[2],
+					  const u08b_t * blkPtr[2], size_t blkCnt,
+					  const size_t byteCntAdd[2])
+{	/* two independent contexts at once */
+	Skein_512_lanes_body(2, v2u64,
+			     simd_get_x2(X, (u08b_t *) ctx[0]->X, (u08b_t *) ctx[1]->X, 0),
+			     simd_get_x2(w, blk[0], blk[1], 1),
+			     simd_put_x2(ctx[0]->X, ctx[1]->X, X))
+}
+#endif
+
+void SIMD_FN(Skein_512_Process_Block_x4) (Skein_512_Ctxt_t * ctx[4],
+					  const u08b_t * blkPtr[4], size_t blkCnt,
+					  const size_t byteCntAdd[4])
+{	/* four independent contexts at once */
+	Skein_512_lanes_body(4, v4u64,
+			     simd_get_x4(X, (u08b_t *) ctx[0]->X, (u08b_t *) ctx[1]->X,
+					 (u08b_t *) ctx[2]->X, (u08b_t *) ctx[3]->X, 0),
+			     simd_get_x4(w, blk[0], blk[1], blk[2], blk[3], 1),
+			     simd_put_x4(ctx[0]->X, ctx[1]->X, ctx[2]->X, ctx[3]->X, X))
+}
@@ -0,0 +1,658 @@
+/***********************************************************************
+**
+** Implementation of the Skein block functions for VSX (POWER8 and later).
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+/* About the VSX version
+ *
+ * ISA 2.07 (POWER8) added native 64 bit vector additions (vaddudm) and
+ * rotations (vrld). So neither the carry emulation of vec_add64 nor the
+ * permute based vec_rotl64a/b of the G4 code are needed anymore, each of
+ * them is a single instruction here.
+ *
+ * Otherwise the code uses the same word order as the G4 version in
+ * skein_block.c (see the comment there), and the same permutations between
+ * the rounds. They are written as __builtin_shuffle on the doublewords, so
+ * that the code works on big endian and little endian (ppc64le) systems.
+ *
+ * This file needs to be compiled with -mcpu=power8 -mvsx. It is only called
+ * if the CPU supports ISA 2.07 (see skein_kernel.c).
+ */
+
+#include <string.h>
+#include "skein.h"
+#include "skein_kernel.h"
+
+#include <altivec.h>
+
+typedef vector unsigned long long vec_u64;
+
+/* doubleword permutations (the same as perm_load_upper etc. in skein_block.c) */
+#define vsx_swap(a)		__builtin_shuffle(a, (vec_u64) {1, 0})
+#define vsx_upper(a, b)		__builtin_shuffle(a, b, (vec_u64) {0, 2})
+#define vsx_lower(a, b)		__builtin_shuffle(a, b, (vec_u64) {1, 3})
+#define vsx_upper_lower(a, b)	__builtin_shuffle(a, b, (vec_u64) {0, 3})
+#define vsx_sld8(a, b)		__builtin_shuffle(a, b, (vec_u64) {1, 2})
+
+/* Two independent 64bit left rotations, a single vrld. */
+#define vsx_rotl64(input, rot_a, rot_b)	\
+	input = vec_rl(input, ((vec_u64) {rot_a, rot_b}))
+
+/* Load two (unaligned) little endian words of the input block. */
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define vsx_vectors
+
+#define vsx_load64(off, addr)	vec_xl(off, (unsigned long long *) (addr))
+#else
+#define vsx_vectors							\
+	vector unsigned char perm_bswap64 = {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8};
+
+#define vsx_load64(off, addr)						\
+	((vec_u64) vec_perm((vector unsigned char) vec_xl(off, (unsigned long long *) (addr)), \
+			    (vector unsigned char) vec_xl(off, (unsigned long long *) (addr)), \
+			    perm_bswap64))
+#endif
+
+/* dcbt hints only, dst does nothing on these CPUs (see Skein_Prefetch) */
+#define vsx_prefetch_vars(blkBytes)					\
+	const int pf_dcbt = (Skein_Prefetch.mode == SKEIN_PREFETCH_DCBT);	\
+	const size_t pf_ahead = Skein_Prefetch.distance * (blkBytes);
+
+#define vsx_prefetch(ptr, blkBytes)					\
+	do {								\
+		if (pf_dcbt)						\
+			Skein_Prefetch_Touch((ptr) + pf_ahead, blkBytes);	\
+	} while (0)
+
+#define InjectKey_256_vsx(r)						\
+	X0 = vec_add(X0, ((vec_u64) {ks[((r)+0) % (4+1)],		\
+				     ks[((r)+2) % (4+1)] + ts[((r)+1) % 3]})); \
+	X1 = vec_add(X1, ((vec_u64) {ks[((r)+1) % (4+1)] + ts[((r)+0) % 3], \
+				     ks[((r)+3) % (4+1)] + (r)}));
+
+void Skein_256_Process_Block_vsx(Skein_256_Ctxt_t * ctx, const u08b_t * blkPtr,
+				 size_t blkCnt, size_t byteCntAdd)
+{	/* do it in C with VSX! */
+	size_t r;
+	u64b_t ks[4 + 1] __attribute__((aligned(16)));
+	u64b_t ts[3];
+
+	vec_u64 X0, X1;
+	vec_u64 w0, w1;
+	vec_u64 tmp_vec0, tmp_vec1;
+
+	vsx_vectors
+	vsx_prefetch_vars(SKEIN_256_BLOCK_BYTES)
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	tmp_vec0 = vec_xl(0x00, (unsigned long long *) ctx->X);
+	tmp_vec1 = vec_xl(0x10, (unsigned long long *) ctx->X);
+
+	/* ALTIVEC ORDER */
+	X0 = vsx_upper(tmp_vec0, tmp_vec1);
+	X1 = vsx_lower(tmp_vec0, tmp_vec1);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		vsx_prefetch(blkPtr, SKEIN_256_BLOCK_BYTES);
+
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* Store ks in normal order. */
+		tmp_vec0 = vsx_upper(X0, X1);
+		tmp_vec1 = vsx_lower(X0, X1);
+		vec_xst(tmp_vec0, 0x00, (unsigned long long *) ks);
+		vec_xst(tmp_vec1, 0x10, (unsigned long long *) ks);
+
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec1);
+		ks[4] = tmp_vec0[0] ^ tmp_vec0[1] ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		/* load input block into w registers */
+		tmp_vec0 = vsx_load64(0x00, blkPtr);
+		tmp_vec1 = vsx_load64(0x10, blkPtr);
+		w0 = vsx_upper(tmp_vec0, tmp_vec1);
+		w1 = vsx_lower(tmp_vec0, tmp_vec1);
+
+		/* first key injection (it adds round number 0) */
+		X0 = w0;
+		X1 = w1;
+		InjectKey_256_vsx(0);
+
+		for (r = 1; r <= SKEIN_256_ROUNDS_TOTAL / 8; r++) {	/* unroll 8 rounds */
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_0_0, R_256_0_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_1_0, R_256_1_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_2_0, R_256_2_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_3_0, R_256_3_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			InjectKey_256_vsx(2 * r - 1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_4_0, R_256_4_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_5_0, R_256_5_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_6_0, R_256_6_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			X0 = vec_add(X0, X1);
+			vsx_rotl64(X1, R_256_7_0, R_256_7_1);
+			X1 = vec_xor(X1, X0);
+			X1 = vsx_swap(X1);
+
+			InjectKey_256_vsx(2 * r);
+		}
+		/* do the final "feedforward" xor */
+		X0 = vec_xor(X0, w0);
+		X1 = vec_xor(X1, w1);
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN_256_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	/* UNDO ALTIVEC ORDER */
+	vec_xst(vsx_upper(X0, X1), 0x00, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X0, X1), 0x10, (unsigned long long *) ctx->X);
+}
+
+#undef InjectKey_256_vsx
+
+#define InjectKey_512_vsx(r)						\
+	X0 = vec_add(X0, ((vec_u64) {ks[((r)+0) % (8+1)],		\
+				     ks[((r)+2) % (8+1)]}));		\
+	X1 = vec_add(X1, ((vec_u64) {ks[((r)+4) % (8+1)],		\
+				     ks[((r)+6) % (8+1)] + ts[((r)+1) % 3]})); \
+	X2 = vec_add(X2, ((vec_u64) {ks[((r)+1) % (8+1)],		\
+				     ks[((r)+3) % (8+1)]}));		\
+	X3 = vec_add(X3, ((vec_u64) {ks[((r)+5) % (8+1)] + ts[((r)+0) % 3], \
+				     ks[((r)+7) % (8+1)] + (r)}));
+
+void Skein_512_Process_Block_vsx(Skein_512_Ctxt_t * ctx, const u08b_t * blkPtr,
+				 size_t blkCnt, size_t byteCntAdd)
+{	/* do it in C with VSX! */
+	size_t r;
+	u64b_t ks[8 + 1] __attribute__((aligned(16)));
+	u64b_t ts[3];
+
+	vec_u64 X0, X1, X2, X3;
+	vec_u64 w0, w1, w2, w3;
+	vec_u64 tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;
+
+	vsx_vectors
+	vsx_prefetch_vars(SKEIN_512_BLOCK_BYTES)
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	tmp_vec0 = vec_xl(0x00, (unsigned long long *) ctx->X);
+	tmp_vec1 = vec_xl(0x10, (unsigned long long *) ctx->X);
+	tmp_vec2 = vec_xl(0x20, (unsigned long long *) ctx->X);
+	tmp_vec3 = vec_xl(0x30, (unsigned long long *) ctx->X);
+
+	/* ALTIVEC ORDER */
+	X0 = vsx_upper(tmp_vec0, tmp_vec1);
+	X1 = vsx_upper(tmp_vec2, tmp_vec3);
+	X2 = vsx_lower(tmp_vec0, tmp_vec1);
+	X3 = vsx_lower(tmp_vec2, tmp_vec3);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		vsx_prefetch(blkPtr, SKEIN_512_BLOCK_BYTES);
+
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* Store ks in normal order. */
+		tmp_vec0 = vsx_upper(X0, X2);
+		tmp_vec1 = vsx_lower(X0, X2);
+		tmp_vec2 = vsx_upper(X1, X3);
+		tmp_vec3 = vsx_lower(X1, X3);
+		vec_xst(tmp_vec0, 0x00, (unsigned long long *) ks);
+		vec_xst(tmp_vec1, 0x10, (unsigned long long *) ks);
+		vec_xst(tmp_vec2, 0x20, (unsigned long long *) ks);
+		vec_xst(tmp_vec3, 0x30, (unsigned long long *) ks);
+
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec1);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec2);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec3);
+		ks[8] = tmp_vec0[0] ^ tmp_vec0[1] ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		/* load input block into w registers */
+		tmp_vec0 = vsx_load64(0x00, blkPtr);
+		tmp_vec1 = vsx_load64(0x10, blkPtr);
+		tmp_vec2 = vsx_load64(0x20, blkPtr);
+		tmp_vec3 = vsx_load64(0x30, blkPtr);
+		w0 = vsx_upper(tmp_vec0, tmp_vec1);
+		w1 = vsx_upper(tmp_vec2, tmp_vec3);
+		w2 = vsx_lower(tmp_vec0, tmp_vec1);
+		w3 = vsx_lower(tmp_vec2, tmp_vec3);
+
+		/* first key injection (it adds round number 0) */
+		X0 = w0;
+		X1 = w1;
+		X2 = w2;
+		X3 = w3;
+		InjectKey_512_vsx(0);
+
+		for (r = 1; r <= SKEIN_512_ROUNDS_TOTAL / 8; r++) { /* unroll 8 rounds */
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_0_0, R_512_0_1);
+			vsx_rotl64(X3, R_512_0_2, R_512_0_3);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			X2 = vsx_swap(X2);
+			X3 = vsx_swap(X3);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_1_3, R_512_1_0);
+			vsx_rotl64(X3, R_512_1_1, R_512_1_2);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = vsx_swap(X3);
+			X3 = vsx_swap(tmp_vec0);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_2_2, R_512_2_3);
+			vsx_rotl64(X3, R_512_2_0, R_512_2_1);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			X2 = vsx_swap(X2);
+			X3 = vsx_swap(X3);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_3_1, R_512_3_2);
+			vsx_rotl64(X3, R_512_3_3, R_512_3_0);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = vsx_swap(X3);
+			X3 = vsx_swap(tmp_vec0);
+
+			InjectKey_512_vsx(2 * r - 1);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_4_0, R_512_4_1);
+			vsx_rotl64(X3, R_512_4_2, R_512_4_3);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			X2 = vsx_swap(X2);
+			X3 = vsx_swap(X3);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_5_3, R_512_5_0);
+			vsx_rotl64(X3, R_512_5_1, R_512_5_2);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = vsx_swap(X3);
+			X3 = vsx_swap(tmp_vec0);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_6_2, R_512_6_3);
+			vsx_rotl64(X3, R_512_6_0, R_512_6_1);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			X2 = vsx_swap(X2);
+			X3 = vsx_swap(X3);
+
+			X0 = vec_add(X0, X2);
+			X1 = vec_add(X1, X3);
+			vsx_rotl64(X2, R_512_7_1, R_512_7_2);
+			vsx_rotl64(X3, R_512_7_3, R_512_7_0);
+			X2 = vec_xor(X2, X0);
+			X3 = vec_xor(X3, X1);
+
+			tmp_vec0 = X2;
+			X2 = vsx_swap(X3);
+			X3 = vsx_swap(tmp_vec0);
+
+			InjectKey_512_vsx(2 * r);
+		}
+
+		/* do the final "feedforward" xor */
+		X0 = vec_xor(X0, w0);
+		X1 = vec_xor(X1, w1);
+		X2 = vec_xor(X2, w2);
+		X3 = vec_xor(X3, w3);
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN_512_BLOCK_BYTES;
+	} while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	/* UNDO ALTIVEC ORDER */
+	vec_xst(vsx_upper(X0, X2), 0x00, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X0, X2), 0x10, (unsigned long long *) ctx->X);
+	vec_xst(vsx_upper(X1, X3), 0x20, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X1, X3), 0x30, (unsigned long long *) ctx->X);
+}
+
+#undef InjectKey_512_vsx
+
+#define InjectKey_1024_vsx(r)						\
+	X0 = vec_add(X0, ((vec_u64) {ks[((r)+ 0) % (16+1)],		\
+				     ks[((r)+ 2) % (16+1)]}));		\
+	X1 = vec_add(X1, ((vec_u64) {ks[((r)+ 4) % (16+1)],		\
+				     ks[((r)+ 6) % (16+1)]}));		\
+	X2 = vec_add(X2, ((vec_u64) {ks[((r)+ 8) % (16+1)],		\
+				     ks[((r)+10) % (16+1)]}));		\
+	X3 = vec_add(X3, ((vec_u64) {ks[((r)+12) % (16+1)],		\
+				     ks[((r)+14) % (16+1)] + ts[((r)+1) % 3]})); \
+	X4 = vec_add(X4, ((vec_u64) {ks[((r)+ 1) % (16+1)],		\
+				     ks[((r)+ 3) % (16+1)]}));		\
+	X5 = vec_add(X5, ((vec_u64) {ks[((r)+ 5) % (16+1)],		\
+				     ks[((r)+ 7) % (16+1)]}));		\
+	X6 = vec_add(X6, ((vec_u64) {ks[((r)+ 9) % (16+1)],		\
+				     ks[((r)+11) % (16+1)]}));		\
+	X7 = vec_add(X7, ((vec_u64) {ks[((r)+13) % (16+1)] + ts[((r)+0) % 3], \
+				     ks[((r)+15) % (16+1)] + (r)}));
+
+/* one round of Skein1024: add, rotate, xor (the permutation follows) */
+#define Round_1024_vsx(rot0, rot1, rot2, rot3, rot4, rot5, rot6, rot7)	\
+	X0 = vec_add(X0, X4);						\
+	X1 = vec_add(X1, X5);						\
+	X2 = vec_add(X2, X6);						\
+	X3 = vec_add(X3, X7);						\
+	vsx_rotl64(X4, rot0, rot1);					\
+	vsx_rotl64(X5, rot2, rot3);					\
+	vsx_rotl64(X6, rot4, rot5);					\
+	vsx_rotl64(X7, rot6, rot7);					\
+	X4 = vec_xor(X4, X0);						\
+	X5 = vec_xor(X5, X1);						\
+	X6 = vec_xor(X6, X2);						\
+	X7 = vec_xor(X7, X3);
+
+void Skein1024_Process_Block_vsx(Skein1024_Ctxt_t * ctx, const u08b_t * blkPtr,
+				 size_t blkCnt, size_t byteCntAdd)
+{	/* do it in C with VSX! */
+	size_t r;
+	u64b_t ks[16 + 1] __attribute__((aligned(16)));
+	u64b_t ts[3];
+
+	vec_u64 X0, X1, X2, X3, X4, X5, X6, X7;
+	vec_u64 w0, w1, w2, w3, w4, w5, w6, w7;
+	vec_u64 tmp_vec0, tmp_vec1, tmp_vec2, tmp_vec3;
+	vec_u64 tmp_vec4, tmp_vec5, tmp_vec6, tmp_vec7;
+
+	vsx_vectors
+	vsx_prefetch_vars(SKEIN1024_BLOCK_BYTES)
+
+	Skein_assert(blkCnt != 0);	/* never call with blkCnt == 0! */
+
+	tmp_vec0 = vec_xl(0x00, (unsigned long long *) ctx->X);
+	tmp_vec1 = vec_xl(0x10, (unsigned long long *) ctx->X);
+	tmp_vec2 = vec_xl(0x20, (unsigned long long *) ctx->X);
+	tmp_vec3 = vec_xl(0x30, (unsigned long long *) ctx->X);
+	tmp_vec4 = vec_xl(0x40, (unsigned long long *) ctx->X);
+	tmp_vec5 = vec_xl(0x50, (unsigned long long *) ctx->X);
+	tmp_vec6 = vec_xl(0x60, (unsigned long long *) ctx->X);
+	tmp_vec7 = vec_xl(0x70, (unsigned long long *) ctx->X);
+
+	/* ALTIVEC ORDER */
+	X0 = vsx_upper(tmp_vec0, tmp_vec1);
+	X1 = vsx_upper(tmp_vec2, tmp_vec3);
+	X2 = vsx_upper(tmp_vec4, tmp_vec5);
+	X3 = vsx_upper(tmp_vec6, tmp_vec7);
+	X4 = vsx_lower(tmp_vec0, tmp_vec1);
+	X5 = vsx_lower(tmp_vec2, tmp_vec3);
+	X6 = vsx_lower(tmp_vec4, tmp_vec5);
+	X7 = vsx_lower(tmp_vec6, tmp_vec7);
+
+	ts[0] = ctx->h.T[0];	/* the tweak stays in ts[] for the whole loop */
+	ts[1] = ctx->h.T[1];
+
+	do {
+		vsx_prefetch(blkPtr, SKEIN1024_BLOCK_BYTES);
+
+		/* this implementation only supports 2**64 input bytes (no carry out here) */
+		ts[0] += byteCntAdd;	/* update processed length */
+
+		/* Store ks in normal order. */
+		tmp_vec0 = vsx_upper(X0, X4);
+		tmp_vec1 = vsx_lower(X0, X4);
+		tmp_vec2 = vsx_upper(X1, X5);
+		tmp_vec3 = vsx_lower(X1, X5);
+		tmp_vec4 = vsx_upper(X2, X6);
+		tmp_vec5 = vsx_lower(X2, X6);
+		tmp_vec6 = vsx_upper(X3, X7);
+		tmp_vec7 = vsx_lower(X3, X7);
+		vec_xst(tmp_vec0, 0x00, (unsigned long long *) ks);
+		vec_xst(tmp_vec1, 0x10, (unsigned long long *) ks);
+		vec_xst(tmp_vec2, 0x20, (unsigned long long *) ks);
+		vec_xst(tmp_vec3, 0x30, (unsigned long long *) ks);
+		vec_xst(tmp_vec4, 0x40, (unsigned long long *) ks);
+		vec_xst(tmp_vec5, 0x50, (unsigned long long *) ks);
+		vec_xst(tmp_vec6, 0x60, (unsigned long long *) ks);
+		vec_xst(tmp_vec7, 0x70, (unsigned long long *) ks);
+
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec1);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec2);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec3);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec4);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec5);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec6);
+		tmp_vec0 = vec_xor(tmp_vec0, tmp_vec7);
+		ks[16] = tmp_vec0[0] ^ tmp_vec0[1] ^ SKEIN_KS_PARITY;
+
+		ts[2] = ts[0] ^ ts[1];
+
+		/* load input block into w registers */
+		tmp_vec0 = vsx_load64(0x00, blkPtr);
+		tmp_vec1 = vsx_load64(0x10, blkPtr);
+		tmp_vec2 = vsx_load64(0x20, blkPtr);
+		tmp_vec3 = vsx_load64(0x30, blkPtr);
+		tmp_vec4 = vsx_load64(0x40, blkPtr);
+		tmp_vec5 = vsx_load64(0x50, blkPtr);
+		tmp_vec6 = vsx_load64(0x60, blkPtr);
+		tmp_vec7 = vsx_load64(0x70, blkPtr);
+		w0 = vsx_upper(tmp_vec0, tmp_vec1);
+		w1 = vsx_upper(tmp_vec2, tmp_vec3);
+		w2 = vsx_upper(tmp_vec4, tmp_vec5);
+		w3 = vsx_upper(tmp_vec6, tmp_vec7);
+		w4 = vsx_lower(tmp_vec0, tmp_vec1);
+		w5 = vsx_lower(tmp_vec2, tmp_vec3);
+		w6 = vsx_lower(tmp_vec4, tmp_vec5);
+		w7 = vsx_lower(tmp_vec6, tmp_vec7);
+
+		/* first key injection (it adds round number 0) */
+		X0 = w0;
+		X1 = w1;
+		X2 = w2;
+		X3 = w3;
+		X4 = w4;
+		X5 = w5;
+		X6 = w6;
+		X7 = w7;
+		InjectKey_1024_vsx(0);
+
+		for (r = 1; r <= SKEIN1024_ROUNDS_TOTAL / 8; r++) {	/* unroll 8 rounds */
+			Round_1024_vsx(R1024_0_0, R1024_0_1, R1024_0_2, R1024_0_3,
+				       R1024_0_4, R1024_0_5, R1024_0_6, R1024_0_7);
+
+			tmp_vec4 = X4;
+			X4 = vsx_upper(X6, X7);
+			tmp_vec5 = X5;
+			X5 = vsx_lower(X7, X6);
+			X6 = vsx_upper_lower(tmp_vec4, tmp_vec5);
+			X7 = vsx_sld8(tmp_vec4, tmp_vec5);
+
+			Round_1024_vsx(R1024_1_0, R1024_1_1, R1024_1_3, R1024_1_2,
+				       R1024_1_7, R1024_1_4, R1024_1_5, R1024_1_6);
+
+			tmp_vec4 = X4;
+			X4 = vsx_lower(X6, X7);
+			tmp_vec5 = X5;
+			X5 = vsx_upper(X7, X6);
+			X6 = vsx_sld8(tmp_vec5, tmp_vec4);
+			X7 = vsx_upper_lower(tmp_vec5, tmp_vec4);
+
+			Round_1024_vsx(R1024_2_0, R1024_2_1, R1024_2_2, R1024_2_3,
+				       R1024_2_6, R1024_2_7, R1024_2_4, R1024_2_5);
+
+			tmp_vec4 = X4;
+			X4 = vsx_upper(X7, X6);
+			tmp_vec5 = X5;
+			X5 = vsx_lower(X6, X7);
+			X6 = vsx_sld8(tmp_vec4, tmp_vec5);
+			X7 = vsx_upper_lower(tmp_vec4, tmp_vec5);
+
+			Round_1024_vsx(R1024_3_0, R1024_3_1, R1024_3_3, R1024_3_2,
+				       R1024_3_5, R1024_3_6, R1024_3_7, R1024_3_4);
+
+			tmp_vec4 = X4;
+			X4 = vsx_lower(X7, X6);
+			tmp_vec5 = X5;
+			X5 = vsx_upper(X6, X7);
+			X6 = vsx_upper_lower(tmp_vec5, tmp_vec4);
+			X7 = vsx_sld8(tmp_vec5, tmp_vec4);
+
+			InjectKey_1024_vsx(2 * r - 1);
+
+			Round_1024_vsx(R1024_4_0, R1024_4_1, R1024_4_2, R1024_4_3,
+				       R1024_4_4, R1024_4_5, R1024_4_6, R1024_4_7);
+
+			tmp_vec4 = X4;
+			X4 = vsx_upper(X6, X7);
+			tmp_vec5 = X5;
+			X5 = vsx_lower(X7, X6);
+			X6 = vsx_upper_lower(tmp_vec4, tmp_vec5);
+			X7 = vsx_sld8(tmp_vec4, tmp_vec5);
+
+			Round_1024_vsx(R1024_5_0, R1024_5_1, R1024_5_3, R1024_5_2,
+				       R1024_5_7, R1024_5_4, R1024_5_5, R1024_5_6);
+
+			tmp_vec4 = X4;
+			X4 = vsx_lower(X6, X7);
+			tmp_vec5 = X5;
+			X5 = vsx_upper(X7, X6);
+			X6 = vsx_sld8(tmp_vec5, tmp_vec4);
+			X7 = vsx_upper_lower(tmp_vec5, tmp_vec4);
+
+			Round_1024_vsx(R1024_6_0, R1024_6_1, R1024_6_2, R1024_6_3,
+				       R1024_6_6, R1024_6_7, R1024_6_4, R1024_6_5);
+
+			tmp_vec4 = X4;
+			X4 = vsx_upper(X7, X6);
+			tmp_vec5 = X5;
+			X5 = vsx_lower(X6, X7);
+			X6 = vsx_sld8(tmp_vec4, tmp_vec5);
+			X7 = vsx_upper_lower(tmp_vec4, tmp_vec5);
+
+			Round_1024_vsx(R1024_7_0, R1024_7_1, R1024_7_3, R1024_7_2,
+				       R1024_7_5, R1024_7_6, R1024_7_7, R1024_7_4);
+
+			tmp_vec4 = X4;
+			X4 = vsx_lower(X7, X6);
+			tmp_vec5 = X5;
+			X5 = vsx_upper(X6, X7);
+			X6 = vsx_upper_lower(tmp_vec5, tmp_vec4);
+			X7 = vsx_sld8(tmp_vec5, tmp_vec4);
+
+			InjectKey_1024_vsx(2 * r);
+		}
+		/* do the final "feedforward" xor */
+		X0 = vec_xor(X0, w0);
+		X1 = vec_xor(X1, w1);
+		X2 = vec_xor(X2, w2);
+		X3 = vec_xor(X3, w3);
+		X4 = vec_xor(X4, w4);
+		X5 = vec_xor(X5, w5);
+		X6 = vec_xor(X6, w6);
+		X7 = vec_xor(X7, w7);
+
+		ts[1] &= ~SKEIN_T1_FLAG_FIRST;	/* clear the start bit */
+		blkPtr += SKEIN1024_BLOCK_BYTES;
+	}
+	while (--blkCnt);
+
+	ctx->h.T[0] = ts[0];
+	ctx->h.T[1] = ts[1];
+
+	/* UNDO ALTIVEC ORDER */
+	vec_xst(vsx_upper(X0, X4), 0x00, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X0, X4), 0x10, (unsigned long long *) ctx->X);
+	vec_xst(vsx_upper(X1, X5), 0x20, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X1, X5), 0x30, (unsigned long long *) ctx->X);
+	vec_xst(vsx_upper(X2, X6), 0x40, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X2, X6), 0x50, (unsigned long long *) ctx->X);
+	vec_xst(vsx_upper(X3, X7), 0x60, (unsigned long long *) ctx->X);
+	vec_xst(vsx_lower(X3, X7), 0x70, (unsigned long long *) ctx->X);
+}
+
+#undef InjectKey_1024_vsx
+#undef Round_1024_vsx
+
+/*
+ * With native 64 bit operations the round function is short enough that the
+ * out of order core of POWER8/9 overlaps consecutive rounds well, so the
+ * multi-buffer entry points just run the lanes one after the other.
+ */
+void Skein_512_Process_Block_x2_vsx(Skein_512_Ctxt_t * ctx[2],
+				    const u08b_t * blkPtr[2], size_t blkCnt,
+				    const size_t byteCntAdd[2])
+{
+	Skein_512_Process_Block_vsx(ctx[0], blkPtr[0], blkCnt, byteCntAdd[0]);
+	Skein_512_Process_Block_vsx(ctx[1], blkPtr[1], blkCnt, byteCntAdd[1]);
+}
+
+void Skein_512_Process_Block_x4_vsx(Skein_512_Ctxt_t * ctx[4],
+				    const u08b_t * blkPtr[4], size_t blkCnt,
+				    const size_t byteCntAdd[4])
+{
+	Skein_512_Process_Block_x2_vsx(ctx, blkPtr, blkCnt, byteCntAdd);
+	Skein_512_Process_Block_x2_vsx(ctx + 2, blkPtr + 2, blkCnt,
+				       byteCntAdd + 2);
+}
@@ -0,0 +1,214 @@
+/***********************************************************************
+**
+** Implementation of hashing whole files.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#define _FILE_OFFSET_BITS 64	/* files larger than 2 GB on 32 bit systems */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include "skein_file.h"
+
+#ifndef SKEIN_FILE_WINDOW
+#define SKEIN_FILE_WINDOW (64 * 1024 * 1024)	/* bytes mapped at once */
+#endif
+#ifndef SKEIN_FILE_BUFFER
+#define SKEIN_FILE_BUFFER (1024 * 1024)	/* size of one read() slot */
+#endif
+#ifndef SKEIN_FILE_SLOTS
+#define SKEIN_FILE_SLOTS (4)	/* slots in the read() ring buffer */
+#endif
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash size - offs bytes of a regular file through a sliding mapping */
+/* returns the offset reached (< size if mmap() failed) */
+static off_t Skein_Hash_Map(hashState * state, int fd, off_t offs, off_t size)
+{
+	off_t start, page = sysconf(_SC_PAGESIZE);
+	size_t len, skip;
+	u08b_t *p;
+
+	while (offs < size) {
+		start = offs & ~(page - 1);	/* mmap() needs an aligned offset */
+		skip = offs - start;
+		len = (size - start > SKEIN_FILE_WINDOW) ? SKEIN_FILE_WINDOW : size - start;
+
+		p = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, start);
+		if (p == MAP_FAILED)
+			break;
+		madvise(p, len, MADV_SEQUENTIAL);
+		madvise(p, len, MADV_WILLNEED);
+
+		Update(state, p + skip, (DataLength) (len - skip) * 8);
+
+		munmap(p, len);
+		offs = start + len;
+	}
+
+	return offs;
+}
+
+/* read() until the buffer is full, EOF, or an error (-1, if nothing was read) */
+static ssize_t Skein_Read_Full(int fd, u08b_t * buf, size_t size)
+{
+	size_t got = 0;
+	ssize_t len;
+
+	while (got < size) {
+		len = read(fd, buf + got, size - got);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len < 0 && got == 0)
+			return -1;
+		if (len <= 0)
+			break;
+		got += len;
+	}
+	return got;
+}
+
+/*
+ * The read() path: a reader thread fills the slots of a ring buffer while
+ * the calling thread hashes the slots that are full, so reading and hashing
+ * overlap. A slot with len <= 0 marks EOF (0) or a read error (-1).
+ */
+typedef struct {
+	int fd;
+	u08b_t *buf;		/* SKEIN_FILE_SLOTS * SKEIN_FILE_BUFFER bytes */
+	ssize_t len[SKEIN_FILE_SLOTS];
+	uint_t head;		/* slots filled so far */
+	uint_t tail;		/* slots hashed so far */
+	pthread_mutex_t lock;
+	pthread_cond_t filled, emptied;
+} Skein_Ring_t;
+
+static void *Skein_Ring_Reader(void *arg)
+{
+	Skein_Ring_t *r = arg;
+	uint_t slot;
+	ssize_t len;
+
+	do {
+		pthread_mutex_lock(&r->lock);
+		while (r->head - r->tail == SKEIN_FILE_SLOTS)
+			pthread_cond_wait(&r->emptied, &r->lock);
+		slot = r->head % SKEIN_FILE_SLOTS;
+		pthread_mutex_unlock(&r->lock);
+
+		len = Skein_Read_Full(r->fd, r->buf + slot * SKEIN_FILE_BUFFER,
+				      SKEIN_FILE_BUFFER);
+
+		pthread_mutex_lock(&r->lock);
+		r->len[slot] = len;
+		r->head++;
+		pthread_cond_signal(&r->filled);
+		pthread_mutex_unlock(&r->lock);
+	} while (len > 0);
+
+	return NULL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash everything that read() returns until EOF */
+static HashReturn Skein_Hash_Read(hashState * state, int fd)
+{
+	Skein_Ring_t r;
+	pthread_t reader;
+	uint_t slot;
+	ssize_t len;
+
+	r.fd = fd;
+	r.head = r.tail = 0;
+	r.buf = malloc(SKEIN_FILE_SLOTS * SKEIN_FILE_BUFFER);
+	if (r.buf == NULL)
+		return FAIL;
+	pthread_mutex_init(&r.lock, NULL);
+	pthread_cond_init(&r.filled, NULL);
+	pthread_cond_init(&r.emptied, NULL);
+
+	if (pthread_create(&reader, NULL, Skein_Ring_Reader, &r) == 0) {
+		for (;;) {
+			pthread_mutex_lock(&r.lock);
+			while (r.head == r.tail)
+				pthread_cond_wait(&r.filled, &r.lock);
+			slot = r.tail % SKEIN_FILE_SLOTS;
+			len = r.len[slot];
+			pthread_mutex_unlock(&r.lock);
+
+			if (len <= 0)
+				break;
+			Update(state, r.buf + slot * SKEIN_FILE_BUFFER,
+			       (DataLength) len * 8);
+
+			pthread_mutex_lock(&r.lock);
+			r.tail++;
+			pthread_cond_signal(&r.emptied);
+			pthread_mutex_unlock(&r.lock);
+		}
+		pthread_join(reader, NULL);
+	} else {		/* no thread: read and hash in turn */
+		while ((len = Skein_Read_Full(fd, r.buf, SKEIN_FILE_BUFFER)) > 0)
+			Update(state, r.buf, (DataLength) len * 8);
+	}
+
+	pthread_cond_destroy(&r.emptied);
+	pthread_cond_destroy(&r.filled);
+	pthread_mutex_destroy(&r.lock);
+	free(r.buf);
+	return (len == 0) ? SUCCESS : FAIL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash everything from the current position of fd up to EOF */
+HashReturn Skein_Hash_Fd(hashState * state, int fd, BitSequence * hashval)
+{
+	struct stat st;
+	off_t offs;
+	HashReturn r = SUCCESS;
+
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)
+	    && (offs = lseek(fd, 0, SEEK_CUR)) >= 0) {
+		offs = Skein_Hash_Map(state, fd, offs, st.st_size);
+		/* continue with read() where the mapping stopped (if it did) */
+		if (lseek(fd, offs, SEEK_SET) != offs)
+			return FAIL;
+		if (offs < st.st_size)
+			r = Skein_Hash_Read(state, fd);
+	} else {
+		r = Skein_Hash_Read(state, fd);
+	}
+
+	if (r != SUCCESS)
+		return r;
+	return Final(state, hashval);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash the file at path ("-" is stdin) */
+HashReturn Skein_Hash_File(hashState * state, const char *path,
+			   BitSequence * hashval)
+{
+	HashReturn r;
+	int fd;
+
+	if (strcmp(path, "-") == 0)
+		return Skein_Hash_Fd(state, STDIN_FILENO, hashval);
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return FAIL;
+	r = Skein_Hash_Fd(state, fd, hashval);
+	close(fd);
+
+	return r;
+}
@@ -0,0 +1,31 @@
+#ifndef _SKEIN_FILE_H_
+#define _SKEIN_FILE_H_
+/***********************************************************************
+**
+** Interface declarations for hashing whole files.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** The state must have been set up with Init() or InitExt() (not with
+** the Skein_*_Init() functions on a context in it, that leaves
+** state->update unset); the file is hashed and Final() is called.
+**
+** Regular files are mmap()ed and the block function reads the mapping
+** directly, so no data is copied. Pipes, terminals etc. (and files that
+** cannot be mapped) are read() in chunks by a reader thread, while the
+** calling thread hashes the chunks read before. Note that a file which is
+** truncated while it is being hashed can cause a SIGBUS.
+**
+***********************************************************************/
+
+#include "SHA3api_ref.h"
+
+/* hash the file at path ("-" is stdin) */
+HashReturn Skein_Hash_File(hashState * state, const char *path,
+			   BitSequence * hashval);
+/* hash everything from the current position of fd up to EOF */
+HashReturn Skein_Hash_Fd(hashState * state, int fd, BitSequence * hashval);
+
+#endif				/* ifndef _SKEIN_FILE_H_ */
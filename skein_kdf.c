@@ -0,0 +1,71 @@
+/***********************************************************************
+**
+** Implementation of Skein-KDF with a prepared master key.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <string.h>		/* get the memcpy/memset functions */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_kdf.h"
+
+/* a copy of the prepared context, ready for the key identifier */
+static void Skein_512_KDF_Begin(const Skein_512_KDF_Prepared_t * prep,
+				Skein_512_Ctxt_t * ctx)
+{
+	memcpy(ctx, &prep->ctx, sizeof(*ctx));
+	Skein_Start_New_Type(ctx, KDF);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* run the key and config blocks once */
+int Skein_512_KDF_Prepare(Skein_512_KDF_Prepared_t * prep, size_t keyBitLen,
+			  const u08b_t * master, size_t masterBytes)
+{
+	return Skein_512_InitExt(&prep->ctx, keyBitLen,
+				 SKEIN_CFG_TREE_INFO_SEQUENTIAL, master,
+				 masterBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* derive one key */
+int Skein_512_KDF_Derive(const Skein_512_KDF_Prepared_t * prep,
+			 const u08b_t * id, size_t idBytes, u08b_t * key)
+{
+	Skein_512_Ctxt_t ctx;
+	int ret;
+
+	Skein_Assert(prep->ctx.h.bCnt == 0, SKEIN_FAIL);	/* catch unprepared keys */
+	Skein_512_KDF_Begin(prep, &ctx);
+	Skein_512_Update(&ctx, id, idBytes);
+	ret = Skein_512_Final(&ctx, key);
+	memset(&ctx, 0, sizeof(ctx));
+	return ret;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* derive many keys, SKEIN_KDF_BATCH at a time through Hash_Many() */
+int Skein_512_KDF_Derive_Many(const Skein_512_KDF_Prepared_t * prep,
+			      const u08b_t * id[], const size_t idBytes[],
+			      u08b_t * key[], size_t cnt)
+{
+	Skein_512_Ctxt_t ctx[SKEIN_KDF_BATCH];
+	Skein_512_Ctxt_t *ctxPtr[SKEIN_KDF_BATCH];
+	size_t i, n;
+	int ret = SKEIN_SUCCESS;
+
+	Skein_Assert(prep->ctx.h.bCnt == 0, SKEIN_FAIL);	/* catch unprepared keys */
+
+	for (; cnt; cnt -= n, id += n, idBytes += n, key += n) {
+		n = (cnt < SKEIN_KDF_BATCH) ? cnt : SKEIN_KDF_BATCH;
+		for (i = 0; i < n; i++) {
+			Skein_512_KDF_Begin(prep, &ctx[i]);
+			ctxPtr[i] = &ctx[i];
+		}
+		if (Skein_512_Hash_Many(ctxPtr, id, idBytes, key, n) != SKEIN_SUCCESS)
+			ret = SKEIN_FAIL;
+	}
+	memset(ctx, 0, sizeof(ctx));	/* the contexts are keyed */
+	return ret;
+}
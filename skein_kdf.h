@@ -0,0 +1,43 @@
+#ifndef _SKEIN_KDF_H_
+#define _SKEIN_KDF_H_
+/***********************************************************************
+**
+** Interface declarations for Skein-KDF with a prepared master key.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** The KDF of the Skein paper: the master key is the key of InitExt(), the
+** config block gives the size of the derived key, and the key identifier
+** is hashed with the KDF block type instead of as a message. The key and
+** config blocks are the same for all derivations, KDF_Prepare() runs
+** them once.
+**
+** KDF_Derive_Many() hashes the identifiers four at a time with the
+** multi-buffer kernels, as Skein_512_Hash_Many() does for messages.
+**
+***********************************************************************/
+
+#include "skein.h"
+
+#ifndef SKEIN_KDF_BATCH
+#define SKEIN_KDF_BATCH 16	/* contexts per Hash_Many() call */
+#endif
+
+typedef struct {
+	Skein_512_Ctxt_t ctx;	/* the context right after InitExt() */
+} Skein_512_KDF_Prepared_t;
+
+/* the derived keys will be keyBitLen bits long */
+int Skein_512_KDF_Prepare(Skein_512_KDF_Prepared_t * prep, size_t keyBitLen,
+			  const u08b_t * master, size_t masterBytes);
+/* derive the key for id[0..idBytes-1] */
+int Skein_512_KDF_Derive(const Skein_512_KDF_Prepared_t * prep,
+			 const u08b_t * id, size_t idBytes, u08b_t * key);
+/* derive key[i] for each id[i], same results as cnt Derive() calls */
+int Skein_512_KDF_Derive_Many(const Skein_512_KDF_Prepared_t * prep,
+			      const u08b_t * id[], const size_t idBytes[],
+			      u08b_t * key[], size_t cnt);
+
+#endif				/* ifndef _SKEIN_KDF_H_ */
@@ -0,0 +1,460 @@
+/***********************************************************************
+**
+** Run-time selection of the Skein block functions.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <stdio.h>		/* get the snprintf function */
+#include <stdlib.h>		/* get the getenv/strtol functions */
+#include <string.h>		/* get the strcmp/memcpy functions */
+#include "skein_kernel.h"
+
+#if defined(__linux__) && (defined(__powerpc__) || defined(__powerpc64__))
+#include <sys/auxv.h>
+#define SKEIN_HAVE_AUXV 1
+#endif
+
+/*
+ * Which kernels are compiled in (the scalar one always is). The G4 code in
+ * skein_block.c assumes a big endian system, so it is left out on ppc64le
+ * by default, and it needs -maltivec (not there for the e300 cores).
+ */
+#ifndef SKEIN_KERNEL_ALTIVEC
+#if defined(__ALTIVEC__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define SKEIN_KERNEL_ALTIVEC 1
+#else
+#define SKEIN_KERNEL_ALTIVEC 0
+#endif
+#endif
+
+#ifndef SKEIN_KERNEL_VSX
+#if defined(__powerpc64__)
+#define SKEIN_KERNEL_VSX 1
+#else
+#define SKEIN_KERNEL_VSX 0
+#endif
+#endif
+
+/* skein_block_simd.c, built once for each of these by the Makefile */
+#ifndef SKEIN_KERNEL_SSE2
+#if defined(__x86_64__)
+#define SKEIN_KERNEL_SSE2 1
+#else
+#define SKEIN_KERNEL_SSE2 0
+#endif
+#endif
+
+#ifndef SKEIN_KERNEL_AVX2
+#if defined(__x86_64__)
+#define SKEIN_KERNEL_AVX2 1
+#else
+#define SKEIN_KERNEL_AVX2 0
+#endif
+#endif
+
+#ifndef SKEIN_KERNEL_NEON
+#if defined(__aarch64__)
+#define SKEIN_KERNEL_NEON 1
+#else
+#define SKEIN_KERNEL_NEON 0
+#endif
+#endif
+
+/* the hwcap bits, in case the libc headers are too old to have them */
+#ifndef PPC_FEATURE_HAS_ALTIVEC
+#define PPC_FEATURE_HAS_ALTIVEC 0x10000000
+#endif
+#ifndef PPC_FEATURE_HAS_VSX
+#define PPC_FEATURE_HAS_VSX 0x00000080
+#endif
+#ifndef PPC_FEATURE2_ARCH_2_07
+#define PPC_FEATURE2_ARCH_2_07 0x80000000
+#endif
+
+#if SKEIN_KERNEL_ALTIVEC
+static int Skein_Altivec_Available(void)
+{
+#ifdef SKEIN_HAVE_AUXV
+	return (getauxval(AT_HWCAP) & PPC_FEATURE_HAS_ALTIVEC) != 0;
+#else
+	return 1;		/* the whole program is built with -maltivec */
+#endif
+}
+
+static const Skein_Kernel_t Skein_Kernel_Altivec = {
+	"altivec",
+	Skein_Altivec_Available,
+	Skein_256_Process_Block_altivec,
+	Skein_512_Process_Block_altivec,
+	Skein1024_Process_Block_altivec,
+	Skein_512_Process_Block_x2_altivec,
+	Skein_512_Process_Block_x4_altivec,
+	Skein_256_Process_Block_aligned_altivec,
+	Skein_512_Process_Block_aligned_altivec,
+	Skein1024_Process_Block_aligned_altivec
+};
+#endif
+
+#if SKEIN_KERNEL_VSX
+static int Skein_VSX_Available(void)
+{
+#ifdef SKEIN_HAVE_AUXV
+	return (getauxval(AT_HWCAP) & PPC_FEATURE_HAS_VSX) &&
+	    (getauxval(AT_HWCAP2) & PPC_FEATURE2_ARCH_2_07);
+#else
+	return 0;		/* cannot tell, so do not risk SIGILL */
+#endif
+}
+
+static const Skein_Kernel_t Skein_Kernel_VSX = {
+	"vsx",
+	Skein_VSX_Available,
+	Skein_256_Process_Block_vsx,
+	Skein_512_Process_Block_vsx,
+	Skein1024_Process_Block_vsx,
+	Skein_512_Process_Block_x2_vsx,
+	Skein_512_Process_Block_x4_vsx,
+	Skein_256_Process_Block_vsx,	/* unaligned loads are just as fast */
+	Skein_512_Process_Block_vsx,
+	Skein1024_Process_Block_vsx
+};
+#endif
+
+#if SKEIN_KERNEL_AVX2
+static int Skein_AVX2_Available(void)
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+}
+
+/*
+ * A single message is faster with the scalar code on x86_64 (the rounds
+ * are one long dependency chain, the integer units rotate in one cycle),
+ * and so is Skein_512 x2. The four lanes fill the 256 bit registers.
+ */
+static const Skein_Kernel_t Skein_Kernel_AVX2 = {
+	"avx2",
+	Skein_AVX2_Available,
+	Skein_256_Process_Block_scalar,
+	Skein_512_Process_Block_scalar,
+	Skein1024_Process_Block_scalar,
+	Skein_512_Process_Block_x2_scalar,
+	Skein_512_Process_Block_x4_avx2,
+	Skein_256_Process_Block_scalar,
+	Skein_512_Process_Block_scalar,
+	Skein1024_Process_Block_scalar
+};
+#endif
+
+#if SKEIN_KERNEL_SSE2
+static int Skein_SSE2_Available(void)
+{
+	return 1;		/* part of x86_64 */
+}
+
+static const Skein_Kernel_t Skein_Kernel_SSE2 = {
+	"sse2",
+	Skein_SSE2_Available,
+	Skein_256_Process_Block_sse2,
+	Skein_512_Process_Block_sse2,
+	Skein1024_Process_Block_sse2,
+	Skein_512_Process_Block_x2_sse2,
+	Skein_512_Process_Block_x4_sse2,
+	Skein_256_Process_Block_sse2,	/* unaligned loads are just as fast */
+	Skein_512_Process_Block_sse2,
+	Skein1024_Process_Block_sse2
+};
+#endif
+
+#if SKEIN_KERNEL_NEON
+static int Skein_NEON_Available(void)
+{
+	return 1;		/* part of AArch64 */
+}
+
+static const Skein_Kernel_t Skein_Kernel_NEON = {
+	"neon",
+	Skein_NEON_Available,
+	Skein_256_Process_Block_neon,
+	Skein_512_Process_Block_neon,
+	Skein1024_Process_Block_neon,
+	Skein_512_Process_Block_x2_neon,
+	Skein_512_Process_Block_x4_neon,
+	Skein_256_Process_Block_neon,	/* unaligned loads are just as fast */
+	Skein_512_Process_Block_neon,
+	Skein1024_Process_Block_neon
+};
+#endif
+
+static int Skein_Scalar_Available(void)
+{
+	return 1;
+}
+
+static const Skein_Kernel_t Skein_Kernel_Scalar = {
+	"scalar",
+	Skein_Scalar_Available,
+	Skein_256_Process_Block_scalar,
+	Skein_512_Process_Block_scalar,
+	Skein1024_Process_Block_scalar,
+	Skein_512_Process_Block_x2_scalar,
+	Skein_512_Process_Block_x4_scalar,
+	Skein_256_Process_Block_scalar,	/* no special aligned loads */
+	Skein_512_Process_Block_scalar,
+	Skein1024_Process_Block_scalar
+};
+
+const Skein_Kernel_t *const Skein_Kernel_List[] = {
+#if SKEIN_KERNEL_VSX
+	&Skein_Kernel_VSX,
+#endif
+#if SKEIN_KERNEL_ALTIVEC
+	&Skein_Kernel_Altivec,
+#endif
+#if SKEIN_KERNEL_AVX2
+	&Skein_Kernel_AVX2,
+#endif
+	&Skein_Kernel_Scalar,	/* runs everywhere */
+#if SKEIN_KERNEL_SSE2
+	&Skein_Kernel_SSE2,	/* slower than scalar, only selected by name */
+#endif
+#if SKEIN_KERNEL_NEON
+	&Skein_Kernel_NEON,	/* not measured on ARM yet, only selected by name */
+#endif
+	NULL
+};
+
+Skein_Prefetch_t Skein_Prefetch = { SKEIN_PREFETCH_AUTO, 2, 0, 2 };
+
+/* environment variable SKEIN_PREFETCH, else the default for the CPU */
+static void Skein_Default_Prefetch(void)
+{
+	const char *spec = getenv("SKEIN_PREFETCH");
+
+	if (spec == NULL || Skein_Set_Prefetch(spec) != SKEIN_SUCCESS)
+		Skein_Set_Prefetch(NULL);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* select the kernel (environment variable SKEIN_KERNEL, else the fastest) */
+static void Skein_Select_Kernel(void)
+{
+	const char *name = getenv("SKEIN_KERNEL");
+
+	if (name == NULL || Skein_Set_Kernel(name) != SKEIN_SUCCESS)
+		Skein_Set_Kernel(NULL);
+}
+
+/*
+ * The initial kernel selects the real one and forwards the call to it.
+ * Two threads can race here, but both will store the same pointer.
+ */
+static void Skein_256_Process_Block_auto(Skein_256_Ctxt_t * ctx,
+					 const u08b_t * blkPtr, size_t blkCnt,
+					 size_t byteCntAdd)
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_256(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein_512_Process_Block_auto(Skein_512_Ctxt_t * ctx,
+					 const u08b_t * blkPtr, size_t blkCnt,
+					 size_t byteCntAdd)
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_512(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein1024_Process_Block_auto(Skein1024_Ctxt_t * ctx,
+					 const u08b_t * blkPtr, size_t blkCnt,
+					 size_t byteCntAdd)
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_1024(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein_512_Process_Block_x2_auto(Skein_512_Ctxt_t * ctx[2],
+					    const u08b_t * blkPtr[2],
+					    size_t blkCnt,
+					    const size_t byteCntAdd[2])
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_512_x2(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein_512_Process_Block_x4_auto(Skein_512_Ctxt_t * ctx[4],
+					    const u08b_t * blkPtr[4],
+					    size_t blkCnt,
+					    const size_t byteCntAdd[4])
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_512_x4(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein_256_Process_Block_aligned_auto(Skein_256_Ctxt_t * ctx,
+						 const u08b_t * blkPtr,
+						 size_t blkCnt, size_t byteCntAdd)
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_256_aligned(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein_512_Process_Block_aligned_auto(Skein_512_Ctxt_t * ctx,
+						 const u08b_t * blkPtr,
+						 size_t blkCnt, size_t byteCntAdd)
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_512_aligned(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static void Skein1024_Process_Block_aligned_auto(Skein1024_Ctxt_t * ctx,
+						 const u08b_t * blkPtr,
+						 size_t blkCnt, size_t byteCntAdd)
+{
+	Skein_Select_Kernel();
+	Skein_Kernel->process_1024_aligned(ctx, blkPtr, blkCnt, byteCntAdd);
+}
+
+static const Skein_Kernel_t Skein_Kernel_Auto = {
+	"auto",
+	NULL,
+	Skein_256_Process_Block_auto,
+	Skein_512_Process_Block_auto,
+	Skein1024_Process_Block_auto,
+	Skein_512_Process_Block_x2_auto,
+	Skein_512_Process_Block_x4_auto,
+	Skein_256_Process_Block_aligned_auto,
+	Skein_512_Process_Block_aligned_auto,
+	Skein1024_Process_Block_aligned_auto
+};
+
+const Skein_Kernel_t *Skein_Kernel = &Skein_Kernel_Auto;
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* select a kernel by name, or the fastest available one for NULL/"auto" */
+int Skein_Set_Kernel(const char *name)
+{
+	size_t i;
+
+	if (name != NULL && strcmp(name, "auto") == 0)
+		name = NULL;
+
+	for (i = 0; Skein_Kernel_List[i] != NULL; i++) {
+		const Skein_Kernel_t *k = Skein_Kernel_List[i];
+
+		if (name != NULL && strcmp(name, k->name) != 0)
+			continue;
+		if (!k->available())
+			continue;
+
+		Skein_Kernel = k;
+		if (Skein_Prefetch.mode == SKEIN_PREFETCH_AUTO)
+			Skein_Default_Prefetch();
+		return SKEIN_SUCCESS;
+	}
+
+	return SKEIN_FAIL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* name of the kernel in use */
+const char *Skein_Get_Kernel(void)
+{
+	if (Skein_Kernel == &Skein_Kernel_Auto)
+		Skein_Select_Kernel();
+
+	return Skein_Kernel->name;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* "none", "dst[:count[:stride]]", "dcbt[:distance]" or NULL (CPU default) */
+int Skein_Set_Prefetch(const char *spec)
+{
+	Skein_Prefetch_t p = { SKEIN_PREFETCH_DST, 2, 0, 2 };
+	const char *arg;
+	char *end;
+	long v;
+
+	if (spec == NULL) {
+#ifdef SKEIN_HAVE_AUXV
+		const char *cpu = (const char *) getauxval(AT_PLATFORM);
+
+		/* only the G4 (ppc7400, ppc7450) streams well with dst */
+		if (cpu != NULL && strncmp(cpu, "ppc74", 5) != 0)
+			p.mode = SKEIN_PREFETCH_DCBT;
+#endif
+#if !SKEIN_KERNEL_ALTIVEC && !SKEIN_KERNEL_VSX
+		p.mode = SKEIN_PREFETCH_NONE;	/* the scalar kernel does not prefetch */
+#endif
+		Skein_Prefetch = p;
+		return SKEIN_SUCCESS;
+	}
+
+	if (strcmp(spec, "none") == 0) {
+		p.mode = SKEIN_PREFETCH_NONE;
+	} else if (strncmp(spec, "dst", 3) == 0 && (spec[3] == ':' || spec[3] == 0)) {
+		arg = spec + 3;
+		if (*arg == ':') {
+			v = strtol(arg + 1, &end, 10);
+			if (end == arg + 1 || v < 1 || v > 256)
+				return SKEIN_FAIL;
+			p.count = (uint_t) v;
+			arg = end;
+		}
+		if (*arg == ':') {
+			v = strtol(arg + 1, &end, 10);
+			if (end == arg + 1 || v < -32768 || v > 32767)
+				return SKEIN_FAIL;
+			p.stride = (int) v;
+			arg = end;
+		}
+		if (*arg != 0)
+			return SKEIN_FAIL;
+	} else if (strncmp(spec, "dcbt", 4) == 0 && (spec[4] == ':' || spec[4] == 0)) {
+		p.mode = SKEIN_PREFETCH_DCBT;
+		arg = spec + 4;
+		if (*arg == ':') {
+			v = strtol(arg + 1, &end, 10);
+			if (end == arg + 1 || v < 0 || v > 64)
+				return SKEIN_FAIL;
+			p.distance = (uint_t) v;
+			arg = end;
+		}
+		if (*arg != 0)
+			return SKEIN_FAIL;
+	} else {
+		return SKEIN_FAIL;
+	}
+
+	Skein_Prefetch = p;
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the prefetch strategy in use (in a static buffer) */
+const char *Skein_Get_Prefetch(void)
+{
+	static char buf[32];
+
+	if (Skein_Prefetch.mode == SKEIN_PREFETCH_AUTO)
+		Skein_Default_Prefetch();
+
+	switch (Skein_Prefetch.mode) {
+	case SKEIN_PREFETCH_DST:
+		if (Skein_Prefetch.stride)
+			snprintf(buf, sizeof(buf), "dst:%u:%d", Skein_Prefetch.count,
+				 Skein_Prefetch.stride);
+		else
+			snprintf(buf, sizeof(buf), "dst:%u", Skein_Prefetch.count);
+		break;
+	case SKEIN_PREFETCH_DCBT:
+		snprintf(buf, sizeof(buf), "dcbt:%u", Skein_Prefetch.distance);
+		break;
+	default:
+		snprintf(buf, sizeof(buf), "none");
+		break;
+	}
+	return buf;
+}
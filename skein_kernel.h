@@ -0,0 +1,257 @@
+#ifndef _SKEIN_KERNEL_H_
+#define _SKEIN_KERNEL_H_
+/***********************************************************************
+**
+** Run-time selection of the Skein block functions.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** There is one set of block functions ("kernel") per instruction set.
+** The first time a block is processed, the fastest kernel that the CPU
+** supports is selected (this can be overridden with the SKEIN_KERNEL
+** environment variable, or with Skein_Set_Kernel()). All calls of
+** Skein_*_Process_Block go through the selected kernel.
+**
+** Between calls, the chaining variables ctx->X are kept in the spec's
+** word order; a kernel that works with another one (AltiVec: the even
+** words, then the odd ones) converts when it loads and stores them. A
+** context can therefore be finished with another kernel than the one it
+** was started with. Keeping X in the kernel's order would only save those
+** permutes (two per vector, once per call, not per block), and every
+** context and precomputed state would then have to record its layout.
+**
+***********************************************************************/
+
+#include "skein.h"
+#include "skein_stats.h"	/* get SKEIN_STATS */
+
+typedef void (*Skein_256_Process_Block_t) (Skein_256_Ctxt_t * ctx,
+					   const u08b_t * blkPtr,
+					   size_t blkCnt, size_t byteCntAdd);
+typedef void (*Skein_512_Process_Block_t) (Skein_512_Ctxt_t * ctx,
+					   const u08b_t * blkPtr,
+					   size_t blkCnt, size_t byteCntAdd);
+typedef void (*Skein1024_Process_Block_t) (Skein1024_Ctxt_t * ctx,
+					   const u08b_t * blkPtr,
+					   size_t blkCnt, size_t byteCntAdd);
+/* Process blkCnt full blocks of two/four independent Skein-512 contexts */
+typedef void (*Skein_512_Process_Block_x2_t) (Skein_512_Ctxt_t * ctx[2],
+					      const u08b_t * blkPtr[2],
+					      size_t blkCnt,
+					      const size_t byteCntAdd[2]);
+typedef void (*Skein_512_Process_Block_x4_t) (Skein_512_Ctxt_t * ctx[4],
+					      const u08b_t * blkPtr[4],
+					      size_t blkCnt,
+					      const size_t byteCntAdd[4]);
+
+typedef struct {
+	const char *name;	/* "altivec", "vsx", "avx2", "sse2", "neon", "scalar" */
+	int (*available) (void);	/* nonzero if the CPU can run it */
+
+	Skein_256_Process_Block_t process_256;
+	Skein_512_Process_Block_t process_512;
+	Skein1024_Process_Block_t process_1024;
+	Skein_512_Process_Block_x2_t process_512_x2;
+	Skein_512_Process_Block_x4_t process_512_x4;
+
+	/* the same, for blkPtr aligned to SKEIN_ALIGNMENT bytes */
+	Skein_256_Process_Block_t process_256_aligned;
+	Skein_512_Process_Block_t process_512_aligned;
+	Skein1024_Process_Block_t process_1024_aligned;
+} Skein_Kernel_t;
+
+/* the kernel in use (a self-selecting stub until the first call) */
+extern const Skein_Kernel_t *Skein_Kernel;
+
+/* all kernels compiled in, fastest first, NULL terminated */
+extern const Skein_Kernel_t *const Skein_Kernel_List[];
+
+/* select a kernel by name (NULL or "auto": the fastest available one),
+ * at any time, contexts do not depend on the kernel */
+int Skein_Set_Kernel(const char *name);
+/* name of the kernel in use (selects one if that did not happen yet) */
+const char *Skein_Get_Kernel(void);
+
+/*
+ * How the block functions prefetch the message. The default depends on the
+ * CPU: dst streams on the G4, dcbt hints on the G5 (where dst is microcoded)
+ * and POWER (where it does nothing). The SKEIN_PREFETCH environment variable
+ * ("none", "dst[:count[:stride]]" or "dcbt[:distance]") overrides it.
+ */
+#define SKEIN_PREFETCH_AUTO	(-1)	/* not chosen yet */
+#define SKEIN_PREFETCH_NONE	0
+#define SKEIN_PREFETCH_DST	1	/* AltiVec data stream touch (vec_dst) */
+#define SKEIN_PREFETCH_DCBT	2	/* dcbt cache hints */
+
+typedef struct {
+	int mode;		/* SKEIN_PREFETCH_* */
+	uint_t count;		/* dst: blocks per stream (1..256) */
+	int stride;		/* dst: bytes from block to block (0: block size) */
+	uint_t distance;	/* dcbt: blocks ahead of the current one */
+} Skein_Prefetch_t;
+
+extern Skein_Prefetch_t Skein_Prefetch;
+
+/* set the prefetch strategy like SKEIN_PREFETCH (NULL: the CPU default) */
+int Skein_Set_Prefetch(const char *spec);
+/* the strategy in use, in the same format */
+const char *Skein_Get_Prefetch(void);
+
+#define SKEIN_CACHE_LINE	(32)	/* the smallest one (G4), for dcbt */
+
+/* dcbt hints for the blkBytes bytes that start at ptr */
+#define Skein_Prefetch_Touch(ptr, blkBytes)				\
+	do {								\
+		size_t _pf;						\
+		for (_pf = 0; _pf < (blkBytes); _pf += SKEIN_CACHE_LINE)	\
+			__builtin_prefetch((const u08b_t *) (ptr) + _pf);	\
+	} while (0)
+
+/* the kernels themselves */
+void Skein_256_Process_Block_altivec(Skein_256_Ctxt_t * ctx,
+				     const u08b_t * blkPtr, size_t blkCnt,
+				     size_t byteCntAdd);
+void Skein_512_Process_Block_altivec(Skein_512_Ctxt_t * ctx,
+				     const u08b_t * blkPtr, size_t blkCnt,
+				     size_t byteCntAdd);
+void Skein1024_Process_Block_altivec(Skein1024_Ctxt_t * ctx,
+				     const u08b_t * blkPtr, size_t blkCnt,
+				     size_t byteCntAdd);
+void Skein_512_Process_Block_x2_altivec(Skein_512_Ctxt_t * ctx[2],
+					const u08b_t * blkPtr[2], size_t blkCnt,
+					const size_t byteCntAdd[2]);
+void Skein_512_Process_Block_x4_altivec(Skein_512_Ctxt_t * ctx[4],
+					const u08b_t * blkPtr[4], size_t blkCnt,
+					const size_t byteCntAdd[4]);
+void Skein_256_Process_Block_aligned_altivec(Skein_256_Ctxt_t * ctx,
+					     const u08b_t * blkPtr, size_t blkCnt,
+					     size_t byteCntAdd);
+void Skein_512_Process_Block_aligned_altivec(Skein_512_Ctxt_t * ctx,
+					     const u08b_t * blkPtr, size_t blkCnt,
+					     size_t byteCntAdd);
+void Skein1024_Process_Block_aligned_altivec(Skein1024_Ctxt_t * ctx,
+					     const u08b_t * blkPtr, size_t blkCnt,
+					     size_t byteCntAdd);
+
+void Skein_256_Process_Block_vsx(Skein_256_Ctxt_t * ctx,
+				 const u08b_t * blkPtr, size_t blkCnt,
+				 size_t byteCntAdd);
+void Skein_512_Process_Block_vsx(Skein_512_Ctxt_t * ctx,
+				 const u08b_t * blkPtr, size_t blkCnt,
+				 size_t byteCntAdd);
+void Skein1024_Process_Block_vsx(Skein1024_Ctxt_t * ctx,
+				 const u08b_t * blkPtr, size_t blkCnt,
+				 size_t byteCntAdd);
+void Skein_512_Process_Block_x2_vsx(Skein_512_Ctxt_t * ctx[2],
+				    const u08b_t * blkPtr[2], size_t blkCnt,
+				    const size_t byteCntAdd[2]);
+void Skein_512_Process_Block_x4_vsx(Skein_512_Ctxt_t * ctx[4],
+				    const u08b_t * blkPtr[4], size_t blkCnt,
+				    const size_t byteCntAdd[4]);
+
+void Skein_256_Process_Block_sse2(Skein_256_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd);
+void Skein_512_Process_Block_sse2(Skein_512_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd);
+void Skein1024_Process_Block_sse2(Skein1024_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd);
+void Skein_512_Process_Block_x2_sse2(Skein_512_Ctxt_t * ctx[2],
+				     const u08b_t * blkPtr[2], size_t blkCnt,
+				     const size_t byteCntAdd[2]);
+void Skein_512_Process_Block_x4_sse2(Skein_512_Ctxt_t * ctx[4],
+				     const u08b_t * blkPtr[4], size_t blkCnt,
+				     const size_t byteCntAdd[4]);
+
+/* AVX2 only for the four lanes, the rest is the scalar code */
+void Skein_512_Process_Block_x4_avx2(Skein_512_Ctxt_t * ctx[4],
+				     const u08b_t * blkPtr[4], size_t blkCnt,
+				     const size_t byteCntAdd[4]);
+
+void Skein_256_Process_Block_neon(Skein_256_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd);
+void Skein_512_Process_Block_neon(Skein_512_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd);
+void Skein1024_Process_Block_neon(Skein1024_Ctxt_t * ctx,
+				  const u08b_t * blkPtr, size_t blkCnt,
+				  size_t byteCntAdd);
+void Skein_512_Process_Block_x2_neon(Skein_512_Ctxt_t * ctx[2],
+				     const u08b_t * blkPtr[2], size_t blkCnt,
+				     const size_t byteCntAdd[2]);
+void Skein_512_Process_Block_x4_neon(Skein_512_Ctxt_t * ctx[4],
+				     const u08b_t * blkPtr[4], size_t blkCnt,
+				     const size_t byteCntAdd[4]);
+
+void Skein_256_Process_Block_scalar(Skein_256_Ctxt_t * ctx,
+				    const u08b_t * blkPtr, size_t blkCnt,
+				    size_t byteCntAdd);
+void Skein_512_Process_Block_scalar(Skein_512_Ctxt_t * ctx,
+				    const u08b_t * blkPtr, size_t blkCnt,
+				    size_t byteCntAdd);
+void Skein1024_Process_Block_scalar(Skein1024_Ctxt_t * ctx,
+				    const u08b_t * blkPtr, size_t blkCnt,
+				    size_t byteCntAdd);
+void Skein_512_Process_Block_x2_scalar(Skein_512_Ctxt_t * ctx[2],
+				       const u08b_t * blkPtr[2], size_t blkCnt,
+				       const size_t byteCntAdd[2]);
+void Skein_512_Process_Block_x4_scalar(Skein_512_Ctxt_t * ctx[4],
+				       const u08b_t * blkPtr[4], size_t blkCnt,
+				       const size_t byteCntAdd[4]);
+
+#if SKEIN_STATS
+/* count and time every call, then call the kernel (see skein_stats.c) */
+void Skein_256_Process_Block_Stats(Skein_256_Ctxt_t * ctx,
+				   const u08b_t * blkPtr, size_t blkCnt,
+				   size_t byteCntAdd);
+void Skein_512_Process_Block_Stats(Skein_512_Ctxt_t * ctx,
+				   const u08b_t * blkPtr, size_t blkCnt,
+				   size_t byteCntAdd);
+void Skein1024_Process_Block_Stats(Skein1024_Ctxt_t * ctx,
+				   const u08b_t * blkPtr, size_t blkCnt,
+				   size_t byteCntAdd);
+void Skein_512_Process_Block_x2_Stats(Skein_512_Ctxt_t * ctx[2],
+				      const u08b_t * blkPtr[2], size_t blkCnt,
+				      const size_t byteCntAdd[2]);
+void Skein_512_Process_Block_x4_Stats(Skein_512_Ctxt_t * ctx[4],
+				      const u08b_t * blkPtr[4], size_t blkCnt,
+				      const size_t byteCntAdd[4]);
+void Skein_256_Process_Block_Aligned_Stats(Skein_256_Ctxt_t * ctx,
+					   const u08b_t * blkPtr, size_t blkCnt,
+					   size_t byteCntAdd);
+void Skein_512_Process_Block_Aligned_Stats(Skein_512_Ctxt_t * ctx,
+					   const u08b_t * blkPtr, size_t blkCnt,
+					   size_t byteCntAdd);
+void Skein1024_Process_Block_Aligned_Stats(Skein1024_Ctxt_t * ctx,
+					   const u08b_t * blkPtr, size_t blkCnt,
+					   size_t byteCntAdd);
+
+#define Skein_256_Process_Block		Skein_256_Process_Block_Stats
+#define Skein_512_Process_Block		Skein_512_Process_Block_Stats
+#define Skein1024_Process_Block		Skein1024_Process_Block_Stats
+#define Skein_512_Process_Block_x2	Skein_512_Process_Block_x2_Stats
+#define Skein_512_Process_Block_x4	Skein_512_Process_Block_x4_Stats
+#define Skein_256_Process_Block_Aligned	Skein_256_Process_Block_Aligned_Stats
+#define Skein_512_Process_Block_Aligned	Skein_512_Process_Block_Aligned_Stats
+#define Skein1024_Process_Block_Aligned	Skein1024_Process_Block_Aligned_Stats
+#else
+/* External functions to process blkCnt (nonzero) full block(s) of data. */
+#define Skein_256_Process_Block		(Skein_Kernel->process_256)
+#define Skein_512_Process_Block		(Skein_Kernel->process_512)
+#define Skein1024_Process_Block		(Skein_Kernel->process_1024)
+#define Skein_512_Process_Block_x2	(Skein_Kernel->process_512_x2)
+#define Skein_512_Process_Block_x4	(Skein_Kernel->process_512_x4)
+
+/* The same for 16-byte aligned blkPtr, which the kernels can load faster. */
+#define Skein_256_Process_Block_Aligned	(Skein_Kernel->process_256_aligned)
+#define Skein_512_Process_Block_Aligned	(Skein_Kernel->process_512_aligned)
+#define Skein1024_Process_Block_Aligned	(Skein_Kernel->process_1024_aligned)
+#endif
+#define Skein_Is_Aligned(ptr)		((((size_t) (ptr)) & (SKEIN_ALIGNMENT - 1)) == 0)
+
+#endif				/* ifndef _SKEIN_KERNEL_H_ */
@@ -0,0 +1,125 @@
+/***********************************************************************
+**
+** Implementation of Skein-MAC with prepared keys.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <string.h>		/* get the memcpy/memset functions */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_mac.h"
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* run the key and config blocks once */
+int Skein_512_MAC_Prepare(Skein_512_Prepared_t * prep, size_t hashBitLen,
+			  const u08b_t * key, size_t keyBytes)
+{
+	return Skein_512_InitExt(&prep->ctx, hashBitLen,
+				 SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, keyBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* start a MAC computation: a copy of the prepared context */
+int Skein_512_MAC_Begin(const Skein_512_Prepared_t * prep,
+			Skein_512_Ctxt_t * ctx)
+{
+	Skein_Assert(prep->ctx.h.bCnt == 0, SKEIN_FAIL);	/* catch unprepared keys */
+
+	memcpy(ctx, &prep->ctx, sizeof(*ctx));
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* all-in-one MAC with a prepared key */
+int Skein_512_MAC(const Skein_512_Prepared_t * prep, const u08b_t * msg,
+		  size_t msgByteCnt, u08b_t * mac)
+{
+	Skein_512_Ctxt_t ctx;
+
+	if (Skein_512_MAC_Begin(prep, &ctx) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	Skein_512_Update(&ctx, msg, msgByteCnt);
+	return Skein_512_Final(&ctx, mac);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* LRU cache of prepared keys */
+void Skein_512_MAC_Cache_Init(Skein_512_MAC_Cache_t * cache)
+{
+	memset(cache, 0, sizeof(*cache));
+}
+
+/* zero key material, with stores that are not optimized away */
+static void Skein_512_MAC_Wipe(void *buf, size_t bytes)
+{
+	volatile u08b_t *p = (volatile u08b_t *) buf;
+	size_t i;
+
+	for (i = 0; i < bytes; i++)
+		p[i] = 0;
+}
+
+void Skein_512_MAC_Cache_Clear(Skein_512_MAC_Cache_t * cache)
+{
+	Skein_512_MAC_Wipe(cache, sizeof(*cache));
+}
+
+/* the cache key: the key itself, or the hash of a longer one */
+static void Skein_512_MAC_Cache_Key(u08b_t * tag, const u08b_t * key,
+				    size_t keyBytes)
+{
+	Skein_512_Ctxt_t ctx;
+
+	if (keyBytes <= SKEIN_MAC_CACHE_KEY_BYTES) {
+		if (keyBytes > 0)
+			memcpy(tag, key, keyBytes);
+		return;
+	}
+	Skein_512_Init(&ctx, 8 * SKEIN_MAC_CACHE_KEY_BYTES);
+	Skein_512_Update(&ctx, key, keyBytes);
+	Skein_512_Final(&ctx, tag);
+	Skein_512_MAC_Wipe(&ctx, sizeof(ctx));
+}
+
+const Skein_512_Prepared_t *Skein_512_MAC_Cache_Get(Skein_512_MAC_Cache_t *
+						    cache, size_t hashBitLen,
+						    const u08b_t * key,
+						    size_t keyBytes)
+{
+	Skein_512_MAC_Cache_Entry_t *e, *lru = &cache->entry[0];
+	u08b_t tag[SKEIN_MAC_CACHE_KEY_BYTES];
+	size_t i, tagBytes;
+
+	tagBytes = (keyBytes < SKEIN_MAC_CACHE_KEY_BYTES) ? keyBytes : SKEIN_MAC_CACHE_KEY_BYTES;
+	Skein_512_MAC_Cache_Key(tag, key, keyBytes);
+	cache->clock++;
+
+	for (i = 0; i < SKEIN_MAC_CACHE_SIZE; i++) {
+		e = &cache->entry[i];
+		if (e->used != 0 && e->keyBytes == keyBytes
+		    && e->hashBitLen == hashBitLen
+		    && memcmp(e->key, tag, tagBytes) == 0) {
+			e->used = cache->clock;
+			Skein_512_MAC_Wipe(tag, sizeof(tag));
+			return &e->prep;
+		}
+		if (e->used < lru->used)
+			lru = e;
+	}
+
+	/* not found: replace the least recently used key */
+	lru->used = 0;
+	if (Skein_512_MAC_Prepare(&lru->prep, hashBitLen, key, keyBytes) !=
+	    SKEIN_SUCCESS) {
+		Skein_512_MAC_Wipe(tag, sizeof(tag));
+		return NULL;
+	}
+
+	lru->used = cache->clock;
+	memcpy(lru->key, tag, tagBytes);
+	lru->hashBitLen = hashBitLen;
+	lru->keyBytes = keyBytes;
+	Skein_512_MAC_Wipe(tag, sizeof(tag));
+	return &lru->prep;
+}
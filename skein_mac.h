@@ -0,0 +1,73 @@
+#ifndef _SKEIN_MAC_H_
+#define _SKEIN_MAC_H_
+/***********************************************************************
+**
+** Interface declarations for Skein-MAC with prepared keys.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** InitExt() with a key runs the key block(s) and the config block. Both
+** only depend on the key and the MAC size, so MAC_Prepare() does this
+** once, and MAC_Begin() just copies the result into a context that is
+** then used with Update()/Final() as usual.
+**
+** The cache keeps the prepared state of the most recently used keys. It
+** does no locking, use one cache per thread.
+**
+***********************************************************************/
+
+#include "skein.h"
+
+typedef struct {
+	Skein_512_Ctxt_t ctx;	/* the context right after InitExt() */
+} Skein_512_Prepared_t;
+
+int Skein_512_MAC_Prepare(Skein_512_Prepared_t * prep, size_t hashBitLen,
+			  const u08b_t * key, size_t keyBytes);
+int Skein_512_MAC_Begin(const Skein_512_Prepared_t * prep,
+			Skein_512_Ctxt_t * ctx);
+/* all-in-one MAC with a prepared key */
+int Skein_512_MAC(const Skein_512_Prepared_t * prep, const u08b_t * msg,
+		  size_t msgByteCnt, u08b_t * mac);
+
+#ifndef SKEIN_MAC_CACHE_SIZE
+#define SKEIN_MAC_CACHE_SIZE      (16)	/* keys in the cache */
+#endif
+#ifndef SKEIN_MAC_CACHE_KEY_BYTES
+#define SKEIN_MAC_CACHE_KEY_BYTES (64)	/* longer keys are found by their hash */
+#endif
+#if SKEIN_MAC_CACHE_KEY_BYTES < 32
+#error SKEIN_MAC_CACHE_KEY_BYTES must be at least 32 (the key hash)
+#endif
+
+typedef struct {
+	Skein_512_Prepared_t prep;
+	size_t hashBitLen;
+	size_t keyBytes;
+	unsigned long used;	/* "time" of the last lookup, for LRU, 0: slot not in use */
+	u08b_t key[SKEIN_MAC_CACHE_KEY_BYTES];	/* the key, or the hash of a longer one */
+} Skein_512_MAC_Cache_Entry_t;
+
+typedef struct {
+	Skein_512_MAC_Cache_Entry_t entry[SKEIN_MAC_CACHE_SIZE];
+	unsigned long clock;
+} Skein_512_MAC_Cache_t;
+
+void Skein_512_MAC_Cache_Init(Skein_512_MAC_Cache_t * cache);
+/* forget (and wipe) all keys */
+void Skein_512_MAC_Cache_Clear(Skein_512_MAC_Cache_t * cache);
+/*
+** Look up the prepared key, preparing it (in the least recently used
+** slot) if needed. Keys longer than SKEIN_MAC_CACHE_KEY_BYTES are looked
+** up by their Skein-512 hash, and the empty key is cached too. The slot can
+** be reused by the next Get() call, so the pointer is only valid until then.
+** NULL is returned if the key cannot be prepared.
+*/
+const Skein_512_Prepared_t *Skein_512_MAC_Cache_Get(Skein_512_MAC_Cache_t *
+						    cache, size_t hashBitLen,
+						    const u08b_t * key,
+						    size_t keyBytes);
+
+#endif				/* ifndef _SKEIN_MAC_H_ */
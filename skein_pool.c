@@ -0,0 +1,462 @@
+/***********************************************************************
+**
+** Implementation of the Skein hashing thread pool.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <stdlib.h>		/* get the malloc/free functions */
+#include <string.h>		/* get the memset function */
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>		/* get sched_yield */
+#include <unistd.h>		/* get sysconf */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_pool.h"
+#include "skein_tree.h"		/* get the tree node functions */
+
+#ifndef SKEIN_POOL_MAX_THREADS
+#define SKEIN_POOL_MAX_THREADS (256)	/* the threads parameter is capped at this */
+#endif
+#ifndef SKEIN_POOL_QUEUE_SIZE
+#define SKEIN_POOL_QUEUE_SIZE (1024)	/* tasks per thread queue, a power of 2 */
+#endif
+#ifndef SKEIN_POOL_LEAF_TASKS
+#define SKEIN_POOL_LEAF_TASKS (4)	/* leaf tasks of a tree job per thread */
+#endif
+
+#define SKEIN_POOL_QUEUE_MASK (SKEIN_POOL_QUEUE_SIZE - 1)
+
+/*
+ * The queue of a thread is a Chase-Lev deque: the owner pushes and pops
+ * at the bottom, the other threads steal from the top. Tasks submitted by
+ * other threads go to the inbox, a lock-free stack, first.
+ */
+typedef struct {
+	long top, bottom;
+	Skein_Pool_Task_t *slot[SKEIN_POOL_QUEUE_SIZE];
+	Skein_Pool_Task_t *inbox;
+	Skein_Pool_t *pool;
+	uint_t index;
+	pthread_t tid;
+} __attribute__((aligned(64))) Skein_Pool_Worker_t;	/* no false sharing */
+
+struct Skein_Pool {
+	Skein_Pool_Worker_t *worker;
+	uint_t threads, started;
+	sem_t work;		/* one count per task not taken yet, plus one per thread to stop */
+	size_t pending;		/* tasks not taken yet (atomic) */
+	size_t nextWorker;	/* inbox for the next submit from outside (atomic) */
+	int stop;
+};
+
+/* the pool thread we are running on, NULL elsewhere */
+static __thread Skein_Pool_Worker_t *Skein_Pool_Self;
+
+static void Skein_Pool_Run(Skein_Pool_Worker_t * self, Skein_Pool_Task_t * t);
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* owner only: add a task at the bottom, 0 if the queue is full */
+static int Skein_Pool_Push(Skein_Pool_Worker_t * w, Skein_Pool_Task_t * t)
+{
+	long b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED);
+	long top = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+
+	if (b - top >= SKEIN_POOL_QUEUE_SIZE)
+		return 0;
+	__atomic_store_n(&w->slot[b & SKEIN_POOL_QUEUE_MASK], t, __ATOMIC_RELAXED);
+	__atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+/* owner only: the newest task, or NULL */
+static Skein_Pool_Task_t *Skein_Pool_Pop(Skein_Pool_Worker_t * w)
+{
+	long b = __atomic_load_n(&w->bottom, __ATOMIC_RELAXED) - 1;
+	long top;
+	Skein_Pool_Task_t *t;
+
+	__atomic_store_n(&w->bottom, b, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	top = __atomic_load_n(&w->top, __ATOMIC_RELAXED);
+	if (top > b) {		/* empty */
+		__atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	t = __atomic_load_n(&w->slot[b & SKEIN_POOL_QUEUE_MASK], __ATOMIC_RELAXED);
+	if (top == b) {		/* the last one: the thieves may want it too */
+		if (!__atomic_compare_exchange_n(&w->top, &top, top + 1, 0,
+						 __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			t = NULL;
+		__atomic_store_n(&w->bottom, b + 1, __ATOMIC_RELAXED);
+	}
+	return t;
+}
+
+/* any thread: the oldest task, or NULL */
+static Skein_Pool_Task_t *Skein_Pool_Steal(Skein_Pool_Worker_t * w)
+{
+	long top = __atomic_load_n(&w->top, __ATOMIC_ACQUIRE);
+	long b;
+	Skein_Pool_Task_t *t;
+
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	b = __atomic_load_n(&w->bottom, __ATOMIC_ACQUIRE);
+	if (top >= b)
+		return NULL;
+	t = __atomic_load_n(&w->slot[top & SKEIN_POOL_QUEUE_MASK], __ATOMIC_RELAXED);
+	if (!__atomic_compare_exchange_n(&w->top, &top, top + 1, 0,
+					 __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+		return NULL;	/* somebody else got it */
+	return t;
+}
+
+/* any thread: add a task to the inbox of w */
+static void Skein_Pool_Inbox_Push(Skein_Pool_Worker_t * w, Skein_Pool_Task_t * t)
+{
+	Skein_Pool_Task_t *head = __atomic_load_n(&w->inbox, __ATOMIC_RELAXED);
+
+	do
+		t->next = head;
+	while (!__atomic_compare_exchange_n(&w->inbox, &head, t, 1,
+					    __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+/* move all tasks in the inbox of w to our own queue, 0 if there were none */
+static int Skein_Pool_Refill(Skein_Pool_Worker_t * self, Skein_Pool_Worker_t * w)
+{
+	Skein_Pool_Task_t *t, *next;
+
+	if (__atomic_load_n(&w->inbox, __ATOMIC_RELAXED) == NULL)
+		return 0;
+	t = __atomic_exchange_n(&w->inbox, NULL, __ATOMIC_ACQUIRE);
+	if (t == NULL)
+		return 0;
+
+	/* the newest first, so the oldest ends up at the bottom and is popped first */
+	for (; t != NULL; t = next) {
+		next = t->next;
+		if (!Skein_Pool_Push(self, t))
+			Skein_Pool_Inbox_Push(self, t);	/* full: keep it for later */
+	}
+	return 1;
+}
+
+/* queue a task on w (our own queue if w is us), the caller posts the semaphore */
+static void Skein_Pool_Queue(Skein_Pool_Worker_t * w, Skein_Pool_Task_t * t)
+{
+	if (w != Skein_Pool_Self || !Skein_Pool_Push(w, t))
+		Skein_Pool_Inbox_Push(w, t);
+}
+
+/* take a task from our own queue, then from the other threads, or NULL */
+static Skein_Pool_Task_t *Skein_Pool_Find(Skein_Pool_Worker_t * self)
+{
+	Skein_Pool_t *pool = self->pool;
+	Skein_Pool_Worker_t *w;
+	Skein_Pool_Task_t *t;
+	uint_t i;
+
+	if ((t = Skein_Pool_Pop(self)) != NULL)
+		goto found;
+	if (Skein_Pool_Refill(self, self) && (t = Skein_Pool_Pop(self)) != NULL)
+		goto found;
+
+	for (i = 1; i < pool->threads; i++) {	/* starting with the next thread */
+		w = &pool->worker[(self->index + i) % pool->threads];
+		if ((t = Skein_Pool_Steal(w)) != NULL)
+			goto found;
+		if (Skein_Pool_Refill(self, w) && (t = Skein_Pool_Pop(self)) != NULL)
+			goto found;
+	}
+	return NULL;
+
+      found:
+	__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_RELEASE);
+	return t;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hand a finished job back */
+static void Skein_Pool_Done(Skein_Pool_Job_t * job)
+{
+	if (job->done != NULL)
+		job->done(job);
+}
+
+/* hash one sequential job */
+static void Skein_Pool_Hash_One(Skein_Pool_Job_t * job)
+{
+	hashState s;
+
+	job->ret = Skein_Tree_Init(&s, job->stateBits, job->hashBitLen,
+				   SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+				   job->key, job->keyBytes);
+	if (job->ret == SKEIN_SUCCESS) {
+		switch ((s.statebits >> 8) & 3) {
+		case 2:
+			Skein_512_Update(&s.u.ctx_512, job->msg, job->msgByteCnt);
+			job->ret = Skein_512_Final(&s.u.ctx_512, job->hashVal);
+			break;
+		case 1:
+			Skein_256_Update(&s.u.ctx_256, job->msg, job->msgByteCnt);
+			job->ret = Skein_256_Final(&s.u.ctx_256, job->hashVal);
+			break;
+		default:
+			Skein1024_Update(&s.u.ctx1024, job->msg, job->msgByteCnt);
+			job->ret = Skein1024_Final(&s.u.ctx1024, job->hashVal);
+			break;
+		}
+	}
+	Skein_Pool_Done(job);
+}
+
+/* hash up to four sequential 512 bit jobs with the multi-buffer kernels */
+static void Skein_Pool_Hash_512(Skein_Pool_Job_t * job[], size_t cnt)
+{
+	Skein_512_Ctxt_t ctx[4], *lctx[4];
+	const u08b_t *msg[4];
+	size_t len[4] = { 0, 0, 0, 0 };	/* only len[0..lanes-1] is read, gcc cannot tell */
+	u08b_t *hashVal[4];
+	size_t i, lanes = 0;
+
+	for (i = 0; i < cnt; i++) {
+		job[i]->ret = Skein_512_InitExt(&ctx[lanes], job[i]->hashBitLen,
+						SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+						job[i]->key, job[i]->keyBytes);
+		if (job[i]->ret != SKEIN_SUCCESS)
+			continue;
+		lctx[lanes] = &ctx[lanes];
+		msg[lanes] = job[i]->msg;
+		len[lanes] = job[i]->msgByteCnt;
+		hashVal[lanes++] = job[i]->hashVal;
+	}
+	Skein_512_Hash_Many(lctx, msg, len, hashVal, lanes);
+
+	for (i = 0; i < cnt; i++)
+		Skein_Pool_Done(job[i]);
+}
+
+/* hash the leaf nodes of a task, the last task of the job does the rest of the tree */
+static void Skein_Pool_Leaves(Skein_Pool_Task_t * t)
+{
+	Skein_Pool_Job_t *job = t->job;
+	size_t blkBytes = job->stateBits / 8;
+	size_t i, offs, n;
+
+	for (i = t->first; i < t->first + t->count; i++) {
+		offs = i * job->leafBytes;
+		n = job->msgByteCnt - offs;	/* number of bytes left */
+		if (n > job->leafBytes)	/* limit to leaf size */
+			n = job->leafBytes;
+		Skein_Tree_Node(&job->iv, 1, offs, job->msg + offs, n,
+				job->leaves + i * blkBytes);
+	}
+
+	if (__atomic_sub_fetch(&job->tasksLeft, 1, __ATOMIC_ACQ_REL) == 0) {
+		job->ret = Skein_Tree_Finish(&job->iv, job->treeInfo, job->leaves,
+					     job->leafCnt, job->hashVal);
+		free(job->leaves);
+		free(job->leafTasks);
+		Skein_Pool_Done(job);
+	}
+}
+
+/* cut a tree job into leaf tasks for the other threads to steal */
+static void Skein_Pool_Split(Skein_Pool_Worker_t * self, Skein_Pool_Job_t * job)
+{
+	Skein_Pool_t *pool = self->pool;
+	size_t tasks, i, first;
+
+	job->ret = Skein_Tree_Init(&job->iv, job->stateBits, job->hashBitLen,
+				   job->treeInfo, job->key, job->keyBytes);
+	if (job->ret != SKEIN_SUCCESS) {
+		Skein_Pool_Done(job);
+		return;
+	}
+
+	job->leafBytes = Skein_Tree_Leaf_Bytes(job->stateBits, job->treeInfo);
+	job->leafCnt = job->msgByteCnt ? (job->msgByteCnt - 1) / job->leafBytes + 1 : 1;
+	tasks = SKEIN_POOL_LEAF_TASKS * (size_t) pool->threads;
+	if (tasks > job->leafCnt)
+		tasks = job->leafCnt;
+
+	job->leaves = malloc(job->leafCnt * (job->stateBits / 8));
+	job->leafTasks = malloc(tasks * sizeof(job->leafTasks[0]));
+	if (job->leaves == NULL || job->leafTasks == NULL) {
+		free(job->leaves);
+		free(job->leafTasks);
+		job->ret = SKEIN_FAIL;
+		Skein_Pool_Done(job);
+		return;
+	}
+
+	for (i = first = 0; i < tasks; i++) {	/* spread the leaves evenly */
+		job->leafTasks[i].job = job;
+		job->leafTasks[i].first = first;
+		job->leafTasks[i].count = job->leafCnt / tasks + (i < job->leafCnt % tasks);
+		first += job->leafTasks[i].count;
+	}
+	job->tasksLeft = tasks;
+
+	__atomic_add_fetch(&pool->pending, tasks - 1, __ATOMIC_RELEASE);
+	for (i = 1; i < tasks; i++) {
+		Skein_Pool_Queue(self, &job->leafTasks[i]);
+		sem_post(&pool->work);
+	}
+	Skein_Pool_Leaves(&job->leafTasks[0]);	/* and work on it ourselves */
+}
+
+/* a sequential 512 bit job, the ones that go into the multi-buffer kernels */
+static int Skein_Pool_Is_Lane(const Skein_Pool_Task_t * t)
+{
+	return t == &t->job->task && t->job->stateBits == 512 &&
+	    t->job->treeInfo == SKEIN_CFG_TREE_INFO_SEQUENTIAL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* run a task, with more queued 512 bit jobs if it is one */
+static void Skein_Pool_Run(Skein_Pool_Worker_t * self, Skein_Pool_Task_t * t)
+{
+	Skein_Pool_t *pool = self->pool;
+	Skein_Pool_Job_t *job[4];
+	Skein_Pool_Task_t *other = NULL;
+	size_t cnt;
+
+	if (t != &t->job->task) {
+		Skein_Pool_Leaves(t);
+		return;
+	}
+	if (t->job->treeInfo != SKEIN_CFG_TREE_INFO_SEQUENTIAL) {
+		Skein_Pool_Split(self, t->job);
+		return;
+	}
+	if (!Skein_Pool_Is_Lane(t)) {
+		Skein_Pool_Hash_One(t->job);
+		return;
+	}
+
+	/* only take as many tasks as there are counts: each one is somebody's job */
+	job[0] = t->job;
+	for (cnt = 1; cnt < 4 && sem_trywait(&pool->work) == 0; cnt++) {
+		if ((t = Skein_Pool_Find(self)) == NULL) {
+			sem_post(&pool->work);	/* somebody else is just getting it */
+			break;
+		}
+		if (!Skein_Pool_Is_Lane(t)) {
+			other = t;
+			break;
+		}
+		job[cnt] = t->job;
+	}
+	Skein_Pool_Hash_512(job, cnt);
+
+	if (other != NULL)
+		Skein_Pool_Run(self, other);
+}
+
+/* a pool thread: wait for a task count, then find the task */
+static void *Skein_Pool_Thread(void *arg)
+{
+	Skein_Pool_Worker_t *self = arg;
+	Skein_Pool_t *pool = self->pool;
+	Skein_Pool_Task_t *t;
+
+	Skein_Pool_Self = self;
+	for (;;) {
+		while (sem_wait(&pool->work) != 0)
+			;	/* EINTR */
+		while ((t = Skein_Pool_Find(self)) == NULL) {
+			if (__atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) == 0 &&
+			    __atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE))
+				return NULL;	/* no task left for this count */
+			sched_yield();	/* it is on its way into a queue */
+		}
+		Skein_Pool_Run(self, t);
+	}
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* start the pool threads */
+Skein_Pool_t *Skein_Pool_Create(uint_t threads)
+{
+	Skein_Pool_t *pool;
+	uint_t i;
+
+	if (threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (uint_t) cpus : 1;
+	}
+	if (threads > SKEIN_POOL_MAX_THREADS)
+		threads = SKEIN_POOL_MAX_THREADS;
+
+	pool = malloc(sizeof(*pool));
+	if (pool == NULL)
+		return NULL;
+	memset(pool, 0, sizeof(*pool));
+	if (posix_memalign((void **) &pool->worker, 64,
+			   threads * sizeof(pool->worker[0]))) {
+		free(pool);
+		return NULL;
+	}
+	memset(pool->worker, 0, threads * sizeof(pool->worker[0]));
+	pool->threads = threads;
+	sem_init(&pool->work, 0, 0);
+
+	for (i = 0; i < threads; i++) {
+		pool->worker[i].pool = pool;
+		pool->worker[i].index = i;
+	}
+	for (i = 0; i < threads; i++) {
+		if (pthread_create(&pool->worker[i].tid, NULL, Skein_Pool_Thread,
+				   &pool->worker[i])) {
+			Skein_Pool_Destroy(pool);
+			return NULL;
+		}
+		pool->started++;
+	}
+	return pool;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* queue a job for the pool threads */
+int Skein_Pool_Submit(Skein_Pool_t * pool, Skein_Pool_Job_t * job)
+{
+	Skein_Pool_Worker_t *w = Skein_Pool_Self;
+
+	if (job->stateBits != 256 && job->stateBits != 512 && job->stateBits != 1024)
+		return SKEIN_FAIL;
+	if (job->treeInfo != SKEIN_CFG_TREE_INFO_SEQUENTIAL &&
+	    Skein_Tree_Leaf_Bytes(job->stateBits, job->treeInfo) == 0)
+		return SKEIN_FAIL;	/* not a valid tree */
+
+	job->task.job = job;
+	job->task.first = job->task.count = 0;
+
+	if (w == NULL || w->pool != pool)	/* not one of our threads: spread the jobs */
+		w = &pool->worker[__atomic_fetch_add(&pool->nextWorker, 1, __ATOMIC_RELAXED)
+				  % pool->threads];
+	__atomic_add_fetch(&pool->pending, 1, __ATOMIC_RELEASE);
+	Skein_Pool_Queue(w, &job->task);
+	sem_post(&pool->work);
+
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* run all jobs, then stop the threads */
+void Skein_Pool_Destroy(Skein_Pool_t * pool)
+{
+	uint_t i;
+
+	__atomic_store_n(&pool->stop, 1, __ATOMIC_RELEASE);
+	for (i = 0; i < pool->started; i++)
+		sem_post(&pool->work);	/* one count for each thread to stop on */
+	for (i = 0; i < pool->started; i++)
+		pthread_join(pool->worker[i].tid, NULL);
+
+	sem_destroy(&pool->work);
+	free(pool->worker);
+	free(pool);
+}
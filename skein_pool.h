@@ -0,0 +1,75 @@
+#ifndef _SKEIN_POOL_H_
+#define _SKEIN_POOL_H_
+/***********************************************************************
+**
+** Interface declarations for the Skein hashing thread pool.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** A job is one message to hash (or MAC, with a key), submitted from any
+** thread. It is run on one of the pool threads, which then calls
+** job->done(job) with job->ret set. The job (and the message, key and
+** hashVal buffers) must stay valid until then.
+**
+** Each pool thread has its own queue and takes work from the others when
+** it runs out. Submit() only does atomic operations (and a semaphore post,
+** which is a system call only if a thread is sleeping), so it can be called
+** from I/O threads and from the done() callbacks.
+**
+** Sequential 512 bit jobs are hashed four at a time by the multi-buffer
+** kernels when there are enough of them queued. With a treeInfo (see
+** skein_tree.h) the leaf nodes of a job are spread over the pool threads.
+** Tree jobs give the tree hash, not the sequential one!
+**
+***********************************************************************/
+
+#include "skein.h"
+#include "SHA3api_ref.h"	/* get the hashState type */
+
+struct Skein_Pool_Job;
+
+/* a unit of work for a pool thread: a whole job, or some of its leaves */
+typedef struct Skein_Pool_Task {
+	struct Skein_Pool_Job *job;
+	size_t first, count;	/* leaf nodes (tree jobs only) */
+	struct Skein_Pool_Task *next;	/* in the submit list */
+} Skein_Pool_Task_t;
+
+typedef struct Skein_Pool_Job {
+	/* set by the caller */
+	const u08b_t *msg;
+	size_t msgByteCnt;
+	uint_t stateBits;	/* 256, 512 or 1024 */
+	size_t hashBitLen;
+	const u08b_t *key;	/* MAC key, or NULL */
+	size_t keyBytes;
+	u64b_t treeInfo;	/* SKEIN_CFG_TREE_INFO_SEQUENTIAL, or a tree */
+	u08b_t *hashVal;	/* (hashBitLen + 7) / 8 bytes */
+	void (*done) (struct Skein_Pool_Job * job);	/* called on a pool thread */
+	void *arg;		/* for the callback */
+
+	/* set by the pool */
+	int ret;		/* SKEIN_SUCCESS or SKEIN_FAIL */
+
+	/* private */
+	Skein_Pool_Task_t task;
+	hashState iv;		/* tree jobs: the chaining input of all nodes */
+	Skein_Pool_Task_t *leafTasks;
+	u08b_t *leaves;		/* the leaf results */
+	size_t leafBytes, leafCnt;
+	size_t tasksLeft;	/* leaf tasks still running (atomic) */
+} Skein_Pool_Job_t;
+
+typedef struct Skein_Pool Skein_Pool_t;
+
+/* start a pool with "threads" threads (0: one per online CPU), NULL on failure */
+Skein_Pool_t *Skein_Pool_Create(uint_t threads);
+/* queue a job, SKEIN_FAIL (and no callback) for a bad stateBits or treeInfo */
+int Skein_Pool_Submit(Skein_Pool_t * pool, Skein_Pool_Job_t * job);
+/* finish all submitted jobs (also those that done() submits), then stop the
+   threads and free the pool */
+void Skein_Pool_Destroy(Skein_Pool_t * pool);
+
+#endif				/* ifndef _SKEIN_POOL_H_ */
@@ -22,6 +22,17 @@ typedef unsigned int uint_t;	/* native unsigned integer */
 typedef uint_8t u08b_t;		/*  8-bit unsigned integer */
 typedef uint_64t u64b_t;	/* 64-bit unsigned integer */
 
+/*
+ * The vector units load 16 aligned bytes at a time, so the block buffers
+ * are aligned to that (SKEIN_ALIGNED is empty for unknown compilers).
+ */
+#define SKEIN_ALIGNMENT (16)
+#ifdef __GNUC__
+#define SKEIN_ALIGNED __attribute__((aligned(SKEIN_ALIGNMENT)))
+#else
+#define SKEIN_ALIGNED
+#endif
+
 /*
  * Skein is "natively" little-endian (unlike SHA-xxx), for optimal
  * performance on x86 CPUs.  The Skein code requires the following
@@ -31,14 +42,70 @@ typedef uint_64t u64b_t;	/* 64-bit unsigned integer */
  *    Skein_Get64_LSB_First
  *    Skein_Swap64
  *
- * In the reference code, these functions are implemented in a
- * very portable (and thus slow) fashion, for clarity. See the file
- * "skein_port.h" in the Optimized_Code directory for ways to make
- * these functions fast(er) on x86 platforms.
+ * The byte order is known at compile time (see brg_endian.h). On little
+ * endian CPUs these are no-ops and memcpy. On big endian ones the words
+ * are swapped with __builtin_bswap64 when the compiler has it (on POWER
+ * this becomes lwbrx/stwbrx resp. ldbrx/stdbrx), otherwise with the
+ * portable shift/or code.
  */
 
-u64b_t Skein_Swap64(u64b_t w64);
-void Skein_Put64_LSB_First(u08b_t * dst, const u64b_t * src, size_t bCnt);
-void Skein_Get64_LSB_First(u64b_t * dst, const u08b_t * src, size_t wCnt);
+#include <string.h>		/* get memcpy */
+#include "brg_endian.h"
+
+#ifndef SKEIN_NEED_SWAP		/* compile-time "override" for endianness? */
+#if   PLATFORM_BYTE_ORDER == IS_BIG_ENDIAN
+#define SKEIN_NEED_SWAP   (1)
+#elif PLATFORM_BYTE_ORDER == IS_LITTLE_ENDIAN
+#define SKEIN_NEED_SWAP   (0)
+#else
+#error "Skein needs endianness setting!"
+#endif
+#endif				/* ifndef SKEIN_NEED_SWAP */
+
+#if SKEIN_NEED_SWAP
+#if defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 3))
+#define Skein_Swap64(w64)  ((u64b_t) __builtin_bswap64(w64))
+#else
+#define Skein_Swap64(w64)                       \
+  ( (( ((u64b_t)(w64))       & 0xFF) << 56) |   \
+    (((((u64b_t)(w64)) >> 8) & 0xFF) << 48) |   \
+    (((((u64b_t)(w64)) >>16) & 0xFF) << 40) |   \
+    (((((u64b_t)(w64)) >>24) & 0xFF) << 32) |   \
+    (((((u64b_t)(w64)) >>32) & 0xFF) << 24) |   \
+    (((((u64b_t)(w64)) >>40) & 0xFF) << 16) |   \
+    (((((u64b_t)(w64)) >>48) & 0xFF) <<  8) |   \
+    (((((u64b_t)(w64)) >>56) & 0xFF)      ) )
+#endif
+
+static inline void Skein_Put64_LSB_First(u08b_t * dst, const u64b_t * src,
+					 size_t bCnt)
+{
+	size_t n;
+	u64b_t w;
+
+	for (n = 0; n + 8 <= bCnt; n += 8) {	/* whole words: one byte reversed store */
+		w = Skein_Swap64(src[n >> 3]);
+		memcpy(dst + n, &w, 8);
+	}
+	for (; n < bCnt; n++)	/* the partial word at the end */
+		dst[n] = (u08b_t) (src[n >> 3] >> (8 * (n & 7)));
+}
+
+static inline void Skein_Get64_LSB_First(u64b_t * dst, const u08b_t * src,
+					 size_t wCnt)
+{
+	size_t n;
+	u64b_t w;
+
+	for (n = 0; n < wCnt; n++) {	/* one byte reversed load per word */
+		memcpy(&w, src + 8 * n, 8);
+		dst[n] = Skein_Swap64(w);
+	}
+}
+#else				/* little endian: the bytes are already in order */
+#define Skein_Swap64(w64)  ((u64b_t) (w64))
+#define Skein_Put64_LSB_First(dst08, src64, bCnt) memcpy(dst08, src64, bCnt)
+#define Skein_Get64_LSB_First(dst64, src08, wCnt) memcpy(dst64, src08, 8 * (wCnt))
+#endif
 
 #endif				/* ifndef _SKEIN_PORT_H_ */
@@ -0,0 +1,153 @@
+/***********************************************************************
+**
+** Implementation of the Skein-512 PRNG.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <string.h>		/* get the memcpy/memset functions */
+#include <fcntl.h>		/* get open */
+#include <unistd.h>		/* get read/close */
+#include <pthread.h>		/* get pthread_atfork */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_prng.h"
+
+#define SKEIN_PRNG_END (SKEIN_512_BLOCK_BYTES + SKEIN_PRNG_BUF_BYTES)
+
+/* output blocks 0..n of the state: the next state, then n blocks of output at out */
+static void Skein_512_PRNG_Generate(Skein_512_PRNG_t * prng, u08b_t * out,
+				    size_t byteCnt)
+{
+	u64b_t G[SKEIN_512_STATE_WORDS];
+
+	if (out == prng->out + SKEIN_512_BLOCK_BYTES) {	/* all in one go */
+		Skein_512_Output_Blocks(&prng->ctx, 0, prng->out,
+					SKEIN_512_BLOCK_BYTES + byteCnt);
+	} else {
+		Skein_512_Output_Blocks(&prng->ctx, 1, out, byteCnt);
+		Skein_512_Output_Blocks(&prng->ctx, 0, prng->out,
+					SKEIN_512_BLOCK_BYTES);
+	}
+
+	/* the old state is gone now, only the next one is left */
+	Skein_Get64_LSB_First(G, prng->out, SKEIN_512_STATE_WORDS);
+	memcpy(prng->ctx.X, G, sizeof(G));
+	memset(G, 0, sizeof(G));
+	memset(prng->out, 0, SKEIN_512_BLOCK_BYTES);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the new state is UBI(G, seed, NONCE) */
+int Skein_512_PRNG_Reseed(Skein_512_PRNG_t * prng, const u08b_t * seed,
+			  size_t seedBytes)
+{
+	Skein_Start_New_Type(&prng->ctx, NONCE);
+	Skein_512_Update(&prng->ctx, seed, seedBytes);
+	Skein_512_Final_Pad(&prng->ctx, prng->out);	/* X is the new G */
+
+	memset(prng->out, 0, sizeof(prng->out));	/* drop the old output */
+	prng->pos = SKEIN_PRNG_END;
+
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* seed a PRNG from the all zero state */
+int Skein_512_PRNG_Init(Skein_512_PRNG_t * prng, const u08b_t * seed,
+			size_t seedBytes)
+{
+	memset(&prng->ctx, 0, sizeof(prng->ctx));	/* G = 0, in any word order */
+	prng->ctx.h.hashBitLen = 8 * SKEIN_512_BLOCK_BYTES;
+
+	return Skein_512_PRNG_Reseed(prng, seed, seedBytes);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* random bytes from the buffer, refilled one buffer size at a time */
+void Skein_512_PRNG_Bytes(Skein_512_PRNG_t * prng, u08b_t * out, size_t n)
+{
+	size_t k;
+
+	while (n) {
+		if (prng->pos == SKEIN_PRNG_END) {
+			if (n >= SKEIN_PRNG_BUF_BYTES) {	/* straight to the caller */
+				Skein_512_PRNG_Generate(prng, out, SKEIN_PRNG_BUF_BYTES);
+				out += SKEIN_PRNG_BUF_BYTES;
+				n -= SKEIN_PRNG_BUF_BYTES;
+				continue;
+			}
+			Skein_512_PRNG_Generate(prng, prng->out + SKEIN_512_BLOCK_BYTES,
+						SKEIN_PRNG_BUF_BYTES);
+			prng->pos = SKEIN_512_BLOCK_BYTES;
+		}
+		k = SKEIN_PRNG_END - prng->pos;	/* number of buffered bytes */
+		if (k > n)
+			k = n;
+		memcpy(out, prng->out + prng->pos, k);
+		prng->pos += k;
+		out += k;
+		n -= k;
+	}
+}
+
+/*****************************************************************/
+/*     The per-thread PRNG                                       */
+/*****************************************************************/
+
+static __thread Skein_512_PRNG_t Skein_PRNG_Local;
+static __thread unsigned int Skein_PRNG_Seeded;	/* Skein_PRNG_Forks + 1 once seeded */
+static unsigned int Skein_PRNG_Forks;
+static pthread_once_t Skein_PRNG_Once = PTHREAD_ONCE_INIT;
+
+/* the child of a fork must not repeat the parent's output */
+static void Skein_PRNG_Child(void)
+{
+	Skein_PRNG_Forks++;
+}
+
+static void Skein_PRNG_Atfork(void)
+{
+	pthread_atfork(NULL, NULL, Skein_PRNG_Child);
+}
+
+/* n bytes from the system, 0 on failure */
+static int Skein_PRNG_Urandom(u08b_t * seed, size_t n)
+{
+	ssize_t r;
+	int fd = open("/dev/urandom", O_RDONLY);
+
+	if (fd < 0)
+		return 0;
+	for (; n; n -= (size_t) r, seed += r) {
+		r = read(fd, seed, n);
+		if (r <= 0) {
+			close(fd);
+			return 0;
+		}
+	}
+	close(fd);
+	return 1;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* random bytes from this thread's PRNG */
+int Skein_Rand_Bytes(u08b_t * out, size_t n)
+{
+	u08b_t seed[SKEIN_512_STATE_BYTES];
+
+	if (Skein_PRNG_Seeded != Skein_PRNG_Forks + 1) {
+		pthread_once(&Skein_PRNG_Once, Skein_PRNG_Atfork);
+		if (!Skein_PRNG_Urandom(seed, sizeof(seed)))
+			return SKEIN_FAIL;
+		if (Skein_PRNG_Seeded)	/* after a fork: keep the old state too */
+			Skein_512_PRNG_Reseed(&Skein_PRNG_Local, seed, sizeof(seed));
+		else
+			Skein_512_PRNG_Init(&Skein_PRNG_Local, seed, sizeof(seed));
+		memset(seed, 0, sizeof(seed));
+		Skein_PRNG_Seeded = Skein_PRNG_Forks + 1;
+	}
+
+	Skein_512_PRNG_Bytes(&Skein_PRNG_Local, out, n);
+	return SKEIN_SUCCESS;
+}
@@ -0,0 +1,53 @@
+#ifndef _SKEIN_PRNG_H_
+#define _SKEIN_PRNG_H_
+/***********************************************************************
+**
+** Interface declarations for the Skein-512 PRNG.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** The PRNG of the Skein paper: the state G is one block. Reseeding
+** hashes G and the seed (a NONCE type UBI call) into the new G. Output is
+** the output stage with G as the key: block 0 is the next G, the blocks
+** after it are the random bytes.
+**
+** This version generates SKEIN_PRNG_BUF_BYTES at a time (with the
+** multi-buffer output kernel) into out[], so small requests are just a
+** copy. Requests of a full buffer or more are generated in place, in the
+** same buffer sized steps: the bytes do not depend on how the output is
+** split into requests.
+**
+** Note that the output stays in out[] until the next refill overwrites it.
+** A PRNG_t is not locked, use one per thread (Skein_Rand_Bytes() does).
+**
+***********************************************************************/
+
+#include "skein.h"
+
+#ifndef SKEIN_PRNG_BUF_BYTES
+#define SKEIN_PRNG_BUF_BYTES (64 * SKEIN_512_BLOCK_BYTES)	/* output per state update */
+#endif
+
+typedef struct {
+	Skein_512_Ctxt_t ctx;	/* X: the state G */
+	size_t pos;		/* next unused byte of out[] */
+	/* block 0 of the output stage (the next G), then the buffered output */
+	u08b_t out[SKEIN_512_BLOCK_BYTES + SKEIN_PRNG_BUF_BYTES] SKEIN_ALIGNED;
+} Skein_512_PRNG_t;
+
+/* start from the all zero state and reseed with seed[0..seedBytes-1] */
+int Skein_512_PRNG_Init(Skein_512_PRNG_t * prng, const u08b_t * seed,
+			size_t seedBytes);
+/* mix more seed into the state, buffered output is dropped */
+int Skein_512_PRNG_Reseed(Skein_512_PRNG_t * prng, const u08b_t * seed,
+			  size_t seedBytes);
+/* the next n random bytes */
+void Skein_512_PRNG_Bytes(Skein_512_PRNG_t * prng, u08b_t * out, size_t n);
+
+/* n bytes from this thread's PRNG, seeded from /dev/urandom on first use
+   (and again in the child after a fork), SKEIN_FAIL if it cannot be seeded */
+int Skein_Rand_Bytes(u08b_t * out, size_t n);
+
+#endif				/* ifndef _SKEIN_PRNG_H_ */
@@ -0,0 +1,143 @@
+/***********************************************************************
+**
+** Implementation of the Skein statistics counters.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <stdlib.h>		/* get the calloc function */
+#include <string.h>		/* get the memset function */
+#include <time.h>		/* get clock_gettime */
+#include "skein.h"
+#include "skein_stats.h"
+#include "skein_kernel.h"	/* get the kernel in use */
+
+#if SKEIN_STATS
+
+/* the counters of one thread, in a list of all threads ever counted */
+typedef struct Skein_Stats_Thread {
+	Skein_Stats_t stats;
+	struct Skein_Stats_Thread *next;
+} Skein_Stats_Thread_t;
+
+static Skein_Stats_Thread_t *Skein_Stats_All;
+static Skein_Stats_Thread_t Skein_Stats_Spare;	/* shared, if calloc fails */
+
+__thread Skein_Stats_t *Skein_Stats_Local;
+
+/* the first count of a thread: give it its own counters */
+Skein_Stats_t *Skein_Stats_Register(void)
+{
+	Skein_Stats_Thread_t *t = calloc(1, sizeof(*t));
+
+	if (t == NULL) {
+		Skein_Stats_Local = &Skein_Stats_Spare.stats;
+		return Skein_Stats_Local;
+	}
+	do
+		t->next = Skein_Stats_All;
+	while (!__sync_bool_compare_and_swap(&Skein_Stats_All, t->next, t));
+
+	Skein_Stats_Local = &t->stats;	/* kept after the thread exits */
+	return Skein_Stats_Local;
+}
+
+static inline u64b_t Skein_Stats_Ticks(void)
+{
+#if defined(__powerpc64__)
+	u64b_t tb;
+
+	__asm__ __volatile__("mftb %0" : "=r"(tb));
+	return tb;
+#elif defined(__powerpc__) || defined(__ppc__)
+	unsigned int tb;	/* the low word is enough for the time of one call */
+
+	__asm__ __volatile__("mftb %0" : "=r"(tb));
+	return tb;
+#elif defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64b_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+#if (defined(__powerpc__) || defined(__ppc__)) && !defined(__powerpc64__)
+#define Skein_Stats_Elapsed(t0)	((u64b_t) (unsigned int) (Skein_Stats_Ticks() - (t0)))
+#else
+#define Skein_Stats_Elapsed(t0)	(Skein_Stats_Ticks() - (t0))
+#endif
+
+/* the counting versions of the block function macros in skein_kernel.h */
+#define Skein_Stats_Block_Fn(name, fn, ctxType, bytesField, blkField, blkBytes) \
+void name(ctxType * ctx, const u08b_t * blkPtr, size_t blkCnt, size_t byteCntAdd) \
+{									\
+	u64b_t t0 = Skein_Stats_Ticks();				\
+									\
+	(Skein_Kernel->fn) (ctx, blkPtr, blkCnt, byteCntAdd);		\
+	Skein_Stats_Add(ticks, Skein_Stats_Elapsed(t0));		\
+	Skein_Stats_Add(blkField, blkCnt);				\
+	Skein_Stats_Add(bytesField, (u64b_t) blkCnt * (blkBytes));	\
+}
+
+#define Skein_Stats_Lanes_Fn(name, fn, lanes)				\
+void name(Skein_512_Ctxt_t * ctx[lanes], const u08b_t * blkPtr[lanes],	\
+	  size_t blkCnt, const size_t byteCntAdd[lanes])		\
+{									\
+	u64b_t t0 = Skein_Stats_Ticks();				\
+									\
+	(Skein_Kernel->fn) (ctx, blkPtr, blkCnt, byteCntAdd);		\
+	Skein_Stats_Add(ticks, Skein_Stats_Elapsed(t0));		\
+	Skein_Stats_Add(blocks512, (u64b_t) blkCnt * (lanes));		\
+	Skein_Stats_Add(unalignedBytes, (u64b_t) blkCnt * (lanes) * SKEIN_512_BLOCK_BYTES); \
+}
+
+Skein_Stats_Block_Fn(Skein_256_Process_Block_Stats, process_256, Skein_256_Ctxt_t,
+		     unalignedBytes, blocks256, SKEIN_256_BLOCK_BYTES)
+Skein_Stats_Block_Fn(Skein_512_Process_Block_Stats, process_512, Skein_512_Ctxt_t,
+		     unalignedBytes, blocks512, SKEIN_512_BLOCK_BYTES)
+Skein_Stats_Block_Fn(Skein1024_Process_Block_Stats, process_1024, Skein1024_Ctxt_t,
+		     unalignedBytes, blocks1024, SKEIN1024_BLOCK_BYTES)
+Skein_Stats_Block_Fn(Skein_256_Process_Block_Aligned_Stats, process_256_aligned, Skein_256_Ctxt_t,
+		     alignedBytes, blocks256, SKEIN_256_BLOCK_BYTES)
+Skein_Stats_Block_Fn(Skein_512_Process_Block_Aligned_Stats, process_512_aligned, Skein_512_Ctxt_t,
+		     alignedBytes, blocks512, SKEIN_512_BLOCK_BYTES)
+Skein_Stats_Block_Fn(Skein1024_Process_Block_Aligned_Stats, process_1024_aligned, Skein1024_Ctxt_t,
+		     alignedBytes, blocks1024, SKEIN1024_BLOCK_BYTES)
+Skein_Stats_Lanes_Fn(Skein_512_Process_Block_x2_Stats, process_512_x2, 2)
+Skein_Stats_Lanes_Fn(Skein_512_Process_Block_x4_Stats, process_512_x4, 4)
+
+/* add the counters of one thread */
+static void Skein_Stats_Sum(Skein_Stats_t * sum, const Skein_Stats_t * s)
+{
+	sum->blocks256 += s->blocks256;
+	sum->blocks512 += s->blocks512;
+	sum->blocks1024 += s->blocks1024;
+	sum->alignedBytes += s->alignedBytes;
+	sum->unalignedBytes += s->unalignedBytes;
+	sum->updates += s->updates;
+	sum->bufferedUpdates += s->bufferedUpdates;
+	sum->ticks += s->ticks;
+}
+
+#endif				/* SKEIN_STATS */
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* add up the counters of all threads */
+void Skein_Get_Stats(Skein_Stats_t * stats)
+{
+#if SKEIN_STATS
+	const Skein_Stats_Thread_t *t;
+#endif
+
+	memset(stats, 0, sizeof(*stats));
+#if SKEIN_STATS
+	/* the other threads may be counting: this is a snapshot, not exact */
+	for (t = Skein_Stats_All; t != NULL; t = t->next)
+		Skein_Stats_Sum(stats, &t->stats);
+	Skein_Stats_Sum(stats, &Skein_Stats_Spare.stats);
+#endif
+}
@@ -0,0 +1,55 @@
+#ifndef _SKEIN_STATS_H_
+#define _SKEIN_STATS_H_
+/***********************************************************************
+**
+** Interface declarations for the Skein statistics counters.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** With SKEIN_STATS defined to 1 ("make STATS=1"), every call of the block
+** functions is counted and timed, and so is every Update(). Each thread
+** counts in its own memory (no atomic operations, no shared cache lines),
+** Skein_Get_Stats() adds up all threads. The counters only grow, to get
+** rates take the difference of two Skein_Get_Stats() results.
+**
+** Without SKEIN_STATS the counting code is not compiled at all and
+** Skein_Get_Stats() returns zeros.
+**
+** The ticks are timebase ticks on PowerPC, TSC cycles on x86 and
+** nanoseconds elsewhere.
+**
+***********************************************************************/
+
+#include "skein.h"
+
+#ifndef SKEIN_STATS
+#define SKEIN_STATS 0
+#endif
+
+typedef struct {
+	u64b_t blocks256;	/* blocks processed, per state size */
+	u64b_t blocks512;	/* (x2 and x4 lanes count separately) */
+	u64b_t blocks1024;
+	u64b_t alignedBytes;	/* through Skein_*_Process_Block_Aligned() */
+	u64b_t unalignedBytes;	/* through Skein_*_Process_Block() */
+	u64b_t updates;		/* Skein_*_Update() calls */
+	u64b_t bufferedUpdates;	/* ... that left message bytes in b[] */
+	u64b_t ticks;		/* spent in the block functions */
+} Skein_Stats_t;
+
+/* the sum of the counters of all threads */
+void Skein_Get_Stats(Skein_Stats_t * stats);
+
+#if SKEIN_STATS
+extern __thread Skein_Stats_t *Skein_Stats_Local;	/* this thread's counters */
+Skein_Stats_t *Skein_Stats_Register(void);
+
+#define Skein_Stats_Add(field, n)					\
+	((Skein_Stats_Local ? Skein_Stats_Local : Skein_Stats_Register())->field += (n))
+#else
+#define Skein_Stats_Add(field, n)
+#endif
+
+#endif				/* ifndef _SKEIN_STATS_H_ */
@@ -0,0 +1,126 @@
+/***********************************************************************
+**
+** Implementation of the Threefish block ciphers.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <string.h>		/* get the memcpy/memset functions */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_kernel.h"	/* get the block functions */
+#include "skein_threefish.h"
+
+/* the key as chaining variables, in the spec's word order */
+static void Threefish_Set_Key(u64b_t * X, const u08b_t * key, size_t words)
+{
+	Skein_Get64_LSB_First(X, key, words);
+}
+
+/* T = tweak + i, with the carry into the high word */
+static void Threefish_Tweak(u64b_t * T, const u64b_t tweak[2], u64b_t i)
+{
+	T[0] = tweak[0] + i;
+	T[1] = tweak[1] + (T[0] < i);
+}
+
+/* the ciphertext E(P) = X ^ P, from the block function's result X */
+static void Threefish_Output(u08b_t * out, const u08b_t * in, u64b_t * X,
+			     size_t words)
+{
+	u64b_t P[SKEIN1024_STATE_WORDS];
+	size_t i;
+
+	Skein_Get64_LSB_First(P, in, words);
+	for (i = 0; i < words; i++)
+		X[i] ^= P[i];
+	Skein_Put64_LSB_First(out, X, 8 * words);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* encrypt blkCnt blocks, one block function call each */
+void Threefish256_Encrypt_Blocks(const u08b_t * key, const u64b_t tweak[2],
+				 const u08b_t * in, u08b_t * out,
+				 size_t blkCnt)
+{
+	Skein_256_Ctxt_t ctx;
+	u64b_t K[SKEIN_256_STATE_WORDS];
+	size_t i;
+
+	Threefish_Set_Key(K, key, SKEIN_256_STATE_WORDS);
+	for (i = 0; i < blkCnt; i++) {
+		memcpy(ctx.X, K, sizeof(K));	/* the feed-forward changed it */
+		Threefish_Tweak(ctx.h.T, tweak, i);
+		Skein_256_Process_Block(&ctx, in, 1, 0);
+		Threefish_Output(out, in, ctx.X, SKEIN_256_STATE_WORDS);
+		in += SKEIN_256_BLOCK_BYTES;
+		out += SKEIN_256_BLOCK_BYTES;
+	}
+	memset(K, 0, sizeof(K));
+	memset(ctx.X, 0, sizeof(ctx.X));
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* encrypt blkCnt blocks, four at a time through the multi-buffer kernel */
+void Threefish512_Encrypt_Blocks(const u08b_t * key, const u64b_t tweak[2],
+				 const u08b_t * in, u08b_t * out,
+				 size_t blkCnt)
+{
+	Skein_512_Ctxt_t lane[4];
+	Skein_512_Ctxt_t *lctx[4];
+	const u08b_t *lblk[4];
+	static const size_t add[4] = { 0, 0, 0, 0 };	/* the tweaks are set per block */
+	u64b_t K[SKEIN_512_STATE_WORDS];
+	size_t i, done;
+
+	Threefish_Set_Key(K, key, SKEIN_512_STATE_WORDS);
+	for (i = 0; i < 4; i++)
+		lctx[i] = &lane[i];
+
+	for (done = 0; done + 4 <= blkCnt; done += 4) {
+		for (i = 0; i < 4; i++) {
+			memcpy(lane[i].X, K, sizeof(K));
+			Threefish_Tweak(lane[i].h.T, tweak, done + i);
+			lblk[i] = in + i * SKEIN_512_BLOCK_BYTES;
+		}
+		Skein_512_Process_Block_x4(lctx, lblk, 1, add);
+		for (i = 0; i < 4; i++) {
+			Threefish_Output(out, in, lane[i].X, SKEIN_512_STATE_WORDS);
+			in += SKEIN_512_BLOCK_BYTES;
+			out += SKEIN_512_BLOCK_BYTES;
+		}
+	}
+	for (; done < blkCnt; done++) {	/* the last 0..3 blocks */
+		memcpy(lane[0].X, K, sizeof(K));
+		Threefish_Tweak(lane[0].h.T, tweak, done);
+		Skein_512_Process_Block(&lane[0], in, 1, 0);
+		Threefish_Output(out, in, lane[0].X, SKEIN_512_STATE_WORDS);
+		in += SKEIN_512_BLOCK_BYTES;
+		out += SKEIN_512_BLOCK_BYTES;
+	}
+	memset(K, 0, sizeof(K));
+	memset(lane, 0, sizeof(lane));
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* encrypt blkCnt blocks, one block function call each */
+void Threefish1024_Encrypt_Blocks(const u08b_t * key, const u64b_t tweak[2],
+				  const u08b_t * in, u08b_t * out,
+				  size_t blkCnt)
+{
+	Skein1024_Ctxt_t ctx;
+	u64b_t K[SKEIN1024_STATE_WORDS];
+	size_t i;
+
+	Threefish_Set_Key(K, key, SKEIN1024_STATE_WORDS);
+	for (i = 0; i < blkCnt; i++) {
+		memcpy(ctx.X, K, sizeof(K));	/* the feed-forward changed it */
+		Threefish_Tweak(ctx.h.T, tweak, i);
+		Skein1024_Process_Block(&ctx, in, 1, 0);
+		Threefish_Output(out, in, ctx.X, SKEIN1024_STATE_WORDS);
+		in += SKEIN1024_BLOCK_BYTES;
+		out += SKEIN1024_BLOCK_BYTES;
+	}
+	memset(K, 0, sizeof(K));
+	memset(ctx.X, 0, sizeof(ctx.X));
+}
@@ -0,0 +1,40 @@
+#ifndef _SKEIN_THREEFISH_H_
+#define _SKEIN_THREEFISH_H_
+/***********************************************************************
+**
+** Interface declarations for the Threefish block ciphers.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** The block functions of Skein are Threefish plus the UBI feed-forward
+** (the new chaining value is E(X, T, P) ^ P). These functions run the
+** selected kernel with the key as the chaining value and undo the
+** feed-forward, so the cipher is the same optimized code as the hash.
+**
+** Encrypt_Blocks() encrypts blkCnt blocks, block i with the tweak
+** tweak + i (as one 128 bit number, tweak[0] is the low word). That is
+** the usual tweak-per-sector mode for disk encryption; encrypting counter
+** blocks with it gives CTR mode. For Threefish-512 four blocks at a time
+** go through the multi-buffer kernel.
+**
+** The key is a state sized byte string, read least significant byte
+** first like the message words. in == out is fine. The kernels only
+** compute the cipher forwards, there is no decryption here.
+**
+***********************************************************************/
+
+#include "skein.h"
+
+void Threefish256_Encrypt_Blocks(const u08b_t * key, const u64b_t tweak[2],
+				 const u08b_t * in, u08b_t * out,
+				 size_t blkCnt);
+void Threefish512_Encrypt_Blocks(const u08b_t * key, const u64b_t tweak[2],
+				 const u08b_t * in, u08b_t * out,
+				 size_t blkCnt);
+void Threefish1024_Encrypt_Blocks(const u08b_t * key, const u64b_t tweak[2],
+				  const u08b_t * in, u08b_t * out,
+				  size_t blkCnt);
+
+#endif				/* ifndef _SKEIN_THREEFISH_H_ */
@@ -0,0 +1,679 @@
+/***********************************************************************
+**
+** Implementation of (parallel) Skein tree hashing.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************/
+
+#include <stdlib.h>		/* get the malloc/free functions */
+#include <string.h>		/* get the memcpy/memset functions */
+#include <pthread.h>
+#include <unistd.h>		/* get sysconf */
+#include "skein.h"		/* get the Skein API definitions   */
+#include "skein_tree.h"
+
+#ifndef SKEIN_TREE_MAX_THREADS
+#define SKEIN_TREE_MAX_THREADS (256)	/* the threads parameter is capped at this */
+#endif
+
+/* one level of the tree, shared by all threads working on it */
+typedef struct {
+	const hashState *iv;
+	uint_t level;		/* tree level of the nodes being computed */
+	const u08b_t *src;	/* the level below */
+	size_t srcCnt;
+	u08b_t *dst;		/* one result block per node */
+	size_t nodeLen;		/* source bytes per node */
+	size_t nodeCnt;
+	size_t next;		/* next node to hash (atomic) */
+	size_t blkBytes;
+} Skein_Tree_Level_t;
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* InitExt() into a hashState */
+int Skein_Tree_Init(hashState * iv, uint_t stateBits, size_t hashBitLen,
+		    u64b_t treeInfo, const u08b_t * key, size_t keyBytes)
+{
+	if (hashBitLen > (size_t) 0x7FFFFFFF)	/* the int of the AHS API */
+		return SKEIN_FAIL;
+	return (InitExt(iv, stateBits, (int) hashBitLen, treeInfo, key,
+			keyBytes) == SUCCESS) ? SKEIN_SUCCESS : SKEIN_FAIL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash one node of the tree, starting from the chaining input iv */
+int Skein_Tree_Node(const hashState * iv, uint_t level, u64b_t offset,
+		    const u08b_t * msg, size_t msgByteCnt, u08b_t * result)
+{
+	hashState s;
+
+	if (iv->statebits != 256 && iv->statebits != 512 && iv->statebits != 1024)
+		return SKEIN_FAIL;
+
+	s = *iv;
+	Skein_Start_New_Type(&s.u, MSG);
+	Skein_Set_Tree_Level(s.u.h, level);
+	s.u.h.T[0] = offset;	/* nonzero initial offset in tweak! */
+
+	switch ((s.statebits >> 8) & 3) {
+	case 2:
+		Skein_512_Update(&s.u.ctx_512, msg, msgByteCnt);
+		return Skein_512_Final_Pad(&s.u.ctx_512, result);
+	case 1:
+		Skein_256_Update(&s.u.ctx_256, msg, msgByteCnt);
+		return Skein_256_Final_Pad(&s.u.ctx_256, result);
+	case 0:
+		Skein1024_Update(&s.u.ctx1024, msg, msgByteCnt);
+		return Skein1024_Final_Pad(&s.u.ctx1024, result);
+	default:
+		return SKEIN_FAIL;
+	}
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the OUTPUT stage, the chaining value is the result of the root node */
+int Skein_Tree_Output(const hashState * iv, const u08b_t * root,
+		      u08b_t * hashVal)
+{
+	hashState s;
+
+	s = *iv;
+	switch ((s.statebits >> 8) & 3) {
+	case 2:
+		Skein_Get64_LSB_First(s.u.ctx_512.X, root, SKEIN_512_STATE_WORDS);
+		return Skein_512_Output(&s.u.ctx_512, hashVal);
+	case 1:
+		Skein_Get64_LSB_First(s.u.ctx_256.X, root, SKEIN_256_STATE_WORDS);
+		return Skein_256_Output(&s.u.ctx_256, hashVal);
+	case 0:
+		Skein_Get64_LSB_First(s.u.ctx1024.X, root, SKEIN1024_STATE_WORDS);
+		return Skein1024_Output(&s.u.ctx1024, hashVal);
+	default:
+		return SKEIN_FAIL;
+	}
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* worker: hash nodes of the level until there are none left */
+static void *Skein_Tree_Worker(void *arg)
+{
+	Skein_Tree_Level_t *lvl = arg;
+	size_t i, offs, n;
+
+	while ((i = __sync_fetch_and_add(&lvl->next, 1)) < lvl->nodeCnt) {
+		offs = i * lvl->nodeLen;
+		n = lvl->srcCnt - offs;	/* number of bytes left at this level */
+		if (n > lvl->nodeLen)	/* limit to node size */
+			n = lvl->nodeLen;
+		Skein_Tree_Node(lvl->iv, lvl->level, offs, lvl->src + offs, n,
+				lvl->dst + i * lvl->blkBytes);
+	}
+	return NULL;
+}
+
+/* hash all nodes of one level, on up to "threads" threads */
+static void Skein_Tree_Run_Level(Skein_Tree_Level_t * lvl, uint_t threads)
+{
+	pthread_t tid[SKEIN_TREE_MAX_THREADS];
+	uint_t i, started;
+
+	if (threads > lvl->nodeCnt)
+		threads = lvl->nodeCnt;
+	if (threads > SKEIN_TREE_MAX_THREADS)
+		threads = SKEIN_TREE_MAX_THREADS;
+
+	lvl->next = 0;
+	for (started = 0; started + 1 < threads; started++)
+		if (pthread_create(&tid[started], NULL, Skein_Tree_Worker, lvl))
+			break;	/* fine, the remaining threads do more work */
+
+	Skein_Tree_Worker(lvl);
+
+	for (i = 0; i < started; i++)
+		pthread_join(tid[i], NULL);
+}
+
+/* source bytes per node, for a size exponent from treeInfo */
+static size_t Skein_Tree_Node_Len(size_t blkBytes, uint_t shift)
+{
+	if (shift > 8 * sizeof(size_t) - 8)	/* blkBytes <= 128: no overflow below */
+		return ~(size_t) 0;
+	return blkBytes << shift;
+}
+
+/* walk up the tree from "height", the bCnt bytes of results of that level in lvl->src */
+static int Skein_Tree_Climb(Skein_Tree_Level_t * lvl, u08b_t * buf[2],
+			    uint_t height, size_t bCnt, uint_t node,
+			    uint_t maxLevel, uint_t threads, u08b_t * hashVal)
+{
+	for (;; height++) {
+		if (height && bCnt == lvl->blkBytes)	/* done, with only one block left? */
+			break;
+		if (height + 1 == maxLevel)	/* the final allowed level: one big node */
+			lvl->nodeLen = bCnt;
+		else if (height)
+			lvl->nodeLen = Skein_Tree_Node_Len(lvl->blkBytes, node);
+
+		lvl->level = height + 1;
+		lvl->srcCnt = bCnt;
+		lvl->nodeCnt = bCnt ? (bCnt - 1) / lvl->nodeLen + 1 : 1;
+		lvl->dst = buf[height & 1];
+		Skein_Tree_Run_Level(lvl, threads);
+
+		lvl->src = lvl->dst;
+		bCnt = lvl->nodeCnt * lvl->blkBytes;
+	}
+
+	return Skein_Tree_Output(lvl->iv, lvl->src, hashVal);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* hash a message in tree mode, the nodes of each level in parallel */
+int Skein_Tree_Hash(uint_t stateBits, size_t hashBitLen, u64b_t treeInfo,
+		    const u08b_t * key, size_t keyBytes,
+		    const u08b_t * msg, size_t msgByteCnt,
+		    u08b_t * hashVal, uint_t threads)
+{
+	hashState iv;
+	Skein_Tree_Level_t lvl;
+	u08b_t *buf[2];
+	size_t nodeCnt;
+	uint_t leaf, node, maxLevel;
+	int ret;
+
+	leaf = (uint_t) ((treeInfo & SKEIN_CFG_TREE_LEAF_SIZE_MSK) >> SKEIN_CFG_TREE_LEAF_SIZE_POS);
+	node = (uint_t) ((treeInfo & SKEIN_CFG_TREE_NODE_SIZE_MSK) >> SKEIN_CFG_TREE_NODE_SIZE_POS);
+	maxLevel = (uint_t) ((treeInfo & SKEIN_CFG_TREE_MAX_LEVEL_MSK) >> SKEIN_CFG_TREE_MAX_LEVEL_POS);
+	if (leaf < 1 || node < 1 || maxLevel < 2)	/* not a valid tree */
+		return SKEIN_FAIL;
+
+	ret = Skein_Tree_Init(&iv, stateBits, hashBitLen, treeInfo, key, keyBytes);
+	if (ret != SKEIN_SUCCESS)
+		return ret;
+
+	if (threads == 0) {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (uint_t) cpus : 1;
+	}
+
+	lvl.iv = &iv;
+	lvl.blkBytes = stateBits / 8;
+	lvl.nodeLen = Skein_Tree_Node_Len(lvl.blkBytes, leaf);
+
+	/*
+	 * The results of a level go to buf[0] and buf[1] alternately. Each
+	 * inner node hashes at least two blocks, so buf[1] needs half the size.
+	 */
+	nodeCnt = msgByteCnt ? (msgByteCnt - 1) / lvl.nodeLen + 1 : 1;
+	buf[0] = malloc(nodeCnt * lvl.blkBytes);
+	buf[1] = malloc(((nodeCnt + 1) / 2) * lvl.blkBytes);
+	if (buf[0] == NULL || buf[1] == NULL) {
+		free(buf[0]);
+		free(buf[1]);
+		return SKEIN_FAIL;
+	}
+
+	lvl.src = msg;
+	ret = Skein_Tree_Climb(&lvl, buf, 0, msgByteCnt, node, maxLevel,
+			       threads, hashVal);
+
+	free(buf[0]);
+	free(buf[1]);
+	return ret;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* message bytes per leaf node (0: treeInfo is not a valid tree) */
+size_t Skein_Tree_Leaf_Bytes(uint_t stateBits, u64b_t treeInfo)
+{
+	uint_t leaf, node, maxLevel;
+
+	leaf = (uint_t) ((treeInfo & SKEIN_CFG_TREE_LEAF_SIZE_MSK) >> SKEIN_CFG_TREE_LEAF_SIZE_POS);
+	node = (uint_t) ((treeInfo & SKEIN_CFG_TREE_NODE_SIZE_MSK) >> SKEIN_CFG_TREE_NODE_SIZE_POS);
+	maxLevel = (uint_t) ((treeInfo & SKEIN_CFG_TREE_MAX_LEVEL_MSK) >> SKEIN_CFG_TREE_MAX_LEVEL_POS);
+	if (leaf < 1 || node < 1 || maxLevel < 2)
+		return 0;
+	return Skein_Tree_Node_Len(stateBits / 8, leaf);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the levels above the leaves, from the nodeCnt leaf results */
+int Skein_Tree_Finish(const hashState * iv, u64b_t treeInfo,
+		      const u08b_t * leaves, size_t nodeCnt, u08b_t * hashVal)
+{
+	Skein_Tree_Level_t lvl;
+	u08b_t *buf[2];
+	uint_t node, maxLevel;
+	int ret;
+
+	node = (uint_t) ((treeInfo & SKEIN_CFG_TREE_NODE_SIZE_MSK) >> SKEIN_CFG_TREE_NODE_SIZE_POS);
+	maxLevel = (uint_t) ((treeInfo & SKEIN_CFG_TREE_MAX_LEVEL_MSK) >> SKEIN_CFG_TREE_MAX_LEVEL_POS);
+	if (node < 1 || maxLevel < 2 || nodeCnt < 1)
+		return SKEIN_FAIL;
+
+	lvl.iv = iv;
+	lvl.blkBytes = iv->statebits / 8;
+
+	/* level 2 goes to buf[1], level 3 to buf[0]: both at most half the leaves */
+	buf[0] = malloc(((nodeCnt + 1) / 2) * lvl.blkBytes);
+	buf[1] = malloc(((nodeCnt + 1) / 2) * lvl.blkBytes);
+	if (buf[0] == NULL || buf[1] == NULL) {
+		free(buf[0]);
+		free(buf[1]);
+		return SKEIN_FAIL;
+	}
+
+	lvl.src = leaves;
+	ret = Skein_Tree_Climb(&lvl, buf, 1, nodeCnt * lvl.blkBytes, node,
+			       maxLevel, 1, hashVal);
+
+	free(buf[0]);
+	free(buf[1]);
+	return ret;
+}
+
+/*****************************************************************/
+/*     Incremental tree hashing                                  */
+/*****************************************************************/
+
+#define SKEIN_TREE_MAGIC	"SKEINTR1"	/* Save() format version */
+
+/* room for cnt results at one level */
+static int Skein_Tree_Grow(Skein_Tree_State_Level_t * l, size_t cnt,
+			   size_t blkBytes)
+{
+	u08b_t *res;
+	size_t cap;
+
+	if (cnt <= l->cap)
+		return SKEIN_SUCCESS;
+	cap = (l->cap < 16) ? 16 : 2 * l->cap;
+	if (cap < cnt)
+		cap = cnt;
+	res = realloc(l->res, cap * blkBytes);
+	if (res == NULL)
+		return SKEIN_FAIL;
+	l->res = res;
+	l->cap = cap;
+	return SKEIN_SUCCESS;
+}
+
+/* number of nodes at level[h] for cnt results at level[h - 1] (0: that was the root) */
+static size_t Skein_Tree_Parent_Cnt(const Skein_Tree_State_t * st, uint_t h,
+				    size_t cnt)
+{
+	uint_t node, maxLevel;
+	size_t blkBytes = st->iv.statebits / 8;
+
+	node = (uint_t) ((st->treeInfo & SKEIN_CFG_TREE_NODE_SIZE_MSK) >> SKEIN_CFG_TREE_NODE_SIZE_POS);
+	maxLevel = (uint_t) ((st->treeInfo & SKEIN_CFG_TREE_MAX_LEVEL_MSK) >> SKEIN_CFG_TREE_MAX_LEVEL_POS);
+	if (cnt == 1)
+		return 0;
+	if (h + 1 == maxLevel)	/* the final allowed level: one big node */
+		return 1;
+	return (cnt * blkBytes - 1) / Skein_Tree_Node_Len(blkBytes, node) + 1;
+}
+
+/* number of leaves for the message length so far */
+static size_t Skein_Tree_Leaf_Cnt(const Skein_Tree_State_t * st)
+{
+	return st->msgBytes ? (size_t) ((st->msgBytes - 1) / st->leafBytes + 1) : 1;
+}
+
+/* Tree_Node(), counted in st->nodes */
+static void Skein_Tree_State_Node(Skein_Tree_State_t * st, uint_t level,
+				  u64b_t offset, const u08b_t * msg,
+				  size_t msgByteCnt, u08b_t * result)
+{
+	Skein_Tree_Node(&st->iv, level, offset, msg, msgByteCnt, result);
+	st->nodes++;
+}
+
+/* add leaves lo..hi to the changed ones */
+static int Skein_Tree_Dirty(Skein_Tree_State_t * st, size_t lo, size_t hi)
+{
+	Skein_Tree_Range_t *r;
+	size_t cap;
+
+	r = st->dirtyCnt ? &st->dirty[st->dirtyCnt - 1] : NULL;
+	if (r != NULL && lo <= r->hi + 1 && hi + 1 >= r->lo) {	/* touches the last one */
+		if (r->lo > lo)
+			r->lo = lo;
+		if (r->hi < hi)
+			r->hi = hi;
+		return SKEIN_SUCCESS;
+	}
+	if (st->dirtyCnt == st->dirtyCap) {
+		cap = (st->dirtyCap < 16) ? 16 : 2 * st->dirtyCap;
+		r = realloc(st->dirty, cap * sizeof(*r));
+		if (r == NULL)
+			return SKEIN_FAIL;
+		st->dirty = r;
+		st->dirtyCap = cap;
+	}
+	st->dirty[st->dirtyCnt].lo = lo;
+	st->dirty[st->dirtyCnt++].hi = hi;
+	return SKEIN_SUCCESS;
+}
+
+/* qsort() order of the ranges */
+static int Skein_Tree_Range_Cmp(const void *a, const void *b)
+{
+	const Skein_Tree_Range_t *x = a, *y = b;
+
+	return (x->lo > y->lo) - (x->lo < y->lo);
+}
+
+/* sort the ranges, and merge those that overlap or touch */
+static void Skein_Tree_Merge(Skein_Tree_State_t * st)
+{
+	Skein_Tree_Range_t *r = st->dirty;
+	size_t i, n = 0;
+
+	qsort(r, st->dirtyCnt, sizeof(*r), Skein_Tree_Range_Cmp);
+	for (i = 1; i < st->dirtyCnt; i++) {
+		if (r[i].lo <= r[n].hi + 1) {
+			if (r[n].hi < r[i].hi)
+				r[n].hi = r[i].hi;
+		} else {
+			r[++n] = r[i];
+		}
+	}
+	st->dirtyCnt = n + 1;
+}
+
+/* hash the last leaf and the nodes above the changed leaves again */
+static int Skein_Tree_Refresh(Skein_Tree_State_t * st)
+{
+	Skein_Tree_State_Level_t *below, *l;
+	Skein_Tree_Range_t *r;
+	size_t blkBytes = st->iv.statebits / 8;
+	size_t i, j, m, lo, hi, cnt, nodeLen, bCnt, offs, n;
+	uint_t h, node;
+
+	l = &st->level[0];
+	if (!st->tailHashed) {
+		i = l->cnt - 1;
+		Skein_Tree_State_Node(st, 1, (u64b_t) i * st->leafBytes, st->tail,
+				      st->tailBytes, l->res + i * blkBytes);
+		st->tailHashed = 1;
+	}
+	if (st->dirtyCnt == 0)
+		return SKEIN_SUCCESS;
+	node = (uint_t) ((st->treeInfo & SKEIN_CFG_TREE_NODE_SIZE_MSK) >> SKEIN_CFG_TREE_NODE_SIZE_POS);
+
+	Skein_Tree_Merge(st);
+	for (h = 1; (cnt = Skein_Tree_Parent_Cnt(st, h, st->level[h - 1].cnt)) != 0; h++) {
+		if (h >= SKEIN_TREE_STATE_LEVELS)
+			return SKEIN_FAIL;
+		below = &st->level[h - 1];
+		l = &st->level[h];
+		if (Skein_Tree_Grow(l, cnt, blkBytes) != SKEIN_SUCCESS)
+			return SKEIN_FAIL;
+		l->cnt = cnt;
+
+		bCnt = below->cnt * blkBytes;
+		nodeLen = (cnt == 1) ? bCnt : Skein_Tree_Node_Len(blkBytes, node);
+		/* the nodes above the changed ones: still in order, may overlap */
+		r = st->dirty;
+		for (j = 0, m = 0; j < st->dirtyCnt; j++) {
+			lo = (r[j].lo * blkBytes) / nodeLen;
+			hi = (r[j].hi * blkBytes) / nodeLen;
+			if (m && lo <= r[m - 1].hi + 1) {
+				r[m - 1].hi = hi;
+			} else {
+				r[m].lo = lo;
+				r[m++].hi = hi;
+			}
+		}
+		st->dirtyCnt = m;
+		for (j = 0; j < st->dirtyCnt; j++) {
+			for (i = r[j].lo; i <= r[j].hi; i++) {
+				offs = i * nodeLen;
+				n = bCnt - offs;	/* number of bytes left at this level */
+				if (n > nodeLen)	/* limit to node size */
+					n = nodeLen;
+				Skein_Tree_State_Node(st, h + 1, offs, below->res + offs,
+						      n, l->res + i * blkBytes);
+			}
+		}
+	}
+	st->levels = h;
+	st->dirtyCnt = 0;
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* Tree_Init() and an empty message */
+int Skein_Tree_State_Init(Skein_Tree_State_t * st, uint_t stateBits,
+			  size_t hashBitLen, u64b_t treeInfo,
+			  const u08b_t * key, size_t keyBytes)
+{
+	memset(st, 0, sizeof(*st));
+	st->leafBytes = Skein_Tree_Leaf_Bytes(stateBits, treeInfo);
+	if (st->leafBytes == 0 || st->leafBytes > SKEIN_TREE_STATE_MAX_LEAF)
+		return SKEIN_FAIL;
+	if (Skein_Tree_Init(&st->iv, stateBits, hashBitLen, treeInfo, key,
+			    keyBytes) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	st->treeInfo = treeInfo;
+
+	st->tail = malloc(st->leafBytes);
+	if (st->tail == NULL
+	    || Skein_Tree_Grow(&st->level[0], 1, stateBits / 8) != SKEIN_SUCCESS
+	    || Skein_Tree_Dirty(st, 0, 0) != SKEIN_SUCCESS) {
+		Skein_Tree_State_Free(st);
+		return SKEIN_FAIL;
+	}
+	st->level[0].cnt = 1;	/* the (empty) last leaf */
+	st->levels = 1;
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* add message bytes at the end, full leaves are hashed right away */
+int Skein_Tree_Append(Skein_Tree_State_t * st, const u08b_t * msg,
+		      size_t msgByteCnt)
+{
+	Skein_Tree_State_Level_t *l = &st->level[0];
+	size_t blkBytes = st->iv.statebits / 8;
+	size_t n;
+
+	while (msgByteCnt) {
+		if (st->tailBytes == st->leafBytes) {	/* start a new last leaf */
+			if (Skein_Tree_Grow(l, l->cnt + 1, blkBytes) != SKEIN_SUCCESS)
+				return SKEIN_FAIL;
+			if (!st->tailHashed)	/* else Refresh() hashed it */
+				Skein_Tree_State_Node(st, 1, (u64b_t) (l->cnt - 1) * st->leafBytes,
+						      st->tail, st->leafBytes,
+						      l->res + (l->cnt - 1) * blkBytes);
+			l->cnt++;
+			st->tailBytes = 0;
+		}
+		n = st->leafBytes - st->tailBytes;
+		if (n > msgByteCnt)
+			n = msgByteCnt;
+		memcpy(st->tail + st->tailBytes, msg, n);
+		st->tailBytes += n;
+		st->msgBytes += n;
+		msg += n;
+		msgByteCnt -= n;
+		st->tailHashed = 0;
+		if (Skein_Tree_Dirty(st, l->cnt - 1, l->cnt - 1) != SKEIN_SUCCESS)
+			return SKEIN_FAIL;
+	}
+	return SKEIN_SUCCESS;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* new contents for one leaf */
+int Skein_Tree_Replace_Leaf(Skein_Tree_State_t * st, u64b_t index,
+			    const u08b_t * msg, size_t msgByteCnt)
+{
+	Skein_Tree_State_Level_t *l = &st->level[0];
+	size_t blkBytes = st->iv.statebits / 8;
+
+	if (index >= l->cnt)
+		return SKEIN_FAIL;
+
+	if (index == l->cnt - 1) {	/* the last leaf sets the message length */
+		if (msgByteCnt > st->leafBytes || (msgByteCnt == 0 && index != 0))
+			return SKEIN_FAIL;
+		memcpy(st->tail, msg, msgByteCnt);
+		st->tailBytes = msgByteCnt;
+		st->msgBytes = index * st->leafBytes + msgByteCnt;
+		st->tailHashed = 0;
+	} else {
+		if (msgByteCnt != st->leafBytes)
+			return SKEIN_FAIL;
+		Skein_Tree_State_Node(st, 1, index * st->leafBytes, msg,
+				      msgByteCnt, l->res + (size_t) index * blkBytes);
+	}
+	return Skein_Tree_Dirty(st, (size_t) index, (size_t) index);
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the hash of the message so far */
+int Skein_Tree_State_Final(Skein_Tree_State_t * st, u08b_t * hashVal)
+{
+	if (Skein_Tree_Refresh(st) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	return Skein_Tree_Output(&st->iv, st->level[st->levels - 1].res,
+				 hashVal);
+}
+
+/* Save() numbers: 64 bits, least significant byte first */
+static u08b_t *Skein_Tree_Put(u08b_t * p, u64b_t v)
+{
+	Skein_Put64_LSB_First(p, &v, 8);
+	return p + 8;
+}
+
+static const u08b_t *Skein_Tree_Get(const u08b_t * p, u64b_t * v)
+{
+	Skein_Get64_LSB_First(v, p, 1);
+	return p + 8;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* serialize: header, node counts, node results, last leaf */
+size_t Skein_Tree_Save(Skein_Tree_State_t * st, u08b_t * buf,
+		       size_t bufBytes)
+{
+	size_t blkBytes = st->iv.statebits / 8;
+	size_t need, n;
+	uint_t h;
+
+	if (Skein_Tree_Refresh(st) != SKEIN_SUCCESS)
+		return 0;
+
+	need = 8 + 6 * 8 + st->tailBytes;
+	for (h = 0; h < st->levels; h++)
+		need += 8 + st->level[h].cnt * blkBytes;
+	if (bufBytes < need)
+		return need;
+
+	memcpy(buf, SKEIN_TREE_MAGIC, 8);
+	buf = Skein_Tree_Put(buf + 8, st->iv.statebits);
+	buf = Skein_Tree_Put(buf, st->iv.u.h.hashBitLen);
+	buf = Skein_Tree_Put(buf, st->treeInfo);
+	buf = Skein_Tree_Put(buf, st->msgBytes);
+	buf = Skein_Tree_Put(buf, st->tailBytes);
+	buf = Skein_Tree_Put(buf, st->levels);
+	for (h = 0; h < st->levels; h++)
+		buf = Skein_Tree_Put(buf, st->level[h].cnt);
+	for (h = 0; h < st->levels; h++) {
+		n = st->level[h].cnt * blkBytes;
+		memcpy(buf, st->level[h].res, n);
+		buf += n;
+	}
+	memcpy(buf, st->tail, st->tailBytes);
+	return need;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* the state saved by Save(), for the same hash length and key */
+int Skein_Tree_Load(Skein_Tree_State_t * st, const u08b_t * buf,
+		    size_t bufBytes, size_t hashBitLen, const u08b_t * key,
+		    size_t keyBytes)
+{
+	const u08b_t *end = buf + bufBytes;
+	u64b_t stateBits, savedBitLen, treeInfo, msgBytes, tailBytes, levels, cnt;
+	size_t blkBytes, expect, avail, n;
+	uint_t h;
+
+	if (bufBytes < 8 + 6 * 8 || memcmp(buf, SKEIN_TREE_MAGIC, 8))
+		return SKEIN_FAIL;
+	buf = Skein_Tree_Get(buf + 8, &stateBits);
+	buf = Skein_Tree_Get(buf, &savedBitLen);
+	buf = Skein_Tree_Get(buf, &treeInfo);
+	buf = Skein_Tree_Get(buf, &msgBytes);
+	buf = Skein_Tree_Get(buf, &tailBytes);
+	buf = Skein_Tree_Get(buf, &levels);
+	if ((stateBits != 256 && stateBits != 512 && stateBits != 1024)
+	    || savedBitLen != hashBitLen || levels < 1
+	    || levels > SKEIN_TREE_STATE_LEVELS || (size_t) (end - buf) < 8 * levels)
+		return SKEIN_FAIL;
+
+	if (Skein_Tree_State_Init(st, (uint_t) stateBits, hashBitLen, treeInfo,
+				  key, keyBytes) != SKEIN_SUCCESS)
+		return SKEIN_FAIL;
+	blkBytes = st->iv.statebits / 8;
+	avail = (size_t) (end - buf) - 8 * levels;	/* for the node results */
+	if (tailBytes > st->leafBytes || tailBytes > avail
+	    || (msgBytes ? (msgBytes - 1) / st->leafBytes + 1 : 1) > avail / blkBytes)
+		goto bad;
+	st->msgBytes = msgBytes;
+	st->tailBytes = (size_t) tailBytes;
+	if (msgBytes != (Skein_Tree_Leaf_Cnt(st) - 1) * (u64b_t) st->leafBytes + tailBytes)
+		goto bad;
+
+	/* the node counts must be those of a tree for msgBytes, and be in buf */
+	expect = Skein_Tree_Leaf_Cnt(st);
+	for (h = 0; h < levels; h++) {
+		buf = Skein_Tree_Get(buf, &cnt);
+		if (cnt != expect || expect > avail / blkBytes)
+			goto bad;
+		avail -= expect * blkBytes;
+		st->level[h].cnt = expect;
+		expect = Skein_Tree_Parent_Cnt(st, h + 1, expect);
+	}
+	if (expect != 0 || avail != st->tailBytes)	/* the last level must be the root */
+		goto bad;
+	for (h = 0; h < levels; h++)
+		if (Skein_Tree_Grow(&st->level[h], st->level[h].cnt, blkBytes) != SKEIN_SUCCESS)
+			goto bad;
+	st->levels = (uint_t) levels;
+
+	for (h = 0; h < levels; h++) {
+		n = st->level[h].cnt * blkBytes;
+		if ((size_t) (end - buf) < n)
+			goto bad;
+		memcpy(st->level[h].res, buf, n);
+		buf += n;
+	}
+	if ((size_t) (end - buf) != st->tailBytes)
+		goto bad;
+	memcpy(st->tail, buf, st->tailBytes);
+	st->tailHashed = 1;
+	st->dirtyCnt = 0;
+	return SKEIN_SUCCESS;
+
+      bad:
+	Skein_Tree_State_Free(st);
+	return SKEIN_FAIL;
+}
+
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+/* free the node results and the last leaf */
+void Skein_Tree_State_Free(Skein_Tree_State_t * st)
+{
+	uint_t h;
+
+	for (h = 0; h < SKEIN_TREE_STATE_LEVELS; h++)
+		free(st->level[h].res);
+	free(st->tail);
+	free(st->dirty);
+	memset(st, 0, sizeof(*st));
+}
@@ -0,0 +1,125 @@
+#ifndef _SKEIN_TREE_H_
+#define _SKEIN_TREE_H_
+/***********************************************************************
+**
+** Interface declarations for (parallel) Skein tree hashing.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** The treeInfo word is the same as for InitExt(), i.e. built with
+** SKEIN_CFG_TREE_INFO(leaf, node, maxLevel):
+**   leaf:     leaf nodes hash (block size << leaf) message bytes
+**   node:     inner nodes hash (1 << node) child results
+**   maxLevel: height of the tree; everything that is left at this level
+**             is hashed as one node
+**
+** The nodes of each level are independent of each other and are hashed
+** on "threads" threads (0: one per online CPU). The result does not
+** depend on the thread count.
+**
+***********************************************************************/
+
+#include "skein.h"
+#include "SHA3api_ref.h"	/* get the hashState type */
+
+/* hash msg[0..msgByteCnt-1] in tree mode (key may be NULL for a plain hash) */
+int Skein_Tree_Hash(uint_t stateBits, size_t hashBitLen, u64b_t treeInfo,
+		    const u08b_t * key, size_t keyBytes,
+		    const u08b_t * msg, size_t msgByteCnt,
+		    u08b_t * hashVal, uint_t threads);
+
+/*
+**   The building blocks of Skein_Tree_Hash():
+**      Tree_Init:   InitExt() into a hashState; the result is the chaining
+**                   input of every node of the tree.
+**      Tree_Node:   hash one node (msgByteCnt bytes at byte offset "offset"
+**                   of tree level "level - 1"), writes one block of bytes.
+**      Tree_Output: the output stage, given the result of the root node.
+**      Tree_Finish: all levels above the leaves and the output stage,
+**                   given the results of the leaf nodes (level 1).
+**      Tree_Leaf_Bytes: message bytes per leaf node, 0 if treeInfo is
+**                   not a valid tree.
+*/
+int Skein_Tree_Init(hashState * iv, uint_t stateBits, size_t hashBitLen,
+		    u64b_t treeInfo, const u08b_t * key, size_t keyBytes);
+int Skein_Tree_Node(const hashState * iv, uint_t level, u64b_t offset,
+		    const u08b_t * msg, size_t msgByteCnt, u08b_t * result);
+int Skein_Tree_Output(const hashState * iv, const u08b_t * root,
+		      u08b_t * hashVal);
+int Skein_Tree_Finish(const hashState * iv, u64b_t treeInfo,
+		      const u08b_t * leaves, size_t nodeCnt, u08b_t * hashVal);
+size_t Skein_Tree_Leaf_Bytes(uint_t stateBits, u64b_t treeInfo);
+
+/*
+**   Incremental tree hashing: a Tree_State_t keeps the results of all
+**   nodes, and the ranges of leaves changed since the last Final(). Only
+**   the nodes above those are hashed again: one node per level and changed
+**   leaf at most (O(log n) nodes, plus the children of the single node at
+**   maxLevel -- use a large maxLevel). Final() may be called any number of
+**   times, the state stays usable. "nodes" counts the nodes hashed.
+**
+**   The last leaf (tailBytes message bytes) is kept in the state. Save()
+**   serializes everything but the key, Load() needs the key again (and
+**   the hash length, which Final() writes, must be the saved one).
+**
+**      State_Init:   Tree_Init() and an empty message.
+**      Append:       add message bytes at the end.
+**      Replace_Leaf: new contents for leaf "index": exactly a leaf of bytes,
+**                    or 1..leaf bytes for the last one (which sets the
+**                    message length).
+**      Final:        the hash of the current message.
+**      Save:         the serialized state, returns the number of bytes it
+**                    needs (nothing is written if bufBytes is smaller).
+**      Load:         a state from Save() bytes, SKEIN_FAIL if they are not
+**                    consistent.
+**      State_Free:   frees the node results.
+*/
+#ifndef SKEIN_TREE_STATE_LEVELS
+#define SKEIN_TREE_STATE_LEVELS (64)	/* enough for 2**64 leaves */
+#endif
+#ifndef SKEIN_TREE_STATE_MAX_LEAF
+#define SKEIN_TREE_STATE_MAX_LEAF (1 << 24)	/* largest leaf node kept in tail[] */
+#endif
+
+typedef struct {
+	u08b_t *res;		/* node results, one block each */
+	size_t cnt, cap;	/* results valid, allocated */
+} Skein_Tree_State_Level_t;
+
+typedef struct {
+	size_t lo, hi;		/* nodes lo..hi of one level */
+} Skein_Tree_Range_t;
+
+typedef struct {
+	hashState iv;
+	u64b_t treeInfo;
+	u64b_t msgBytes;	/* message bytes so far */
+	size_t leafBytes;
+	Skein_Tree_Range_t *dirty;	/* leaves changed since the last Final() */
+	size_t dirtyCnt, dirtyCap;
+	int tailHashed;		/* level[0] has the result of tail[] */
+	u64b_t nodes;		/* nodes hashed so far */
+	uint_t levels;		/* levels in level[], level[0] are the leaves */
+	Skein_Tree_State_Level_t level[SKEIN_TREE_STATE_LEVELS];
+	u08b_t *tail;		/* the contents of the last leaf */
+	size_t tailBytes;
+} Skein_Tree_State_t;
+
+int Skein_Tree_State_Init(Skein_Tree_State_t * st, uint_t stateBits,
+			  size_t hashBitLen, u64b_t treeInfo,
+			  const u08b_t * key, size_t keyBytes);
+int Skein_Tree_Append(Skein_Tree_State_t * st, const u08b_t * msg,
+		      size_t msgByteCnt);
+int Skein_Tree_Replace_Leaf(Skein_Tree_State_t * st, u64b_t index,
+			    const u08b_t * msg, size_t msgByteCnt);
+int Skein_Tree_State_Final(Skein_Tree_State_t * st, u08b_t * hashVal);
+size_t Skein_Tree_Save(Skein_Tree_State_t * st, u08b_t * buf,
+		       size_t bufBytes);
+int Skein_Tree_Load(Skein_Tree_State_t * st, const u08b_t * buf,
+		    size_t bufBytes, size_t hashBitLen, const u08b_t * key,
+		    size_t keyBytes);
+void Skein_Tree_State_Free(Skein_Tree_State_t * st);
+
+#endif				/* ifndef _SKEIN_TREE_H_ */
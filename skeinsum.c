@@ -0,0 +1,404 @@
+/***********************************************************************
+**
+** skeinsum: print or check Skein checksums, like sha256sum.
+**
+** This algorithm and source code is released to the public domain.
+**
+************************************************************************
+**
+** The files are hashed on -j threads at once (one per online CPU by
+** default), the output is in the order of the arguments. Regular files
+** are mmap()ed, pipes are read by a reader thread (see skein_file.h).
+**
+** With -t every file is tree hashed (leaf and node sizes below) by all
+** threads, one file after the other. This gives different checksums than
+** the sequential hash, so -t must be given for --check as well.
+**
+***********************************************************************/
+
+#define _FILE_OFFSET_BITS 64	/* files larger than 2 GB on 32 bit systems */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include "SHA3api_ref.h"
+#include "skein_file.h"
+#include "skein_tree.h"
+
+/* -t: leaves of 1024 blocks (64 KB for Skein-512), four children per node */
+#define SKEINSUM_TREE_INFO	SKEIN_CFG_TREE_INFO(10, 2, 0xFF)
+#define SKEINSUM_READ		(1024 * 1024)	/* read() size for tree hashing pipes */
+
+typedef struct {
+	char *name;		/* file name ("-" is stdin) */
+	size_t hashBitLen;
+	char *expect;		/* --check: the hex checksum, else NULL */
+	u08b_t hash[SKEIN1024_STATE_BYTES * 8];	/* up to 8192 bit results */
+	int err;		/* errno of a failure, 0 if hashed */
+	int done;
+} Skeinsum_Job_t;
+
+static Skeinsum_Job_t *jobs;
+static size_t jobCnt, jobNext;	/* jobNext: atomic */
+static uint_t stateBits = 512, threads;
+static int tree;
+static pthread_mutex_t doneLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t doneCond = PTHREAD_COND_INITIALIZER;
+
+/* tree hash a file, the regular ones through a mapping of all of it */
+static int Skeinsum_Tree(const char *name, size_t hashBitLen, u08b_t * hash)
+{
+	Skein_Tree_State_t st;
+	struct stat sb;
+	u08b_t *buf, *p;
+	ssize_t len;
+	int fd, ret = SKEIN_FAIL;
+
+	fd = strcmp(name, "-") ? open(name, O_RDONLY) : 0;
+	if (fd < 0)
+		return SKEIN_FAIL;
+
+	if (fstat(fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_size > 0
+	    && (size_t) sb.st_size == (u64b_t) sb.st_size) {
+		p = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED) {
+			madvise(p, sb.st_size, MADV_WILLNEED);
+			ret = Skein_Tree_Hash(stateBits, hashBitLen, SKEINSUM_TREE_INFO,
+					      NULL, 0, p, sb.st_size, hash, threads);
+			munmap(p, sb.st_size);
+			if (fd)
+				close(fd);
+			return ret;
+		}
+	}
+
+	/* pipes (and empty or unmappable files): incremental, on this thread */
+	buf = malloc(SKEINSUM_READ);
+	if (buf != NULL && Skein_Tree_State_Init(&st, stateBits, hashBitLen,
+						 SKEINSUM_TREE_INFO, NULL, 0) == SKEIN_SUCCESS) {
+		while ((len = read(fd, buf, SKEINSUM_READ)) != 0) {
+			if (len < 0 && errno == EINTR)
+				continue;
+			if (len < 0 || Skein_Tree_Append(&st, buf, len) != SKEIN_SUCCESS)
+				break;
+		}
+		if (len == 0)
+			ret = Skein_Tree_State_Final(&st, hash);
+		Skein_Tree_State_Free(&st);
+	}
+	free(buf);
+	if (fd)
+		close(fd);
+	return ret;
+}
+
+/* hash one job, keeping errno of a failure */
+static void Skeinsum_Hash(Skeinsum_Job_t * job)
+{
+	hashState state;
+	int ok;
+
+	errno = 0;
+	if (tree) {
+		ok = Skeinsum_Tree(job->name, job->hashBitLen, job->hash) == SKEIN_SUCCESS;
+	} else {
+		InitExt(&state, stateBits, (int) job->hashBitLen,
+			SKEIN_CFG_TREE_INFO_SEQUENTIAL, NULL, 0);
+		ok = Skein_Hash_File(&state, job->name, job->hash) == SUCCESS;
+	}
+	job->err = ok ? 0 : (errno ? errno : EIO);
+}
+
+/* worker: take jobs until there are none left */
+static void *Skeinsum_Worker(void *arg)
+{
+	size_t i;
+
+	(void) arg;
+	while ((i = __sync_fetch_and_add(&jobNext, 1)) < jobCnt) {
+		Skeinsum_Hash(&jobs[i]);
+		pthread_mutex_lock(&doneLock);
+		jobs[i].done = 1;
+		pthread_cond_broadcast(&doneCond);
+		pthread_mutex_unlock(&doneLock);
+	}
+	return NULL;
+}
+
+/* print a file name like sha256sum: escaped if it has a \ or newline */
+static void Skeinsum_Name(const char *name)
+{
+	for (; *name; name++)
+		if (*name == '\\')
+			fputs("\\\\", stdout);
+		else if (*name == '\n')
+			fputs("\\n", stdout);
+		else
+			putchar(*name);
+}
+
+static int Skeinsum_Needs_Escape(const char *name)
+{
+	return strchr(name, '\\') != NULL || strchr(name, '\n') != NULL;
+}
+
+/* undo Skeinsum_Name(), in place; 0 for a bad escape */
+static int Skeinsum_Unescape(char *name)
+{
+	char *d = name;
+
+	for (; *name; name++) {
+		if (*name != '\\') {
+			*d++ = *name;
+			continue;
+		}
+		name++;
+		if (*name == '\\')
+			*d++ = '\\';
+		else if (*name == 'n')
+			*d++ = '\n';
+		else
+			return 0;
+	}
+	*d = 0;
+	return 1;
+}
+
+/* the result of one job: its checksum line, or OK/FAILED for --check */
+static int Skeinsum_Report(const Skeinsum_Job_t * job, size_t *mismatch,
+			   size_t *unreadable)
+{
+	char hex[2 * sizeof(job->hash) + 1];
+	size_t i, n = job->hashBitLen / 8;
+
+	if (job->err) {
+		fprintf(stderr, "skeinsum: %s: %s\n", job->name, strerror(job->err));
+		if (job->expect) {
+			if (Skeinsum_Needs_Escape(job->name))
+				putchar('\\');
+			Skeinsum_Name(job->name);
+			printf(": FAILED open or read\n");
+			(*unreadable)++;
+		}
+		return 1;
+	}
+
+	for (i = 0; i < n; i++)
+		sprintf(hex + 2 * i, "%02x", job->hash[i]);
+
+	if (job->expect == NULL) {
+		if (Skeinsum_Needs_Escape(job->name))
+			putchar('\\');
+		printf("%s  ", hex);
+		Skeinsum_Name(job->name);
+		putchar('\n');
+		return 0;
+	}
+
+	if (Skeinsum_Needs_Escape(job->name))
+		putchar('\\');
+	Skeinsum_Name(job->name);
+	if (strcasecmp(hex, job->expect) == 0) {
+		printf(": OK\n");
+		return 0;
+	}
+	printf(": FAILED\n");
+	(*mismatch)++;
+	return 1;
+}
+
+/* add a job, NULL if out of memory */
+static Skeinsum_Job_t *Skeinsum_Add(const char *name, size_t hashBitLen)
+{
+	static size_t cap;
+	Skeinsum_Job_t *j;
+
+	if (jobCnt == cap) {
+		cap = cap ? 2 * cap : 64;
+		j = realloc(jobs, cap * sizeof(*jobs));
+		if (j == NULL)
+			return NULL;
+		jobs = j;
+	}
+	j = &jobs[jobCnt++];
+	memset(j, 0, sizeof(*j));
+	j->name = strdup(name);
+	j->hashBitLen = hashBitLen;
+	return j->name ? j : NULL;
+}
+
+/* read the "<hex>  <name>" lines of a checksum file into jobs */
+static int Skeinsum_Read_Check(const char *file, size_t hashBitLen,
+			       size_t *badLines)
+{
+	FILE *f = strcmp(file, "-") ? fopen(file, "r") : stdin;
+	char *line = NULL, *p, *name;
+	size_t cap = 0, hexLen, bits;
+	ssize_t len;
+	Skeinsum_Job_t *j;
+	int escaped;
+
+	if (f == NULL) {
+		fprintf(stderr, "skeinsum: %s: %s\n", file, strerror(errno));
+		return 1;
+	}
+	while ((len = getline(&line, &cap, f)) > 0) {
+		if (line[len - 1] == '\n')
+			line[--len] = 0;
+		p = line;
+		escaped = (*p == '\\');
+		p += escaped;
+		hexLen = strspn(p, "0123456789abcdefABCDEF");
+		bits = hashBitLen ? hashBitLen : 4 * hexLen;	/* -l, or from the checksum */
+		name = p + hexLen + 2;
+		if (hexLen == 0 || hexLen != bits / 4 || bits > 8 * sizeof(j->hash)
+		    || p[hexLen] != ' ' || (p[hexLen + 1] != ' ' && p[hexLen + 1] != '*')
+		    || *name == 0 || (escaped && !Skeinsum_Unescape(name))) {
+			(*badLines)++;
+			continue;
+		}
+		p[hexLen] = 0;
+		j = Skeinsum_Add(name, bits);
+		if (j == NULL || (j->expect = strdup(p)) == NULL) {
+			fprintf(stderr, "skeinsum: out of memory\n");
+			exit(1);
+		}
+	}
+	free(line);
+	if (f != stdin)
+		fclose(f);
+	return 0;
+}
+
+static void Skeinsum_Usage(void)
+{
+	fprintf(stderr,
+		"Usage: skeinsum [-a 256|512|1024] [-l bits] [-j threads] [-t] [-c] [file...]\n"
+		"  -a, --algorithm  Skein state size (default 512)\n"
+		"  -l, --length     hash length in bits, a multiple of 8 (default: state size)\n"
+		"  -j, --jobs       files hashed at once (default: one per CPU)\n"
+		"  -t, --tree       tree hash each file on all threads\n"
+		"  -c, --check      read checksums from the files and check them\n"
+		"With no file, or when file is -, read standard input.\n");
+}
+
+int main(int argc, char **argv)
+{
+	static const struct option longOpts[] = {
+		{"algorithm", required_argument, NULL, 'a'},
+		{"length", required_argument, NULL, 'l'},
+		{"jobs", required_argument, NULL, 'j'},
+		{"tree", no_argument, NULL, 't'},
+		{"check", no_argument, NULL, 'c'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+	pthread_t tid[256];
+	size_t hashBitLen = 0, i, mismatch = 0, unreadable = 0, badLines = 0;
+	uint_t workers, started;
+	int opt, check = 0, ret = 0;
+	long cpus;
+	char *end;
+
+	while ((opt = getopt_long(argc, argv, "a:l:j:tch", longOpts, NULL)) != -1) {
+		switch (opt) {
+		case 'a':
+			stateBits = (uint_t) strtoul(optarg, &end, 10);
+			if (*end || (stateBits != 256 && stateBits != 512 && stateBits != 1024)) {
+				fprintf(stderr, "skeinsum: -a must be 256, 512 or 1024\n");
+				return 1;
+			}
+			break;
+		case 'l':
+			hashBitLen = strtoul(optarg, &end, 10);
+			if (*end || hashBitLen == 0 || hashBitLen % 8
+			    || hashBitLen > 8 * sizeof(jobs->hash)) {
+				fprintf(stderr, "skeinsum: -l must be a multiple of 8, up to %u\n",
+					(unsigned int) (8 * sizeof(jobs->hash)));
+				return 1;
+			}
+			break;
+		case 'j':
+			threads = (uint_t) strtoul(optarg, &end, 10);
+			if (*end || threads == 0) {
+				fprintf(stderr, "skeinsum: -j must be a positive number\n");
+				return 1;
+			}
+			break;
+		case 't':
+			tree = 1;
+			break;
+		case 'c':
+			check = 1;
+			break;
+		default:
+			Skeinsum_Usage();
+			return opt != 'h';
+		}
+	}
+
+	if (optind == argc)
+		argv[--optind] = "-";
+	for (i = optind; i < (size_t) argc; i++) {
+		if (check) {
+			ret |= Skeinsum_Read_Check(argv[i], hashBitLen, &badLines);
+		} else if (Skeinsum_Add(argv[i], hashBitLen ? hashBitLen : stateBits) == NULL) {
+			fprintf(stderr, "skeinsum: out of memory\n");
+			return 1;
+		}
+	}
+
+	if (threads == 0) {
+		cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = (cpus > 0) ? (uint_t) cpus : 1;
+	}
+	workers = tree ? 1 : threads;	/* -t: the threads work on one file at a time */
+	if (workers > jobCnt)
+		workers = (uint_t) jobCnt;
+	if (workers > sizeof(tid) / sizeof(tid[0]))
+		workers = sizeof(tid) / sizeof(tid[0]);
+	for (started = 0; started < workers; started++)
+		if (pthread_create(&tid[started], NULL, Skeinsum_Worker, NULL))
+			break;
+	if (started == 0 && jobCnt)
+		Skeinsum_Worker(NULL);	/* no threads: do it here */
+
+	/* the results in order, as they come in */
+	for (i = 0; i < jobCnt; i++) {
+		pthread_mutex_lock(&doneLock);
+		while (!jobs[i].done)
+			pthread_cond_wait(&doneCond, &doneLock);
+		pthread_mutex_unlock(&doneLock);
+		ret |= Skeinsum_Report(&jobs[i], &mismatch, &unreadable);
+	}
+	for (i = 0; i < started; i++)
+		pthread_join(tid[i], NULL);
+
+	fflush(stdout);		/* the warnings come after the results */
+	if (badLines) {
+		fprintf(stderr, "skeinsum: WARNING: %u line%s improperly formatted\n",
+			(unsigned int) badLines, badLines == 1 ? " is" : "s are");
+		if (check && jobCnt == 0)
+			ret = 1;
+	}
+	if (unreadable)
+		fprintf(stderr, "skeinsum: WARNING: %u listed file%s could not be read\n",
+			(unsigned int) unreadable, unreadable == 1 ? "" : "s");
+	if (mismatch)
+		fprintf(stderr, "skeinsum: WARNING: %u computed checksum%s did NOT match\n",
+			(unsigned int) mismatch, mismatch == 1 ? "" : "s");
+
+	for (i = 0; i < jobCnt; i++) {
+		free(jobs[i].name);
+		free(jobs[i].expect);
+	}
+	free(jobs);
+	return ret;
+}
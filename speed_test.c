@@ -1,4 +1,6 @@
 #include "SHA3api_ref.h"
+#include "skein_kernel.h"
+#include "skein_file.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -33,6 +35,39 @@ timeval_subtract (struct timeval *result, struct timeval *x, struct timeval *y)
 	return x->tv_sec < y->tv_sec;
 }
 
+/* the settings tried by -p */
+static const char *prefetch_sweep[] = {
+	"none", "dst:1", "dst:2", "dst:3", "dst:4",
+	"dcbt:1", "dcbt:2", "dcbt:4", "dcbt:8", NULL
+};
+
+/* hash the file once for each prefetch setting */
+static int sweep(const char *file, BitSequence *hash, int hashbitlen)
+{
+	struct rusage start, end;
+	hashState state;
+	unsigned int i;
+
+	for (i = 0; prefetch_sweep[i]; i++) {
+		Skein_Set_Prefetch(prefetch_sweep[i]);
+		Init(&state, hashbitlen);
+		getrusage(RUSAGE_SELF, &start);
+		if (Skein_Hash_File(&state, file, hash) != SUCCESS) {
+			printf("Failed to hash the file!\n");
+			return 1;
+		}
+		getrusage(RUSAGE_SELF, &end);
+		timeval_subtract(&start.ru_utime, &end.ru_utime, &start.ru_utime);
+		printf("%-10s %i.%06i s\n", Skein_Get_Prefetch(),
+		       (unsigned int) start.ru_utime.tv_sec, (unsigned int) start.ru_utime.tv_usec);
+	}
+	for (i = 0; i < (unsigned int) hashbitlen / 8; i++)
+		printf("%.2X", hash[i]);
+	printf("\n");
+	printf("Kernel: %s\n", Skein_Get_Kernel());
+	return 0;
+}
+
 #define LEN 1024*1024
 int main(int argc, char **argv)
 {
@@ -43,7 +78,19 @@ int main(int argc, char **argv)
 	hashState state;
 	struct rusage start, end;
 	FILE *f;
+	int serial = 0, prefetch = 0;
 	
+	if (argc > 1 && strcmp(argv[1], "-s") == 0) {
+		/* the old way: fread() and hash in turn */
+		serial = 1;
+		argv++;
+		argc--;
+	} else if (argc > 1 && strcmp(argv[1], "-p") == 0) {
+		/* compare the prefetch strategies */
+		prefetch = 1;
+		argv++;
+		argc--;
+	}
 	if (argc < 2) {
 		printf("You need to specify a file to hash!\n");
 		return 1;
@@ -51,28 +98,43 @@ int main(int argc, char **argv)
 	
 	memset(hash, 0, sizeof(hash));
 	
+	if (prefetch)
+		return sweep(argv[1], hash, sizeof(hash)*8);
+
 	Init(&state, sizeof(hash)*8);
-	if (strcmp(argv[1], "-")) {
-        	f = fopen(argv[1], "r");
-		if (f == NULL) {
-			printf("Failed to open the file!\n");
+	if (!serial) {
+		/* mmap for files, reader thread for pipes */
+		getrusage(RUSAGE_SELF, &start);
+		if (Skein_Hash_File(&state, argv[1], hash) != SUCCESS) {
+			printf("Failed to hash the file!\n");
 			return 1;
 		}
+		getrusage(RUSAGE_SELF, &end);
 	} else {
-		f = stdin;
-	}
-	
-	getrusage(RUSAGE_SELF, &start);
-	while ((len = fread(buffer, 1, LEN, f))) {
-		Update(&state, buffer, len*8);
+		if (strcmp(argv[1], "-")) {
+			f = fopen(argv[1], "r");
+			if (f == NULL) {
+				printf("Failed to open the file!\n");
+				return 1;
+			}
+		} else {
+			f = stdin;
+		}
+
+		getrusage(RUSAGE_SELF, &start);
+		while ((len = fread(buffer, 1, LEN, f))) {
+			Update(&state, buffer, len*8);
+		}
+		Final(&state, hash);
+		getrusage(RUSAGE_SELF, &end);
 	}
-	Final(&state, hash);
-	getrusage(RUSAGE_SELF, &end);
 	
 	for (i = 0; i < sizeof(hash); i++)
 		printf("%.2X", hash[i]);
 	timeval_subtract(&start.ru_utime, &end.ru_utime, &start.ru_utime);
 	printf("\n");
 	printf("Needed %i seconds and %i useconds.\n", (unsigned int) start.ru_utime.tv_sec, (unsigned int) start.ru_utime.tv_usec);
+	printf("Kernel: %s\n", Skein_Get_Kernel());
+	printf("Prefetch: %s\n", Skein_Get_Prefetch());
 	return 0;
 }
@@ -1,67 +1,1311 @@
 #include "SHA3api_ref.h"
+#include "skein_kernel.h"
+#include "skein_tree.h"
+#include "skein_mac.h"
+#include "skein_pool.h"
+#include "skein_stats.h"
+#include "skein_prng.h"
+#include "skein_kdf.h"
+#include "skein_threefish.h"
+#include "skein_arena.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-#define T(d, r) { .data = (unsigned char*) d, .result = (unsigned char*) r, .datalen = 8 * (sizeof(d) - 1), }
-#define TN(n, d, r) { .data = (unsigned char*) d, .result = (unsigned char*) r, .datalen = n, }
+#define ITEMS(array) (sizeof(array)/sizeof(array[0]))
 
-static struct {
-	unsigned char *data, *result;
-	size_t datalen;
-} tests256[] = {
-#include "short_test_256_data.h"
-#include "long_test_256_data.h"
-};
+/*
+ * The known answer tests are the NIST KAT files ("Len = ", "Msg = ",
+ * "MD = " lines), mapped and parsed while the vectors run. Each file is
+ * cut into pieces of KAT_PIECE bytes, a piece runs the vectors whose
+ * "Len = " line starts in it. The pieces of all files go to one thread
+ * per CPU, once for every kernel the CPU can run.
+ */
+#define KAT_PIECE	(64 * 1024)
+#define KAT_BATCH	16	/* 512 bit vectors per Skein_512_Hash_Many() */
+#define KAT_THREADS	16
 
-static struct {
-	unsigned char *data, *result;
-	size_t datalen;
-} tests512[] = {
-#include "short_test_512_data.h"
-#include "long_test_512_data.h"
-};
+typedef struct {
+	const char *name;
+	int hashBits;
+	const char *map;	/* the file, NULL if it could not be mapped */
+	size_t size;
+} Kat_File_t;
 
-static struct {
-	unsigned char *data, *result;
-	size_t datalen;
-} tests1024[] = {
-#include "short_test_1024_data.h"
-#include "long_test_1024_data.h"
+static Kat_File_t kat_files[] = {
+	{ "short_test_256.data", 256, NULL, 0 },
+	{ "long_test_256.data", 256, NULL, 0 },
+	{ "short_test_512.data", 512, NULL, 0 },
+	{ "long_test_512.data", 512, NULL, 0 },
+	{ "short_test_1024.data", 1024, NULL, 0 },
+	{ "long_test_1024.data", 1024, NULL, 0 },
 };
 
-#define ITEMS(array) (sizeof(array)/sizeof(array[0]))
+typedef struct {
+	size_t bits;		/* message length */
+	const char *msg, *md;	/* the hex digits, in the mapping */
+	size_t msgLen, mdLen;
+} Kat_Vector_t;
+
+/* a byte aligned 512 bit vector, waiting for Skein_512_Hash_Many() */
+typedef struct {
+	const Kat_File_t *file;
+	size_t bits;
+	u08b_t *msg;
+	size_t size;		/* of msg[] */
+	u08b_t md[512 / 8];
+} Kat_Lane_t;
+
+typedef struct {
+	const char *kernel;
+	size_t *next;		/* the next piece, shared by all workers */
+	u08b_t *msg;		/* the message, SKEIN_ALIGNMENT aligned */
+	u08b_t *odd;		/* ... and a copy at odd + 1 */
+	size_t size;		/* of both */
+	Kat_Lane_t lane[KAT_BATCH];
+	size_t lanes;
+	int result;
+} Kat_Worker_t;
+
+/* Update() sizes around the block sizes, so Update() sees all offsets */
+static const size_t kat_chunk[] = { 1, 13, 32, 31, 64, 65, 3, 127, 128, 129, 200 };
+
+static void kat_fail(const Kat_Worker_t * w, const Kat_File_t * f, size_t bits,
+		     const char *what)
+{
+	printf("FAIL %s %s (%s): Len = %lu!\n", f->name, what, w->kernel,
+	       (unsigned long) bits);
+}
+
+/* the line at *pos (without the line end), *pos moves to the next one */
+static size_t kat_line(const Kat_File_t * f, size_t * pos, const char **line)
+{
+	const char *s = f->map + *pos;
+	const char *e = memchr(s, '\n', f->size - *pos);
+	size_t n;
+
+	if (e == NULL)
+		e = f->map + f->size;
+	*pos = e - f->map + (e < f->map + f->size);
+	n = e - s;
+	if (n && s[n - 1] == '\r')
+		n--;
+	*line = s;
+	return n;
+}
+
+/* the value of a "key = value" line */
+static int kat_value(const char *line, size_t n, const char *key,
+		     const char **val, size_t * len)
+{
+	size_t k = strlen(key);
+
+	if (n < k || memcmp(line, key, k))
+		return 0;
+	*val = line + k;
+	*len = n - k;
+	return 1;
+}
+
+/* the next vector whose "Len = " line starts before stop: 1, 0 if there
+   is none, -1 for a broken one */
+static int kat_next(const Kat_File_t * f, size_t * pos, size_t stop,
+		    Kat_Vector_t * v)
+{
+	const char *line, *val;
+	size_t n, len;
+	char num[24];
+
+	do {
+		if (*pos >= f->size || *pos >= stop)
+			return 0;
+		n = kat_line(f, pos, &line);
+	} while (!kat_value(line, n, "Len = ", &val, &len));
+
+	if (len == 0 || len >= sizeof(num))
+		return -1;
+	memcpy(num, val, len);
+	num[len] = 0;
+	v->bits = strtoul(num, NULL, 10);
+
+	n = kat_line(f, pos, &line);
+	if (!kat_value(line, n, "Msg = ", &v->msg, &v->msgLen))
+		return -1;
+	n = kat_line(f, pos, &line);
+	if (!kat_value(line, n, "MD = ", &v->md, &v->mdLen))
+		return -1;
+	return 1;
+}
+
+/* bytes from hex digits, 0 if there are not enough */
+static int kat_hex(u08b_t * out, const char *hex, size_t len, size_t bytes)
+{
+	size_t i;
+	int d[2], j;
+
+	if (len < 2 * bytes)
+		return 0;
+	for (i = 0; i < bytes; i++) {
+		for (j = 0; j < 2; j++) {
+			char c = hex[2 * i + j];
+
+			if (c >= '0' && c <= '9')
+				d[j] = c - '0';
+			else if (c >= 'A' && c <= 'F')
+				d[j] = c - 'A' + 10;
+			else if (c >= 'a' && c <= 'f')
+				d[j] = c - 'a' + 10;
+			else
+				return 0;
+		}
+		out[i] = (u08b_t) (d[0] << 4 | d[1]);
+	}
+	return 1;
+}
+
+/* the waiting 512 bit vectors as lanes of Skein_512_Hash_Many() */
+static void kat_flush(Kat_Worker_t * w)
+{
+	Skein_512_Ctxt_t ctx_store[KAT_BATCH], *ctx[KAT_BATCH];
+	const u08b_t *msg[KAT_BATCH];
+	size_t len[KAT_BATCH], i;
+	u08b_t hash_store[KAT_BATCH][512 / 8], *hash[KAT_BATCH];
+
+	for (i = 0; i < w->lanes; i++) {
+		ctx[i] = &ctx_store[i];
+		Skein_512_Init(ctx[i], 512);
+		msg[i] = w->lane[i].msg;
+		len[i] = w->lane[i].bits / 8;
+		hash[i] = hash_store[i];
+	}
+
+	Skein_512_Hash_Many(ctx, msg, len, hash, w->lanes);
+
+	for (i = 0; i < w->lanes; i++) {
+		if (memcmp(w->lane[i].md, hash[i], 512 / 8)) {
+			kat_fail(w, w->lane[i].file, w->lane[i].bits, "Hash_Many");
+			w->result = 1;
+		}
+	}
+	w->lanes = 0;
+}
+
+/* room for the messages of bytes bytes */
+static int kat_grow(Kat_Worker_t * w, size_t bytes)
+{
+	size_t size = w->size ? w->size : 1024;
+	void *p;
+
+	while (size < bytes + 1)
+		size *= 2;
+	if (posix_memalign(&p, SKEIN_ALIGNMENT, size))
+		return 0;
+	free(w->msg);
+	free(w->odd);
+	w->msg = p;
+	w->odd = malloc(size + 1);
+	w->size = w->odd ? size : 0;
+	return w->odd != NULL;
+}
+
+/* one vector: one-shot aligned and unaligned, Hash_Short, in pieces, and many512 */
+static void kat_check(Kat_Worker_t * w, const Kat_File_t * f,
+		      const Kat_Vector_t * v)
+{
+	size_t bytes = (v->bits + 7) / 8, mdBytes = f->hashBits / 8;
+	size_t pos, n, i;
+	BitSequence md[1024 / 8], hash[1024 / 8];
+	hashState state;
+	Kat_Lane_t *lane;
+
+	if ((bytes >= w->size && !kat_grow(w, bytes)) ||
+	    !kat_hex(w->msg, v->msg, v->msgLen, bytes) ||
+	    !kat_hex(md, v->md, v->mdLen, mdBytes)) {
+		kat_fail(w, f, v->bits, "vector");
+		w->result = 1;
+		return;
+	}
+
+	Hash(f->hashBits, w->msg, v->bits, hash);
+	if (memcmp(md, hash, mdBytes)) {
+		kat_fail(w, f, v->bits, "aligned");
+		w->result = 1;
+	}
+
+	memcpy(w->odd + 1, w->msg, bytes);
+	Hash(f->hashBits, w->odd + 1, v->bits, hash);
+	if (memcmp(md, hash, mdBytes)) {
+		kat_fail(w, f, v->bits, "unaligned");
+		w->result = 1;
+	}
+
+	if (v->bits % 8 == 0) {	/* any length, also more than one block */
+		if (f->hashBits == 256)
+			Skein_256_Hash_Short(256, w->odd + 1, bytes, hash);
+		else if (f->hashBits == 512)
+			Skein_512_Hash_Short(512, w->odd + 1, bytes, hash);
+		else
+			Skein1024_Hash_Short(1024, w->odd + 1, bytes, hash);
+		if (memcmp(md, hash, mdBytes)) {
+			kat_fail(w, f, v->bits, "Hash_Short");
+			w->result = 1;
+		}
+	}
+
+	Init(&state, f->hashBits);
+	for (pos = 0, i = 0; pos < v->bits / 8; pos += n, i++) {
+		n = kat_chunk[i % ITEMS(kat_chunk)];
+		if (n > v->bits / 8 - pos)
+			n = v->bits / 8 - pos;
+		UpdateBytes(&state, w->msg + pos, n);
+	}
+	Update(&state, w->msg + pos, v->bits & 7);	/* the partial byte */
+	Final(&state, hash);
+	if (memcmp(md, hash, mdBytes)) {
+		kat_fail(w, f, v->bits, "chunked Update");
+		w->result = 1;
+	}
+
+	if (f->hashBits != 512 || v->bits % 8)
+		return;
+	lane = &w->lane[w->lanes];
+	if (bytes > lane->size) {
+		free(lane->msg);
+		lane->size = w->size;
+		lane->msg = malloc(lane->size);
+		if (lane->msg == NULL) {
+			lane->size = 0;
+			kat_fail(w, f, v->bits, "vector");
+			w->result = 1;
+			return;
+		}
+	}
+	lane->file = f;
+	lane->bits = v->bits;
+	if (bytes > 0)		/* lane->msg may still be NULL */
+		memcpy(lane->msg, w->msg, bytes);
+	memcpy(lane->md, md, sizeof(lane->md));
+	if (++w->lanes == KAT_BATCH)
+		kat_flush(w);
+}
+
+/* run pieces until there are none left */
+static void *kat_worker(void *arg)
+{
+	Kat_Worker_t *w = arg;
+	Kat_Vector_t v;
+	size_t piece, pos, stop, i;
+	int r;
+
+	for (;;) {
+		piece = __sync_fetch_and_add(w->next, 1);
+		for (i = 0; i < ITEMS(kat_files); i++) {
+			if (piece * KAT_PIECE < kat_files[i].size)
+				break;
+			piece -= (kat_files[i].size + KAT_PIECE - 1) / KAT_PIECE;
+		}
+		if (i == ITEMS(kat_files))
+			break;
+
+		pos = piece * KAT_PIECE;
+		stop = pos + KAT_PIECE;
+		if (pos) {	/* the vector of the line before is not ours */
+			const char *line;
+
+			pos--;
+			kat_line(&kat_files[i], &pos, &line);
+		}
+		while ((r = kat_next(&kat_files[i], &pos, stop, &v)) > 0)
+			kat_check(w, &kat_files[i], &v);
+		if (r < 0) {
+			kat_fail(w, &kat_files[i], v.bits, "format");
+			w->result = 1;
+		}
+	}
+
+	if (w->lanes)
+		kat_flush(w);
+	return NULL;
+}
+
+/* all vectors with the kernel in use */
+static int kat_run(const char *kernel)
+{
+	static Kat_Worker_t w[KAT_THREADS];
+	pthread_t tid[KAT_THREADS];
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t next = 0, threads, started, i, j;
+	int result = 0;
+
+	threads = (cpus < 1) ? 1 : (cpus > KAT_THREADS) ? KAT_THREADS : cpus;
+	for (i = 0; i < threads; i++) {
+		w[i].kernel = kernel;
+		w[i].next = &next;
+		w[i].result = 0;
+	}
+
+	for (started = 1; started < threads; started++)
+		if (pthread_create(&tid[started], NULL, kat_worker, &w[started]))
+			break;
+	kat_worker(&w[0]);
+	for (i = 1; i < started; i++)
+		pthread_join(tid[i], NULL);
+
+	for (i = 0; i < threads; i++) {
+		result |= w[i].result;
+		free(w[i].msg);
+		free(w[i].odd);
+		for (j = 0; j < KAT_BATCH; j++)
+			free(w[i].lane[j].msg);
+		memset(&w[i], 0, sizeof(w[i]));
+	}
+	return result;
+}
+
+/* The KAT files in dir, with every kernel that this CPU can run. */
+static int test_kat(const char *dir)
+{
+	char path[4096];
+	const char *kernel = Skein_Get_Kernel();
+	struct stat st;
+	size_t i;
+	int fd, result = 0;
+
+	for (i = 0; i < ITEMS(kat_files); i++) {
+		Kat_File_t *f = &kat_files[i];
+
+		snprintf(path, sizeof(path), "%s/%s", dir, f->name);
+		fd = open(path, O_RDONLY);
+		if (fd >= 0 && fstat(fd, &st) == 0 && st.st_size > 0) {
+			f->map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			f->size = (f->map == MAP_FAILED) ? 0 : st.st_size;
+		}
+		if (fd >= 0)
+			close(fd);
+		if (f->size == 0) {
+			printf("FAIL KAT file %s!\n", path);
+			f->map = NULL;
+			result = 1;
+		}
+	}
+
+	for (i = 0; Skein_Kernel_List[i] != NULL; i++) {
+		if (!Skein_Kernel_List[i]->available())
+			continue;
+		Skein_Set_Kernel(Skein_Kernel_List[i]->name);
+		if (kat_run(Skein_Kernel_List[i]->name))
+			result = 1;
+	}
+	Skein_Set_Kernel(kernel);
+
+	for (i = 0; i < ITEMS(kat_files); i++) {
+		if (kat_files[i].map != NULL)
+			munmap((void *) kat_files[i].map, kat_files[i].size);
+		kat_files[i].map = NULL;
+		kat_files[i].size = 0;
+	}
+
+	return result;
+}
+
+/* A two leaf tree built by hand, and the thread count must not matter. */
+static int test_tree(void)
+{
+	static u08b_t msg[100000];
+	static const u64b_t treeInfo[] = {
+		SKEIN_CFG_TREE_INFO(1, 1, 2),
+		SKEIN_CFG_TREE_INFO(1, 1, 0xFF),
+		SKEIN_CFG_TREE_INFO(2, 3, 3),
+		SKEIN_CFG_TREE_INFO(7, 2, 0xFF),
+	};
+	static const uint_t stateBits[] = { 256, 512, 1024 };
+	Skein_512_Ctxt_t base, ctx;
+	u08b_t M[2 * 64], ref[512 / 8], hash1[1024 / 8], hashN[1024 / 8];
+	size_t i, j, len;
+	int result = 0;
+
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = (u08b_t) (i * 7 + (i >> 8));
+
+	Skein_512_InitExt(&base, 512, SKEIN_CFG_TREE_INFO(1, 1, 2), NULL, 0);
+	for (i = 0; i < 2; i++) {
+		ctx = base;
+		Skein_Start_New_Type(&ctx, MSG);
+		Skein_Set_Tree_Level(ctx.h, 1);
+		ctx.h.T[0] = 128 * i;
+		Skein_512_Update(&ctx, msg + 128 * i, i ? 72 : 128);
+		Skein_512_Final_Pad(&ctx, M + 64 * i);
+	}
+	ctx = base;
+	Skein_Start_New_Type(&ctx, MSG);
+	Skein_Set_Tree_Level(ctx.h, 2);
+	Skein_512_Update(&ctx, M, sizeof(M));
+	Skein_512_Final_Pad(&ctx, ref);
+	Skein_512_Output(&ctx, ref);
+
+	Skein_Tree_Hash(512, 512, SKEIN_CFG_TREE_INFO(1, 1, 2), NULL, 0,
+			msg, 200, hash1, 2);
+	if (memcmp(ref, hash1, sizeof(ref))) {
+		printf("FAIL tree: two leaves!\n");
+		result = 1;
+	}
+
+	for (i = 0; i < ITEMS(stateBits); i++)
+		for (j = 0; j < ITEMS(treeInfo); j++)
+			for (len = 0; len <= sizeof(msg); len += 33333) {
+				Skein_Tree_Hash(stateBits[i], stateBits[i],
+						treeInfo[j], NULL, 0, msg, len,
+						hash1, 1);
+				Skein_Tree_Hash(stateBits[i], stateBits[i],
+						treeInfo[j], NULL, 0, msg, len,
+						hashN, 4);
+				if (memcmp(hash1, hashN, stateBits[i] / 8)) {
+					printf("FAIL tree: %u bit, %d, %d!\n",
+					       stateBits[i], (int) j, (int) len);
+					result = 1;
+				}
+			}
+
+	return result;
+}
+
+/* The incremental tree state must give Skein_Tree_Hash() of the current
+   message after appends, leaf replacements and a Save()/Load() cycle. */
+static int test_tree_state(void)
+{
+	static u08b_t msg[30000], buf[60000];
+	static const u64b_t treeInfo[] = {
+		SKEIN_CFG_TREE_INFO(1, 1, 0xFF),
+		SKEIN_CFG_TREE_INFO(1, 2, 3),
+		SKEIN_CFG_TREE_INFO(2, 1, 2),
+	};
+	static const uint_t stateBits[] = { 256, 512, 1024 };
+	Skein_Tree_State_t st, st2;
+	u08b_t ref[1024 / 8], hash[1024 / 8];
+	size_t i, j, len, n, leaf, saved;
+	int result = 0;
+
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = (u08b_t) (i * 11 + (i >> 7));
+
+	for (i = 0; i < sizeof(treeInfo) / sizeof(treeInfo[0]); i++)
+		for (j = 0; j < sizeof(stateBits) / sizeof(stateBits[0]); j++) {
+			Skein_Tree_State_Init(&st, stateBits[j], 1024, treeInfo[i],
+					      (const u08b_t *) "key", 3);
+			for (len = 0; len < sizeof(msg); len += n) {
+				Skein_Tree_State_Final(&st, hash);
+				Skein_Tree_Hash(stateBits[j], 1024, treeInfo[i],
+						(const u08b_t *) "key", 3, msg, len, ref, 1);
+				if (memcmp(ref, hash, sizeof(ref))) {
+					printf("FAIL tree state: append %u/%u/%u!\n",
+					       (unsigned int) i, stateBits[j], (unsigned int) len);
+					result = 1;
+					break;
+				}
+				n = (len % 7) * 301 + 1;
+				if (n > sizeof(msg) - len)
+					n = sizeof(msg) - len;
+				Skein_Tree_Append(&st, msg + len, n);
+			}
+
+			/* change the message, replace its leaves to match */
+			leaf = Skein_Tree_Leaf_Bytes(stateBits[j], treeInfo[i]);
+			msg[leaf + 5] ^= 1;
+			msg[sizeof(msg) - 1] ^= 1;
+			Skein_Tree_Replace_Leaf(&st, 1, msg + leaf, leaf);
+			n = (sizeof(msg) - 1) / leaf;	/* the last leaf */
+			Skein_Tree_Replace_Leaf(&st, n, msg + n * leaf,
+						sizeof(msg) - n * leaf);
+
+			saved = Skein_Tree_Save(&st, buf, sizeof(buf));
+			Skein_Tree_State_Free(&st);
+			if (saved > sizeof(buf)
+			    || Skein_Tree_Load(&st2, buf, saved, 1024, (const u08b_t *) "key", 3) != SKEIN_SUCCESS
+			    || Skein_Tree_Load(&st, buf, saved - 1, 1024, (const u08b_t *) "key", 3) == SKEIN_SUCCESS
+			    || Skein_Tree_Load(&st, buf, saved, 512, (const u08b_t *) "key", 3) == SKEIN_SUCCESS) {
+				printf("FAIL tree state: load %u/%u!\n", (unsigned int) i, stateBits[j]);
+				return 1;
+			}
+			buf[8] = 100;	/* stateBits */
+			if (Skein_Tree_Load(&st, buf, saved, 1024, (const u08b_t *) "key", 3) == SKEIN_SUCCESS
+			    || Skein_Tree_Replace_Leaf(&st2, n + 1, msg, leaf) == SKEIN_SUCCESS
+			    || Skein_Tree_Replace_Leaf(&st2, 0, msg, leaf - 1) == SKEIN_SUCCESS
+			    || Skein_Tree_Replace_Leaf(&st2, n, msg, leaf + 1) == SKEIN_SUCCESS) {
+				printf("FAIL tree state: bad input %u/%u!\n", (unsigned int) i, stateBits[j]);
+				return 1;
+			}
+			Skein_Tree_State_Final(&st2, hash);
+			Skein_Tree_Hash(stateBits[j], 1024, treeInfo[i],
+					(const u08b_t *) "key", 3, msg, sizeof(msg), ref, 1);
+			if (memcmp(ref, hash, sizeof(ref))) {
+				printf("FAIL tree state: replace %u/%u!\n", (unsigned int) i, stateBits[j]);
+				result = 1;
+			}
+			Skein_Tree_State_Free(&st2);
+			msg[leaf + 5] ^= 1;
+			msg[sizeof(msg) - 1] ^= 1;
+		}
+
+	return result;
+}
+
+/* Replacing leaves of a large binary tree hashes one node per level and leaf. */
+static int test_tree_refresh(void)
+{
+	const u64b_t treeInfo = SKEIN_CFG_TREE_INFO(1, 1, 0xFF);
+	const size_t leaf = 128, leaves = 4096;
+	Skein_Tree_State_t st;
+	u08b_t ref[512 / 8], hash[512 / 8], *msg;
+	u64b_t nodes;
+	size_t i;
+	int result = 0;
+
+	msg = malloc(leaves * leaf);
+	if (msg == NULL)
+		return 1;
+	for (i = 0; i < leaves * leaf; i++)
+		msg[i] = (u08b_t) (i * 7 + (i >> 9));
+
+	Skein_Tree_State_Init(&st, 512, 512, treeInfo, NULL, 0);
+	Skein_Tree_Append(&st, msg, leaves * leaf);
+	Skein_Tree_State_Final(&st, hash);
+
+	msg[3] ^= 1;
+	msg[3000 * leaf] ^= 1;
+	nodes = st.nodes;
+	Skein_Tree_Replace_Leaf(&st, 0, msg, leaf);
+	Skein_Tree_Replace_Leaf(&st, 3000, msg + 3000 * leaf, leaf);
+	Skein_Tree_State_Final(&st, hash);
+	Skein_Tree_Hash(512, 512, treeInfo, NULL, 0, msg, leaves * leaf, ref, 1);
+	if (memcmp(ref, hash, sizeof(ref))) {
+		printf("FAIL tree refresh: hash!\n");
+		result = 1;
+	}
+	/* 13 levels, the paths of leaves 0 and 3000 only share the root */
+	if (st.levels != 13 || st.nodes - nodes != 2 * 13 - 1) {
+		printf("FAIL tree refresh: %u nodes hashed!\n",
+		       (unsigned int) (st.nodes - nodes));
+		result = 1;
+	}
+
+	Skein_Tree_State_Free(&st);
+	free(msg);
+	return result;
+}
+
+/* A context started with one kernel must finish right with every other one. */
+static int test_kernel_switch(void)
+{
+	const char *kernel = Skein_Get_Kernel();
+	Skein_512_Prepared_t prep;
+	Skein_256_Ctxt_t c256;
+	Skein_512_Ctxt_t c512;
+	Skein1024_Ctxt_t c1024;
+	u08b_t key[100], msg[300], ref[4][1024 / 8], hash[1024 / 8];
+	size_t i, j;
+	int bad, result = 0;
+
+	for (i = 0; i < sizeof(key); i++)
+		key[i] = (u08b_t) (7 * i + 2);
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = (u08b_t) (11 * i);
+
+	Skein_Set_Kernel("scalar");
+	Skein_256_InitExt(&c256, 256, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, sizeof(key));
+	Skein_256_Update(&c256, msg, sizeof(msg));
+	Skein_256_Final(&c256, ref[0]);
+	Skein_512_InitExt(&c512, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, sizeof(key));
+	Skein_512_Update(&c512, msg, sizeof(msg));
+	Skein_512_Final(&c512, ref[1]);
+	Skein1024_InitExt(&c1024, 1024, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, sizeof(key));
+	Skein1024_Update(&c1024, msg, sizeof(msg));
+	Skein1024_Final(&c1024, ref[2]);
+	Skein_512_Init(&c512, 512);	/* precomputed IV */
+	Skein_512_Update(&c512, msg, sizeof(msg));
+	Skein_512_Final(&c512, ref[3]);
+
+	for (i = 0; Skein_Kernel_List[i] != NULL; i++) {
+		if (!Skein_Kernel_List[i]->available())
+			continue;
+		for (j = 0; Skein_Kernel_List[j] != NULL; j++) {
+			if (!Skein_Kernel_List[j]->available())
+				continue;
+
+			/* the key and the first 100 bytes with kernel i */
+			Skein_Set_Kernel(Skein_Kernel_List[i]->name);
+			Skein_256_InitExt(&c256, 256, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, sizeof(key));
+			Skein_256_Update(&c256, msg, 100);
+			Skein1024_InitExt(&c1024, 1024, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, sizeof(key));
+			Skein1024_Update(&c1024, msg, 100);
+			Skein_512_MAC_Prepare(&prep, 512, key, sizeof(key));
+
+			/* the rest with kernel j */
+			Skein_Set_Kernel(Skein_Kernel_List[j]->name);
+			Skein_256_Update(&c256, msg + 100, sizeof(msg) - 100);
+			Skein_256_Final(&c256, hash);
+			bad = memcmp(hash, ref[0], 256 / 8) != 0;
+			Skein1024_Update(&c1024, msg + 100, sizeof(msg) - 100);
+			Skein1024_Final(&c1024, hash);
+			bad |= memcmp(hash, ref[2], 1024 / 8) != 0;
+			Skein_512_MAC(&prep, msg, sizeof(msg), hash);
+			bad |= memcmp(hash, ref[1], 512 / 8) != 0;
+			Skein_Set_Kernel(Skein_Kernel_List[i]->name);
+			Skein_512_Init(&c512, 512);
+			Skein_Set_Kernel(Skein_Kernel_List[j]->name);
+			Skein_512_Update(&c512, msg, sizeof(msg));
+			Skein_512_Final(&c512, hash);
+			bad |= memcmp(hash, ref[3], 512 / 8) != 0;
+			if (bad) {
+				printf("FAIL kernel switch: %s -> %s!\n",
+				       Skein_Kernel_List[i]->name,
+				       Skein_Kernel_List[j]->name);
+				result = 1;
+			}
+		}
+	}
+	Skein_Set_Kernel(kernel);
+
+	return result;
+}
+
+/* Prepared and cached MAC keys must give the same MAC as InitExt(). */
+static int test_mac(void)
+{
+	static Skein_512_MAC_Cache_t cache;
+	Skein_512_Prepared_t prep;
+	const Skein_512_Prepared_t *prep2;
+	Skein_512_Ctxt_t ctx;
+	u08b_t key[100], msg[300], ref[512 / 8], mac[512 / 8];
+	size_t i, keyBytes;
+	int result = 0;
+
+	for (i = 0; i < sizeof(key); i++)
+		key[i] = (u08b_t) (3 * i + 1);
+	for (i = 0; i < sizeof(msg); i++)
+		msg[i] = (u08b_t) (5 * i);
+
+	Skein_512_MAC_Cache_Init(&cache);
+	for (i = 0; i < 3 * sizeof(key); i++) {
+		keyBytes = (i * 37) % sizeof(key) + 1;	/* revisit keys */
+
+		Skein_512_InitExt(&ctx, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+				  key, keyBytes);
+		Skein_512_Update(&ctx, msg, i);
+		Skein_512_Final(&ctx, ref);
+
+		Skein_512_MAC_Prepare(&prep, 512, key, keyBytes);
+		Skein_512_MAC(&prep, msg, i, mac);
+		if (memcmp(ref, mac, sizeof(mac))) {
+			printf("FAIL MAC prepared: %d!\n", (int) i);
+			result = 1;
+		}
+
+		Skein_512_MAC(Skein_512_MAC_Cache_Get(&cache, 512, key, keyBytes),
+			      msg, i, mac);
+		if (memcmp(ref, mac, sizeof(mac))) {
+			printf("FAIL MAC cached: %d!\n", (int) i);
+			result = 1;
+		}
+	}
+
+	/* long keys (by their hash) and the empty key are cached too */
+	for (i = 0; i < 2; i++) {
+		keyBytes = i ? sizeof(key) : 0;
+		Skein_512_InitExt(&ctx, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+				  key, keyBytes);
+		Skein_512_Update(&ctx, msg, sizeof(msg));
+		Skein_512_Final(&ctx, ref);
+		prep2 = Skein_512_MAC_Cache_Get(&cache, 512, key, keyBytes);
+		Skein_512_MAC(Skein_512_MAC_Cache_Get(&cache, 512, key, keyBytes),
+			      msg, sizeof(msg), mac);
+		if (prep2 != Skein_512_MAC_Cache_Get(&cache, 512, key, keyBytes)
+		    || memcmp(ref, mac, sizeof(mac))) {
+			printf("FAIL MAC cache hit: %d bytes!\n", (int) keyBytes);
+			result = 1;
+		}
+	}
+	key[sizeof(key) - 1] ^= 1;	/* another long key, only the last byte differs */
+	if (Skein_512_MAC_Cache_Get(&cache, 512, key, sizeof(key)) == prep2) {
+		printf("FAIL MAC cache: other long key found!\n");
+		result = 1;
+	}
+	Skein_512_MAC_Cache_Clear(&cache);
+
+	return result;
+}
 
-int main(void)
+/* Reading the output in pieces and seeking must match Final(). */
+static int test_xof(void)
 {
-	BitSequence hash256[256 / 8];
-	BitSequence hash512[512 / 8];
-	BitSequence hash1024[1024 / 8];
-	int i;
+	static u08b_t ref[3000], out[3000];
+	Skein_512_Ctxt_t ctx;
+	Skein_512_XOF_t xof;
+	size_t i, n, got;
 	int result = 0;
 
-	for (i = 0; i < ITEMS(tests256); i++) {
-		Hash(256, tests256[i].data, tests256[i].datalen, hash256);
-		if (memcmp(tests256[i].result, hash256, sizeof(hash256))) {
-			printf("FAIL 256bit: %d!\n", i);
+	Skein_512_Init(&ctx, 8 * sizeof(ref));
+	Skein_512_Update(&ctx, (const u08b_t *) "abc", 3);
+	Skein_512_XOF_Start(&xof, &ctx);
+	Skein_512_Final(&ctx, ref);
+
+	memset(out, 0, sizeof(out));
+	for (i = got = 0; got < sizeof(out); i++) {
+		n = (i * 29) % 150;	/* odd and block sized pieces */
+		got += Skein_512_XOF_Read(&xof, out + got, n);
+	}
+	if (memcmp(ref, out, sizeof(ref)) || Skein_512_XOF_Read(&xof, out, 1)) {
+		printf("FAIL XOF read!\n");
+		result = 1;
+	}
+
+	for (i = 0; i < sizeof(ref); i += 211) {
+		Skein_512_XOF_Seek(&xof, i);
+		n = Skein_512_XOF_Read(&xof, out, 100);
+		if (memcmp(ref + i, out, n)) {
+			printf("FAIL XOF seek: %d!\n", (int) i);
 			result = 1;
-                }
+		}
+	}
+
+	return result;
+}
+
+/* The counters of a known sequence of calls (only with SKEIN_STATS). */
+static int test_stats(void)
+{
+#if SKEIN_STATS
+	Skein_Stats_t before, after;
+	Skein_512_Ctxt_t ctx;
+	u08b_t msg[200], hash[512 / 8];
+
+	memset(msg, 0x5A, sizeof(msg));
+	Skein_Get_Stats(&before);
+	Skein_512_Init(&ctx, 512);
+	Skein_512_Update(&ctx, msg, 10);	/* buffered */
+	Skein_512_Update(&ctx, msg, 200);	/* b[] + 2 blocks, 18 bytes buffered */
+	Skein_512_Final(&ctx, hash);	/* final block + output */
+	Skein_Get_Stats(&after);
+
+	/* Init() uses the precomputed IV: no config block */
+	if (after.blocks512 - before.blocks512 != 5 ||
+	    after.updates - before.updates != 2 ||
+	    after.bufferedUpdates - before.bufferedUpdates != 2 ||
+	    (after.alignedBytes + after.unalignedBytes) -
+	    (before.alignedBytes + before.unalignedBytes) != 5 * 64) {
+		printf("FAIL stats!\n");
+		return 1;
+	}
+#endif
+	return 0;
+}
+
+/* InitArgs() must match InitExt() and the block by block definition, and a
+   copy of the context plus Nonce() must match InitArgs() with a nonce. */
+static int test_init_args(void)
+{
+	static const u08b_t key[] = "key", pers[] = "20261014 me@example.com skein";
+	static const u08b_t pk[100] = { 1, 2, 3 }, nonce[] = "nonce";
+	Skein_Args_t args;
+	Skein1024_Ctxt_t big, bigRef;
+	Skein_512_Ctxt_t prefix, ctx, ref;
+	hashState state;
+	u08b_t h[64], hRef[64], X[64];
+	int result = 0;
+
+	memset(&args, 0, sizeof(args));
+	args.key = key;
+	args.keyBytes = sizeof(key);
+	Skein1024_InitArgs(&big, 1024, &args);
+	Skein1024_InitExt(&bigRef, 1024, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key,
+			  sizeof(key));
+	if (memcmp(&big, &bigRef, sizeof(big))) {
+		printf("FAIL InitArgs: key only!\n");
+		result = 1;
+	}
+
+	args.pers = pers;
+	args.persBytes = sizeof(pers);
+	args.pk = pk;
+	args.pkBytes = sizeof(pk);
+	Skein_512_InitArgs(&prefix, 512, &args);
+
+	Skein_512_InitExt(&ref, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key,
+			  sizeof(key));
+	Skein_Start_New_Type(&ref, PERS);
+	Skein_512_Update(&ref, pers, sizeof(pers));
+	Skein_512_Final_Pad(&ref, X);
+	Skein_Start_New_Type(&ref, PK);
+	Skein_512_Update(&ref, pk, sizeof(pk));
+	Skein_512_Final_Pad(&ref, X);
+	Skein_Start_New_Type(&ref, NONCE);
+	Skein_512_Update(&ref, nonce, sizeof(nonce));
+	Skein_512_Final_Pad(&ref, X);
+	Skein_Start_New_Type(&ref, MSG);
+	Skein_512_Update(&ref, (const u08b_t *) "msg", 3);
+	Skein_512_Final(&ref, hRef);
+
+	ctx = prefix;
+	Skein_512_Nonce(&ctx, nonce, sizeof(nonce));
+	Skein_512_Update(&ctx, (const u08b_t *) "msg", 3);
+	Skein_512_Final(&ctx, h);
+	if (memcmp(h, hRef, sizeof(h))) {
+		printf("FAIL InitArgs: prefix + Nonce!\n");
+		result = 1;
+	}
+
+	args.nonce = nonce;
+	args.nonceBytes = sizeof(nonce);
+	Skein_512_InitArgs(&ctx, 512, &args);
+	Skein_512_Update(&ctx, (const u08b_t *) "msg", 3);
+	Skein_512_Final(&ctx, h);
+	if (memcmp(h, hRef, sizeof(h))) {
+		printf("FAIL InitArgs: all arguments!\n");
+		result = 1;
+	}
+
+	/* the AHS InitExt(): the same as Skein1024_InitExt(), and Update() works */
+	Skein1024_InitExt(&big, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key, sizeof(key));
+	Skein1024_Update(&big, (const u08b_t *) "msg", 3);
+	Skein1024_Final(&big, X);
+	if (InitExt(&state, 1024, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL, key,
+		    sizeof(key)) != SUCCESS
+	    || Update(&state, (const u08b_t *) "msg", 3 * 8) != SUCCESS
+	    || Final(&state, h) != SUCCESS || memcmp(h, X, sizeof(h))
+	    || InitExt(&state, 100, 512, SKEIN_CFG_TREE_INFO_SEQUENTIAL, NULL, 0) == SUCCESS) {
+		printf("FAIL InitArgs: AHS InitExt!\n");
+		result = 1;
+	}
+
+	/* Hash() of the empty message, with no buffer at all */
+	Skein_512_Init(&ctx, 512);
+	Skein_512_Final(&ctx, hRef);
+	if (Hash(512, NULL, 0, h) != SUCCESS || memcmp(h, hRef, sizeof(h))) {
+		printf("FAIL Hash: empty message!\n");
+		result = 1;
+	}
+
+	return result;
+}
+
+typedef void (*Threefish_Encrypt_t) (const u08b_t * key,
+				     const u64b_t tweak[2], const u08b_t * in,
+				     u08b_t * out, size_t blkCnt);
+
+/* One Threefish size: the zero block, then a run of blocks with the tweak
+   carrying into the high word at block 3 (also a known answer), against
+   single blocks and in place. */
+static int test_threefish_size(const char *name, Threefish_Encrypt_t enc,
+			       size_t blkBytes, const u08b_t * zeroKat,
+			       const u08b_t * carryKat)
+{
+	enum { BLOCKS = 7 };
+	u08b_t key[128], in[BLOCKS * 128], out[sizeof(in)], one[128];
+	u64b_t tweak[2], t[2];
+	size_t i;
+	int result = 0;
+
+	memset(key, 0, sizeof(key));
+	memset(in, 0, sizeof(in));
+	tweak[0] = tweak[1] = 0;
+	enc(key, tweak, in, out, 1);
+	if (memcmp(out, zeroKat, blkBytes)) {
+		printf("FAIL %s: zero block!\n", name);
+		result = 1;
 	}
 
-	for (i = 0; i < ITEMS(tests512); i++) {
-		Hash(512, tests512[i].data, tests512[i].datalen, hash512);
-		if (memcmp(tests512[i].result, hash512, sizeof(hash512))) {
-			printf("FAIL 512bit: %d!\n", i);
+	for (i = 0; i < BLOCKS * blkBytes; i++) {
+		in[i] = (u08b_t) (i * 3);
+		key[i % blkBytes] = (u08b_t) (i * 5 + 1);
+	}
+	tweak[0] = ~(u64b_t) 0 - 2;
+	tweak[1] = 5;
+	enc(key, tweak, in, out, BLOCKS);
+	if (memcmp(out + 3 * blkBytes, carryKat, blkBytes)) {
+		printf("FAIL %s: tweak carry!\n", name);
+		result = 1;
+	}
+	for (i = 0; i < BLOCKS; i++) {
+		t[0] = tweak[0] + i;
+		t[1] = tweak[1] + (t[0] < i);
+		enc(key, t, in + blkBytes * i, one, 1);
+		if (memcmp(one, out + blkBytes * i, blkBytes)) {
+			printf("FAIL %s: block %u!\n", name, (unsigned int) i);
 			result = 1;
-                }
+		}
 	}
+	enc(key, tweak, in, in, BLOCKS);
+	if (memcmp(in, out, BLOCKS * blkBytes)) {
+		printf("FAIL %s: in place!\n", name);
+		result = 1;
+	}
+
+	return result;
+}
 
-	for (i = 0; i < ITEMS(tests1024); i++) {
-		Hash(1024, tests1024[i].data, tests1024[i].datalen, hash1024);
-		if (memcmp(tests1024[i].result, hash1024, sizeof(hash1024))) {
-			printf("FAIL 1024bit: %d!\n", i);
+/* Threefish known answers for all three sizes (with the four lane path of
+   Threefish-512 inside the run of blocks). */
+static int test_threefish(void)
+{
+	static const u08b_t zero256[32] = {
+		0xEB, 0x37, 0x3A, 0xAE, 0xB6, 0xF2, 0x8D, 0x3F,
+		0x63, 0x43, 0x79, 0x9C, 0x77, 0x8A, 0xAD, 0xAE,
+		0x98, 0xC8, 0x7A, 0x28, 0x88, 0xB4, 0x38, 0x42,
+		0xB0, 0x62, 0x95, 0xC7, 0xD7, 0x6A, 0xF5, 0x4B
+	};
+	static const u08b_t carry256[32] = {
+		0xFD, 0xEC, 0xE3, 0x5D, 0x84, 0x5A, 0xC8, 0x70,
+		0xB0, 0xA8, 0xBF, 0xAD, 0x3F, 0x13, 0x24, 0x0C,
+		0x0A, 0x0E, 0x02, 0xC3, 0xF2, 0x00, 0x9B, 0x1C,
+		0x23, 0xD1, 0x38, 0x50, 0x84, 0xC4, 0x45, 0x2E
+	};
+	static const u08b_t zero512[64] = {
+		0x54, 0xC4, 0x8F, 0xEA, 0x2D, 0xAC, 0x72, 0x22,
+		0x2C, 0x03, 0x80, 0xD1, 0xA1, 0xA9, 0xF7, 0x68,
+		0x4D, 0x47, 0xBD, 0x90, 0xFC, 0x49, 0x17, 0x24,
+		0xDC, 0x59, 0x9E, 0x18, 0x24, 0xB6, 0xB3, 0x0A,
+		0xE2, 0x2D, 0xB9, 0x7E, 0x84, 0x14, 0x82, 0xDB,
+		0x20, 0x9C, 0x0E, 0x69, 0x74, 0xC2, 0x11, 0x1A,
+		0xD6, 0xC6, 0x91, 0x98, 0x49, 0x19, 0xC1, 0x1F,
+		0x98, 0x7F, 0xC2, 0xD1, 0x32, 0x37, 0x9F, 0xB4
+	};
+	static const u08b_t carry512[64] = {
+		0xC0, 0xD8, 0x9E, 0x73, 0x21, 0xCB, 0x67, 0x80,
+		0x43, 0x0C, 0x85, 0x7D, 0xE9, 0x83, 0x05, 0xBC,
+		0x8E, 0x96, 0x87, 0x0E, 0x86, 0x02, 0x86, 0x38,
+		0xB3, 0xC3, 0x73, 0x1D, 0x4A, 0x65, 0x2D, 0x3C,
+		0x14, 0x57, 0xA4, 0x9C, 0x71, 0xC0, 0xBF, 0xFA,
+		0xA2, 0xE9, 0x76, 0xE4, 0x51, 0x6C, 0x4A, 0xAD,
+		0xC2, 0x1D, 0x92, 0x1F, 0x3F, 0x7F, 0xB3, 0x79,
+		0xD6, 0xF6, 0x72, 0x47, 0x68, 0xB3, 0xEE, 0xBA
+	};
+	static const u08b_t zero1024[128] = {
+		0x71, 0xBD, 0xC1, 0x33, 0xE2, 0x2B, 0xDC, 0x34,
+		0x7D, 0x4E, 0xB0, 0x2D, 0x9A, 0x75, 0x35, 0xF8,
+		0x2D, 0xE8, 0xD4, 0xC3, 0x26, 0x22, 0xE0, 0xFD,
+		0x49, 0x20, 0x83, 0xAA, 0xCE, 0x87, 0x5E, 0xDC,
+		0x61, 0x14, 0xE1, 0x1F, 0xD9, 0x28, 0x66, 0x5E,
+		0x3A, 0x29, 0x47, 0xF2, 0xE9, 0x28, 0x97, 0xD2,
+		0xF6, 0x2A, 0x2A, 0xFB, 0xB9, 0x8D, 0x20, 0xA9,
+		0xE2, 0xA5, 0xDD, 0xFC, 0x6C, 0xDA, 0xD4, 0x98,
+		0x64, 0x48, 0x74, 0x78, 0x6A, 0xFE, 0x37, 0x3B,
+		0x78, 0x53, 0x67, 0x2A, 0x6D, 0xA1, 0x06, 0x72,
+		0x5E, 0x94, 0x6B, 0x45, 0xD4, 0x8E, 0xD2, 0x70,
+		0xED, 0x48, 0x43, 0xF1, 0xA5, 0xAC, 0x7A, 0x23,
+		0x97, 0xCC, 0x46, 0xF0, 0x4D, 0x37, 0x36, 0xD8,
+		0x53, 0x66, 0x12, 0x82, 0x3D, 0xB0, 0xAC, 0x1F,
+		0xFA, 0xA2, 0x9E, 0x6F, 0xCC, 0x6E, 0xAB, 0x4F,
+		0xF3, 0xF3, 0x6C, 0xFA, 0xEC, 0x59, 0x46, 0x8A
+	};
+	static const u08b_t carry1024[128] = {
+		0x60, 0x35, 0x5A, 0x54, 0xB2, 0x48, 0x11, 0xBA,
+		0x98, 0x21, 0xA7, 0xC6, 0x09, 0xBB, 0x13, 0xB8,
+		0xFA, 0x31, 0xB6, 0x23, 0xDC, 0xF3, 0xCB, 0x4B,
+		0x4C, 0x05, 0xCE, 0xAD, 0x72, 0x3C, 0x63, 0x70,
+		0x9C, 0x22, 0x32, 0x19, 0x10, 0x2A, 0xC5, 0xEC,
+		0x8B, 0x25, 0x1F, 0xC8, 0x18, 0x66, 0x07, 0x58,
+		0x60, 0x44, 0xCD, 0x4C, 0xAE, 0xD2, 0x03, 0xF9,
+		0xFD, 0x6F, 0x02, 0xC3, 0xF3, 0xD2, 0x20, 0x02,
+		0xE8, 0x44, 0xCD, 0x30, 0xE0, 0x23, 0x2E, 0xDE,
+		0xEA, 0x31, 0xB6, 0x5F, 0x4B, 0xA5, 0x81, 0x13,
+		0xF6, 0x83, 0xE2, 0x78, 0x72, 0x96, 0xE2, 0x45,
+		0x88, 0x78, 0x93, 0xD6, 0x0B, 0xF1, 0x15, 0x42,
+		0xB5, 0xB4, 0xF7, 0xEA, 0xE2, 0x4A, 0x18, 0x7F,
+		0xE7, 0x6B, 0x09, 0xE1, 0x1A, 0x3E, 0x70, 0x56,
+		0xF7, 0x18, 0x62, 0x8A, 0x87, 0x73, 0x04, 0x9E,
+		0x10, 0x19, 0x32, 0x1B, 0xD4, 0x94, 0x56, 0x37
+	};
+	int result = 0;
+
+	if (test_threefish_size("Threefish-256", Threefish256_Encrypt_Blocks,
+				32, zero256, carry256))
+		result = 1;
+	if (test_threefish_size("Threefish-512", Threefish512_Encrypt_Blocks,
+				64, zero512, carry512))
+		result = 1;
+	if (test_threefish_size("Threefish-1024", Threefish1024_Encrypt_Blocks,
+				128, zero1024, carry1024))
+		result = 1;
+
+	return result;
+}
+
+/* The batched KDF must match single derivations and the spec definition. */
+static int test_kdf(void)
+{
+	enum { IDS = 37 };
+	static const u08b_t master[] = "the master key";
+	Skein_512_KDF_Prepared_t prep;
+	Skein_512_Ctxt_t ctx;
+	u08b_t idBuf[IDS][200], keyBuf[IDS][100], ref[100];
+	const u08b_t *id[IDS];
+	size_t idBytes[IDS];
+	u08b_t *key[IDS];
+	size_t i, j;
+	int result = 0;
+
+	for (i = 0; i < IDS; i++) {
+		for (j = 0; j < sizeof(idBuf[i]); j++)
+			idBuf[i][j] = (u08b_t) (i * 7 + j);
+		id[i] = idBuf[i];
+		idBytes[i] = (i * 13) % sizeof(idBuf[i]);	/* 0 to 3 blocks */
+		key[i] = keyBuf[i];
+	}
+
+	Skein_512_KDF_Prepare(&prep, 8 * sizeof(ref), master, sizeof(master));
+	if (Skein_512_KDF_Derive_Many(&prep, id, idBytes, key, IDS) != SKEIN_SUCCESS) {
+		printf("FAIL KDF: Derive_Many!\n");
+		return 1;
+	}
+	for (i = 0; i < IDS; i++) {
+		Skein_512_InitExt(&ctx, 8 * sizeof(ref), SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+				  master, sizeof(master));
+		Skein_Start_New_Type(&ctx, KDF);
+		Skein_512_Update(&ctx, id[i], idBytes[i]);
+		Skein_512_Final(&ctx, ref);
+		if (memcmp(ref, key[i], sizeof(ref))) {
+			printf("FAIL KDF: Derive_Many id %u!\n", (unsigned int) i);
 			result = 1;
-                }
+		}
+		Skein_512_KDF_Derive(&prep, id[i], idBytes[i], ref);
+		if (memcmp(ref, key[i], sizeof(ref))) {
+			printf("FAIL KDF: Derive id %u!\n", (unsigned int) i);
+			result = 1;
+		}
+	}
+
+	return result;
+}
+
+/* Arena contexts must be aligned, start from the template and be reused. */
+static int test_arena(void)
+{
+	enum { CTXS = 2500 };
+	static Skein_256_Ctxt_t *ctx[CTXS];
+	Skein_256_Ctxt_t tmpl;
+	Skein_Arena_t *arena;
+	u08b_t hash[32], ref[32];
+	size_t i, round;
+	int result = 0;
+
+	Skein_256_Init(&tmpl, 256);
+	arena = Skein_Arena_Create(256, &tmpl);
+	if (arena == NULL) {
+		printf("FAIL arena: create!\n");
+		return 1;
+	}
+
+	for (round = 0; round < 2; round++) {
+		for (i = 0; i < CTXS; i++) {
+			ctx[i] = Skein_Arena_Alloc(arena);
+			if (ctx[i] == NULL || (size_t) ctx[i] % SKEIN_ARENA_LINE) {
+				printf("FAIL arena: alloc %u!\n", (unsigned int) i);
+				Skein_Arena_Destroy(arena);
+				return 1;
+			}
+			Skein_256_Update(ctx[i], (const u08b_t *) &i, sizeof(i));
+		}
+		for (i = 0; i < CTXS; i += 2)	/* give back half, then reuse them */
+			Skein_Arena_Free(arena, ctx[i]);
+		for (i = 0; i < CTXS; i += 2) {
+			ctx[i] = Skein_Arena_Alloc(arena);
+			Skein_256_Update(ctx[i], (const u08b_t *) &i, sizeof(i));
+		}
+		for (i = 0; i < CTXS; i++) {
+			Skein_256_Final(ctx[i], hash);
+			Skein_256_Hash_Short(256, (const u08b_t *) &i, sizeof(i), ref);
+			if (memcmp(hash, ref, sizeof(ref))) {
+				printf("FAIL arena: context %u!\n", (unsigned int) i);
+				result = 1;
+			}
+			Skein_Arena_Reset(arena, ctx[i]);
+			if (memcmp(ctx[i], &tmpl, sizeof(tmpl))) {
+				printf("FAIL arena: reset %u!\n", (unsigned int) i);
+				result = 1;
+			}
+		}
+		Skein_Arena_Free_All(arena);	/* the second round reuses the chunks */
+	}
+
+	Skein_Arena_Destroy(arena);
+	return result;
+}
+
+/* The PRNG bytes must not depend on how they are requested. */
+static int test_prng(void)
+{
+	static Skein_512_PRNG_t a, b;
+	static u08b_t ref[3 * SKEIN_PRNG_BUF_BYTES + 100], out[sizeof(ref)];
+	size_t pos, n;
+	int result = 0;
+
+	Skein_512_PRNG_Init(&a, (const u08b_t *) "seed", 4);
+	Skein_512_PRNG_Bytes(&a, ref, sizeof(ref));
+
+	Skein_512_PRNG_Init(&b, (const u08b_t *) "seed", 4);
+	for (pos = 0; pos < sizeof(out); pos += n) {
+		n = (pos % 3) ? 16 : pos % 5000 + 1;	/* mostly small requests */
+		if (n > sizeof(out) - pos)
+			n = sizeof(out) - pos;
+		Skein_512_PRNG_Bytes(&b, out + pos, n);
+	}
+	if (memcmp(ref, out, sizeof(out))) {
+		printf("FAIL PRNG: request sizes!\n");
+		result = 1;
 	}
 
+	Skein_512_PRNG_Reseed(&b, (const u08b_t *) "more", 4);
+	Skein_512_PRNG_Bytes(&b, out, 64);
+	if (!memcmp(ref, out, 64)) {
+		printf("FAIL PRNG: reseed!\n");
+		result = 1;
+	}
+
+	if (Skein_Rand_Bytes(out, 100) != SKEIN_SUCCESS) {
+		printf("FAIL PRNG: no seed!\n");
+		result = 1;
+	}
+
+	return result;
+}
+
+/* Pool jobs of all kinds must match the sequential and tree functions. */
+static void test_pool_done(Skein_Pool_Job_t * job)
+{
+	__sync_fetch_and_add((int *) job->arg, 1);
+}
+
+static int test_pool(void)
+{
+	enum { JOBS = 300 };
+	static u08b_t msg[70000], hash[JOBS][1032 / 8];
+	static Skein_Pool_Job_t job[JOBS];
+	static const uint_t stateBits[] = { 512, 256, 512, 1024, 512 };
+	static const u64b_t treeInfo[] = {
+		SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+		SKEIN_CFG_TREE_INFO_SEQUENTIAL,
+		SKEIN_CFG_TREE_INFO(1, 1, 0xFF),
+		SKEIN_CFG_TREE_INFO(2, 3, 3),
+	};
+	Skein_Pool_t *pool;
+	Skein_512_Ctxt_t c512;
+	Skein_256_Ctxt_t c256;
+	Skein1024_Ctxt_t c1024;
+	u08b_t ref[1032 / 8];
+	int i, done = 0, result = 0;
+
+	for (i = 0; i < (int) sizeof(msg); i++)
+		msg[i] = (u08b_t) (i * 11 + (i >> 9));
+
+	pool = Skein_Pool_Create(4);
+	if (pool == NULL) {
+		printf("FAIL pool: create!\n");
+		return 1;
+	}
+	for (i = 0; i < JOBS; i++) {
+		job[i].stateBits = stateBits[i % ITEMS(stateBits)];
+		job[i].hashBitLen = (i % 7) ? job[i].stateBits : 1032;
+		job[i].msg = msg + i;
+		job[i].msgByteCnt = (i % 3) ? (size_t) (i * 97) : (size_t) (i * 233) % 70000;
+		job[i].key = (i % 4 == 1) ? msg + 1000 : NULL;
+		job[i].keyBytes = job[i].key ? (size_t) i % 100 : 0;
+		job[i].treeInfo = treeInfo[i % ITEMS(treeInfo)];
+		job[i].hashVal = hash[i];
+		job[i].done = test_pool_done;
+		job[i].arg = &done;
+		if (Skein_Pool_Submit(pool, &job[i]) != SKEIN_SUCCESS) {
+			printf("FAIL pool: submit %d!\n", i);
+			result = 1;
+		}
+	}
+	Skein_Pool_Destroy(pool);
+
+	if (done != JOBS) {
+		printf("FAIL pool: %d of %d jobs done!\n", done, JOBS);
+		return 1;
+	}
+	for (i = 0; i < JOBS; i++) {
+		if (job[i].treeInfo != SKEIN_CFG_TREE_INFO_SEQUENTIAL)
+			Skein_Tree_Hash(job[i].stateBits, job[i].hashBitLen,
+					job[i].treeInfo, job[i].key,
+					job[i].keyBytes, job[i].msg,
+					job[i].msgByteCnt, ref, 1);
+		else if (job[i].stateBits == 256) {
+			Skein_256_InitExt(&c256, job[i].hashBitLen, job[i].treeInfo,
+					  job[i].key, job[i].keyBytes);
+			Skein_256_Update(&c256, job[i].msg, job[i].msgByteCnt);
+			Skein_256_Final(&c256, ref);
+		} else if (job[i].stateBits == 512) {
+			Skein_512_InitExt(&c512, job[i].hashBitLen, job[i].treeInfo,
+					  job[i].key, job[i].keyBytes);
+			Skein_512_Update(&c512, job[i].msg, job[i].msgByteCnt);
+			Skein_512_Final(&c512, ref);
+		} else {
+			Skein1024_InitExt(&c1024, job[i].hashBitLen, job[i].treeInfo,
+					  job[i].key, job[i].keyBytes);
+			Skein1024_Update(&c1024, job[i].msg, job[i].msgByteCnt);
+			Skein1024_Final(&c1024, ref);
+		}
+		if (job[i].ret != SKEIN_SUCCESS ||
+		    memcmp(ref, hash[i], (job[i].hashBitLen + 7) / 8)) {
+			printf("FAIL pool: job %d!\n", i);
+			result = 1;
+		}
+	}
+
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	int result = 0;
+
+	/* the .data files are in the current directory, or in argv[1] */
+	if (test_kat(argc > 1 ? argv[1] : "."))
+		result = 1;
+
+	if (test_tree())
+		result = 1;
+
+	if (test_tree_state())
+		result = 1;
+
+	if (test_tree_refresh())
+		result = 1;
+
+	if (test_kernel_switch())
+		result = 1;
+
+	if (test_mac())
+		result = 1;
+
+	if (test_xof())
+		result = 1;
+
+	if (test_pool())
+		result = 1;
+
+	if (test_prng())
+		result = 1;
+
+	if (test_kdf())
+		result = 1;
+
+	if (test_init_args())
+		result = 1;
+
+	if (test_threefish())
+		result = 1;
+
+	if (test_arena())
+		result = 1;
+
+	if (test_stats())
+		result = 1;
+
 	return result;
 }